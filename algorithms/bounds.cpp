@@ -10,6 +10,89 @@
 #include "bounds.h"
 #include "octree.h"
 #include "../physics/collisionmesh.h"
+#include "stats.h"
+
+#include <algorithm>
+#include <limits>
+#include <random>
+
+#include <glm/gtc/constants.hpp>
+
+/*
+    sphere fitting helpers (double precision, large meshes may be far from their origin)
+*/
+
+// sphere being fitted
+struct sphereFit {
+    glm::dvec3 center;
+    double radiusSquared;
+};
+
+// determine if a point is in the sphere (with some slack for rounding)
+static bool fitContains(const sphereFit& sphere, const glm::dvec3& pt) {
+    glm::dvec3 diff = pt - sphere.center;
+    return glm::dot(diff, diff) <= sphere.radiusSquared * (1.0 + SPHERE_FIT_TOLERANCE);
+}
+
+// smallest sphere with two points on its surface
+static sphereFit fitSphere(const glm::dvec3& a, const glm::dvec3& b) {
+    glm::dvec3 halfDiff = (b - a) / 2.0;
+    return { a + halfDiff, glm::dot(halfDiff, halfDiff) };
+}
+
+// smallest sphere with three points on its surface
+static sphereFit fitSphere(const glm::dvec3& a, const glm::dvec3& b, const glm::dvec3& c) {
+    glm::dvec3 ab = b - a;
+    glm::dvec3 ac = c - a;
+    glm::dvec3 norm = glm::cross(ab, ac);
+    double normSquared = glm::dot(norm, norm);
+
+    if (normSquared <= SPHERE_FIT_TOLERANCE * glm::dot(ab, ab) * glm::dot(ac, ac)) {
+        // points in a line, the farthest pair contains the third
+        sphereFit ret = fitSphere(a, b);
+        for (const sphereFit& candidate : { fitSphere(a, c), fitSphere(b, c) }) {
+            if (candidate.radiusSquared > ret.radiusSquared) {
+                ret = candidate;
+            }
+        }
+        return ret;
+    }
+
+    // circumcenter in the plane of the triangle
+    glm::dvec3 offset = (glm::cross(norm, ab) * glm::dot(ac, ac) + glm::cross(ac, norm) * glm::dot(ab, ab)) / (2.0 * normSquared);
+    return { a + offset, glm::dot(offset, offset) };
+}
+
+// smallest sphere with four points on its surface
+static sphereFit fitSphere(const glm::dvec3& a, const glm::dvec3& b, const glm::dvec3& c, const glm::dvec3& d) {
+    glm::dvec3 ab = b - a;
+    glm::dvec3 ac = c - a;
+    glm::dvec3 ad = d - a;
+    double det = glm::dot(ab, glm::cross(ac, ad));
+
+    if (det * det <= SPHERE_FIT_TOLERANCE * glm::dot(ab, ab) * glm::dot(ac, ac) * glm::dot(ad, ad)) {
+        // points in a plane, use the smallest sphere through three of them that contains the fourth
+        sphereFit candidates[] = { fitSphere(a, b, c), fitSphere(a, b, d), fitSphere(a, c, d), fitSphere(b, c, d) };
+        glm::dvec3 others[] = { d, c, b, a };
+
+        sphereFit ret = candidates[0];
+        bool found = false;
+        for (int i = 0; i < 4; i++) {
+            if (fitContains(candidates[i], others[i]) && (!found || candidates[i].radiusSquared < ret.radiusSquared)) {
+                ret = candidates[i];
+                found = true;
+            }
+            else if (!found && candidates[i].radiusSquared > ret.radiusSquared) {
+                ret = candidates[i];
+            }
+        }
+        return ret;
+    }
+
+    // circumcenter of the tetrahedron
+    glm::dvec3 offset = (glm::cross(ac, ad) * glm::dot(ab, ab) + glm::cross(ad, ab) * glm::dot(ac, ac) + glm::cross(ab, ac) * glm::dot(ad, ad)) / (2.0 * det);
+    return { a + offset, glm::dot(offset, offset) };
+}
 
 /*
         Constructors
@@ -27,6 +110,97 @@ BoundingRegion::BoundingRegion(glm::vec3 center, float radius)
 BoundingRegion::BoundingRegion(glm::vec3 min, glm::vec3 max) 
     : type(BoundTypes::AABB), min(min), ogMin(min), max(max), ogMax(max) {}
 
+/*
+    Fitting regions to points
+*/
+
+// smallest box containing the points
+BoundingRegion BoundingRegion::calculateBox(const std::vector<glm::vec3>& points) {
+    if (points.empty()) {
+        return BoundingRegion(glm::vec3(0.0f), glm::vec3(0.0f));
+    }
+
+    glm::vec3 min(std::numeric_limits<float>::max());
+    glm::vec3 max(-std::numeric_limits<float>::max());
+    for (const glm::vec3& pt : points) {
+        min = glm::min(min, pt);
+        max = glm::max(max, pt);
+    }
+
+    return BoundingRegion(min, max);
+}
+
+// sphere around the center of the box (loose, kept to compare against)
+BoundingRegion BoundingRegion::calculateCenteredSphere(const std::vector<glm::vec3>& points) {
+    glm::vec3 center = calculateBox(points).calculateCenter();
+
+    // calculate max distance from the center
+    float maxRadiusSquared = 0.0f;
+    for (const glm::vec3& pt : points) {
+        glm::vec3 diff = pt - center;
+        maxRadiusSquared = std::fmaxf(maxRadiusSquared, glm::dot(diff, diff));
+    }
+
+    return BoundingRegion(center, sqrt(maxRadiusSquared));
+}
+
+// smallest sphere containing the points (Welzl)
+BoundingRegion BoundingRegion::calculateMinimalSphere(std::vector<glm::vec3> points) {
+    if (points.empty()) {
+        return BoundingRegion(glm::vec3(0.0f), 0.0f);
+    }
+
+    // random order gives expected linear time (fixed seed, so every load gives the same sphere)
+    std::shuffle(points.begin(), points.end(), std::mt19937(SPHERE_FIT_SEED));
+
+    std::vector<glm::dvec3> pts(points.size());
+    for (unsigned int i = 0, len = points.size(); i < len; i++) {
+        pts[i] = glm::dvec3(points[i]);
+    }
+
+    /*
+        each point outside of the sphere of the points before it has to be on the surface of
+        their smallest sphere, so fit again with it fixed (up to four fixed points)
+    */
+    sphereFit sphere = { pts[0], 0.0 };
+    for (unsigned int i = 1, len = pts.size(); i < len; i++) {
+        if (fitContains(sphere, pts[i])) {
+            continue;
+        }
+
+        sphere = { pts[i], 0.0 };
+        for (unsigned int j = 0; j < i; j++) {
+            if (fitContains(sphere, pts[j])) {
+                continue;
+            }
+
+            sphere = fitSphere(pts[i], pts[j]);
+            for (unsigned int k = 0; k < j; k++) {
+                if (fitContains(sphere, pts[k])) {
+                    continue;
+                }
+
+                sphere = fitSphere(pts[i], pts[j], pts[k]);
+                for (unsigned int l = 0; l < k; l++) {
+                    if (!fitContains(sphere, pts[l])) {
+                        sphere = fitSphere(pts[i], pts[j], pts[k], pts[l]);
+                    }
+                }
+            }
+        }
+    }
+
+    // radius from the rounded center, so every point is inside in single precision
+    glm::vec3 center(sphere.center);
+    float maxRadiusSquared = 0.0f;
+    for (const glm::vec3& pt : points) {
+        glm::vec3 diff = pt - center;
+        maxRadiusSquared = std::fmaxf(maxRadiusSquared, glm::dot(diff, diff));
+    }
+
+    return BoundingRegion(center, sqrt(maxRadiusSquared));
+}
+
 /*
     Calculating values for the region
 */
@@ -54,21 +228,110 @@ void BoundingRegion::transform() {
 }
 
 // center
-glm::vec3 BoundingRegion::calculateCenter() {
+glm::vec3 BoundingRegion::calculateCenter() const {
     return (type == BoundTypes::AABB) ? (min + max) / 2.0f : center;
 }
 
 // calculate dimensions
-glm::vec3 BoundingRegion::calculateDimensions() {
+glm::vec3 BoundingRegion::calculateDimensions() const {
     return (type == BoundTypes::AABB) ? (max - min) : glm::vec3(2.0f * radius);
 }
 
+// calculate volume
+float BoundingRegion::calculateVolume() const {
+    if (type == BoundTypes::AABB) {
+        glm::vec3 dimensions = max - min;
+        return dimensions.x * dimensions.y * dimensions.z;
+    }
+    else {
+        return 4.0f / 3.0f * glm::pi<float>() * radius * radius * radius;
+    }
+}
+
+// calculate distance from point to the region (0 if point inside)
+float BoundingRegion::calculateDistance(glm::vec3 pt) const {
+    if (type == BoundTypes::AABB) {
+        // distance to closest point in box
+        return glm::length(pt - glm::clamp(pt, min, max));
+    }
+    else {
+        return std::fmaxf(glm::length(pt - center) - radius, 0.0f);
+    }
+}
+
+// calculate the contact with an intersecting region (unit norm from this region toward br, depth is how far br has to move out)
+void BoundingRegion::calculateContact(const BoundingRegion& br, glm::vec3& norm, float& depth) const {
+    if (type == BoundTypes::AABB && br.type == BoundTypes::AABB) {
+        // both boxes - separate along the axis with the least overlap
+        glm::vec3 overlap = glm::min(max, br.max) - glm::max(min, br.min);
+        glm::vec3 centerDiff = br.calculateCenter() - calculateCenter();
+
+        int axis = 0;
+        for (int i = 1; i < 3; i++) {
+            if (overlap[i] < overlap[axis]) {
+                axis = i;
+            }
+        }
+
+        norm = glm::vec3(0.0f);
+        norm[axis] = centerDiff[axis] < 0.0f ? -1.0f : 1.0f;
+        depth = overlap[axis];
+    }
+    else if (type == BoundTypes::SPHERE && br.type == BoundTypes::SPHERE) {
+        // both spheres - separate along the line between the centers
+        norm = br.center - center;
+        float dist = glm::length(norm);
+        norm = dist > 0.0f ? norm / dist : glm::vec3(0.0f, 1.0f, 0.0f);
+        depth = radius + br.radius - dist;
+    }
+    else if (type == BoundTypes::SPHERE) {
+        // this is a sphere, br is a box
+        // call algorithm for br (defined in following else block), then flip
+        br.calculateContact(*this, norm, depth);
+        norm = -norm;
+    }
+    else {
+        // this is a box, br is a sphere
+        glm::vec3 closestPt = glm::clamp(br.center, min, max);
+        norm = br.center - closestPt;
+        float dist = glm::length(norm);
+
+        if (dist > 0.0f) {
+            // center outside, separate from the closest point
+            norm /= dist;
+            depth = br.radius - dist;
+        }
+        else {
+            // center inside, push out through the closest side
+            glm::vec3 toMin = br.center - min;
+            glm::vec3 toMax = max - br.center;
+
+            depth = std::numeric_limits<float>::max();
+            for (int i = 0; i < 3; i++) {
+                if (toMin[i] < depth) {
+                    depth = toMin[i];
+                    norm = glm::vec3(0.0f);
+                    norm[i] = -1.0f;
+                }
+                if (toMax[i] < depth) {
+                    depth = toMax[i];
+                    norm = glm::vec3(0.0f);
+                    norm[i] = 1.0f;
+                }
+            }
+            depth += br.radius;
+        }
+    }
+
+    depth = std::fmaxf(depth, 0.0f);
+}
+
 /*
     testing methods
 */
 
 // determine if point inside
-bool BoundingRegion::containsPoint(glm::vec3 pt) {
+bool BoundingRegion::containsPoint(glm::vec3 pt) const {
     if (type == BoundTypes::AABB) {
         // box - point must be larger than man and smaller than max
         return (pt.x >= min.x) && (pt.x <= max.x) &&
@@ -87,7 +350,7 @@ bool BoundingRegion::containsPoint(glm::vec3 pt) {
 }
 
 // determine if region completely inside
-bool BoundingRegion::containsRegion(BoundingRegion br) {
+bool BoundingRegion::containsRegion(const BoundingRegion& br) const {
     if (br.type == BoundTypes::AABB) {
         // if br is a box, just has to contain min and max
         return containsPoint(br.min) && containsPoint(br.max);
@@ -121,11 +384,12 @@ bool BoundingRegion::containsRegion(BoundingRegion br) {
 }
 
 // determine if region intersects (partial containment)
-bool BoundingRegion::intersectsWith(BoundingRegion br) {
+bool BoundingRegion::intersectsWith(const BoundingRegion& br) const {
     // overlap on all axes
 
     if (type == BoundTypes::AABB && br.type == BoundTypes::AABB) {
         // both boxes
+        Stats::noCoarseTests++;
 
         glm::vec3 rad = calculateDimensions() / 2.0f;				// "radius" of this box
         glm::vec3 radBr = br.calculateDimensions() / 2.0f;			// "radius" of br
@@ -147,6 +411,7 @@ bool BoundingRegion::intersectsWith(BoundingRegion br) {
     }
     else if (type == BoundTypes::SPHERE && br.type == BoundTypes::SPHERE) {
         // both spheres - distance between centers must be less than combined radius
+        Stats::noCoarseTests++;
 
         glm::vec3 centerDiff = center - br.center;
         float distSquared = 0.0f;
@@ -161,6 +426,7 @@ bool BoundingRegion::intersectsWith(BoundingRegion br) {
     }
     else if (type == BoundTypes::SPHERE) {
         // this is a sphere, br is a box
+        Stats::noCoarseTests++;
         float distSquared = 0.0f;
         for (int i = 0; i < 3; i++) {
             // determine closest side
@@ -179,7 +445,7 @@ bool BoundingRegion::intersectsWith(BoundingRegion br) {
 }
 
 // operator overload
-bool BoundingRegion::operator==(BoundingRegion br) {
+bool BoundingRegion::operator==(const BoundingRegion& br) const {
     if (type != br.type) {
         return false;
     }
@@ -10,10 +10,17 @@
 #ifndef BOUNDS_H
 #define BOUNDS_H
 
+#include <vector>
+
 #include <glm/glm.hpp>
 
 #include "../physics/rigidbody.h"
 
+// relative slack when testing if a point is inside a sphere being fitted
+#define SPHERE_FIT_TOLERANCE 1e-6
+// seed for the point order of the sphere fit (same sphere on every load)
+#define SPHERE_FIT_SEED 5489u
+
 // forward declaration
 namespace Octree {
     class node;
@@ -44,6 +51,8 @@ public:
 
     // pointer for quick access to current octree node
     Octree::node* cell;
+    // index of region in the object list of its node
+    unsigned int cellIdx;
 
     // sphere values
     glm::vec3 center;
@@ -72,6 +81,19 @@ public:
     // initialize as AABB
     BoundingRegion(glm::vec3 min, glm::vec3 max);
 
+    /*
+        Fitting regions to points
+    */
+
+    // smallest box containing the points
+    static BoundingRegion calculateBox(const std::vector<glm::vec3>& points);
+
+    // sphere around the center of the box (loose, kept to compare against)
+    static BoundingRegion calculateCenteredSphere(const std::vector<glm::vec3>& points);
+
+    // smallest sphere containing the points (Welzl)
+    static BoundingRegion calculateMinimalSphere(std::vector<glm::vec3> points);
+
     /*
         Calculating values for the region
     */
@@ -80,26 +102,35 @@ public:
     void transform();
 
     // center
-    glm::vec3 calculateCenter();
+    glm::vec3 calculateCenter() const;
 
     // calculate dimensions
-    glm::vec3 calculateDimensions();
+    glm::vec3 calculateDimensions() const;
+
+    // calculate volume
+    float calculateVolume() const;
+
+    // calculate distance from point to the region (0 if point inside)
+    float calculateDistance(glm::vec3 pt) const;
+
+    // calculate the contact with an intersecting region (unit norm from this region toward br, depth is how far br has to move out)
+    void calculateContact(const BoundingRegion& br, glm::vec3& norm, float& depth) const;
 
     /*
         testing methods
     */
 
     // determine if point inside
-    bool containsPoint(glm::vec3 pt);
+    bool containsPoint(glm::vec3 pt) const;
 
     // determine if region completely inside
-    bool containsRegion(BoundingRegion br);
+    bool containsRegion(const BoundingRegion& br) const;
 
     // determine if region intersects (partial containment)
-    bool intersectsWith(BoundingRegion br);
+    bool intersectsWith(const BoundingRegion& br) const;
 
     // operator overload
-    bool operator==(BoundingRegion br);
+    bool operator==(const BoundingRegion& br) const;
 };
 
 #endif
\ No newline at end of file
@@ -0,0 +1,242 @@
+/*****************************************************************
+ *   Author: Tyanna Prince
+ *   Date: 07/15/2023
+ *   Description: An enhancement of my cs330 OpenGL project where I added functionality such as charater movement,
+ *  directional lighting, and shadow mapping, a cubemap, and joystick support.
+ *  copyright (c) 2023 Tyanna Prince
+ *  version 2.0
+ *****************************************************************/
+
+#include "broadphase.h"
+#include "octree.h"
+
+#include <algorithm>
+
+// determine if endpoint e1 goes before e2 (starts go before ends so touching regions overlap)
+static bool endpointBefore(const Broadphase::sweepAndPrune::endpoint& e1, const Broadphase::sweepAndPrune::endpoint& e2) {
+    return e1.value < e2.value || (e1.value == e2.value && e1.isMin && !e2.isMin);
+}
+
+/*
+    collision pair
+*/
+
+// initialize with indices in any order
+Broadphase::collisionPair::collisionPair(unsigned int i, unsigned int j)
+    : a(std::min(i, j)), b(std::max(i, j)) {}
+
+// order by a, then b
+bool Broadphase::collisionPair::operator<(const collisionPair& pair) const {
+    return a < pair.a || (a == pair.a && b < pair.b);
+}
+
+// test for equivalence
+bool Broadphase::collisionPair::operator==(const collisionPair& pair) const {
+    return a == pair.a && b == pair.b;
+}
+
+/*
+    stage
+*/
+
+// add pair if the regions belong to different instances and one of them moved
+void Broadphase::stage::addPair(unsigned int i, unsigned int j) {
+    RigidBody* instance1 = regions.cold[i].instance;
+    RigidBody* instance2 = regions.cold[j].instance;
+
+    if (instance1 == instance2) {
+        // do not test collisions with the same instance
+        return;
+    }
+
+    if (!States::isActive(&instance1->state, INSTANCE_MOVED) &&
+        !States::isActive(&instance2->state, INSTANCE_MOVED)) {
+        // nothing to respond to
+        return;
+    }
+
+    pairs.push_back(collisionPair(i, j));
+}
+
+// sort and remove duplicate pairs
+void Broadphase::stage::finalizePairs() {
+    std::sort(pairs.begin(), pairs.end());
+    pairs.erase(std::unique(pairs.begin(), pairs.end()), pairs.end());
+}
+
+/*
+    sweep and prune
+*/
+
+// find all overlapping pairs in regions where at least one instance moved
+void Broadphase::sweepAndPrune::findPairs() {
+    pairs.clear();
+
+    unsigned char bestAxis = chooseAxis();
+    if (bestAxis != axis) {
+        // spread changed, so start over
+        axis = bestAxis;
+        rebuildEndpoints();
+    }
+    else {
+        updateEndpoints();
+    }
+
+    // other axes to test once overlap on the sweep axis is known
+    unsigned char axis1 = (axis + 1) % 3;
+    unsigned char axis2 = (axis + 2) % 3;
+
+    // sweep along axis, keeping the regions whose start has been passed but not their end
+    active.clear();
+    activeSlot.resize(regions.size());
+    for (endpoint& e : endpoints) {
+        if (!e.isMin) {
+            // region ended, move the last active region into its slot
+            RegionHandle last = active.back();
+            active[activeSlot[e.region]] = last;
+            activeSlot[last] = activeSlot[e.region];
+            active.pop_back();
+            continue;
+        }
+
+        // only the packed bounds are read until the regions are known to overlap
+        glm::vec3& min = regions.mins[e.region];
+        glm::vec3& max = regions.maxs[e.region];
+
+        for (unsigned int other : active) {
+            glm::vec3& otherMin = regions.mins[other];
+            glm::vec3& otherMax = regions.maxs[other];
+
+            if (otherMin[axis1] > max[axis1] || otherMax[axis1] < min[axis1] ||
+                otherMin[axis2] > max[axis2] || otherMax[axis2] < min[axis2]) {
+                continue;
+            }
+
+            if (regions.types[e.region] == BoundTypes::AABB && regions.types[other] == BoundTypes::AABB) {
+                // box overlap on all axes is exact
+                addPair(e.region, other);
+            }
+            else if (regions.intersects(e.region, other)) {
+                addPair(e.region, other);
+            }
+        }
+
+        activeSlot[e.region] = active.size();
+        active.push_back(e.region);
+    }
+
+    finalizePairs();
+}
+
+// pick the axis the region centers are most spread along
+unsigned char Broadphase::sweepAndPrune::chooseAxis() {
+    if (regions.size() == 0) {
+        return axis;
+    }
+
+    glm::vec3 sum(0.0f);
+    glm::vec3 sumSquared(0.0f);
+    unsigned int noLive = 0;
+    for (unsigned int i = 0, len = regions.size(); i < len; i++) {
+        if (!regions.isLive(i)) {
+            continue;
+        }
+
+        glm::vec3 center = regions.calculateCenter(i);
+        sum += center;
+        sumSquared += center * center;
+        noLive++;
+    }
+    if (noLive == 0) {
+        return axis;
+    }
+    glm::vec3 variance = sumSquared - sum * sum / (float)noLive;
+
+    unsigned char ret = axis;
+    for (unsigned char i = 0; i < 3; i++) {
+        // only switch when clearly better, to keep the endpoints between frames
+        if (variance[i] > 2.0f * variance[ret]) {
+            ret = i;
+        }
+    }
+    return ret;
+}
+
+// regenerate endpoints from scratch
+void Broadphase::sweepAndPrune::rebuildEndpoints() {
+    endpoints.clear();
+    inSweep.assign(regions.size(), false);
+    for (unsigned int i = 0, len = regions.size(); i < len; i++) {
+        if (regions.isLive(i)) {
+            endpoints.push_back({ regions.mins[i][axis], i, true });
+            endpoints.push_back({ regions.maxs[i][axis], i, false });
+            inSweep[i] = true;
+        }
+    }
+
+    std::sort(endpoints.begin(), endpoints.end(), endpointBefore);
+}
+
+// refresh endpoint values from the regions, drop removed regions, add new ones and restore order
+void Broadphase::sweepAndPrune::updateEndpoints() {
+    // refresh values in place, dropping the endpoints of freed handles
+    unsigned int noKept = 0;
+    for (unsigned int i = 0, len = endpoints.size(); i < len; i++) {
+        endpoint e = endpoints[i];
+        if (!regions.isLive(e.region)) {
+            inSweep[e.region] = false;
+            continue;
+        }
+
+        e.value = e.isMin ? regions.mins[e.region][axis] : regions.maxs[e.region][axis];
+        endpoints[noKept++] = e;
+    }
+    endpoints.resize(noKept);
+
+    // append the endpoints of new regions
+    inSweep.resize(regions.size(), false);
+    for (unsigned int i = 0, len = regions.size(); i < len; i++) {
+        if (regions.isLive(i) && !inSweep[i]) {
+            endpoints.push_back({ regions.mins[i][axis], i, true });
+            endpoints.push_back({ regions.maxs[i][axis], i, false });
+            inSweep[i] = true;
+        }
+    }
+
+    if (4 * (endpoints.size() - noKept) > endpoints.size()) {
+        // many new regions, cheaper to sort everything
+        std::sort(endpoints.begin(), endpoints.end(), endpointBefore);
+        return;
+    }
+
+    // insertion sort (regions only move a little each frame, new ones are few)
+    for (int i = 1, len = endpoints.size(); i < len; i++) {
+        endpoint e = endpoints[i];
+        int j = i - 1;
+        while (j >= 0 && endpointBefore(e, endpoints[j])) {
+            endpoints[j + 1] = endpoints[j];
+            j--;
+        }
+        endpoints[j + 1] = e;
+    }
+}
+
+/*
+    utility methods
+*/
+
+// run narrowphase on every pair (response is applied to the moved instance)
+void Broadphase::narrowphase(RegionStore& regions, std::vector<collisionPair>& pairs) {
+    for (collisionPair& pair : pairs) {
+        // full regions are only rebuilt for pairs that overlap
+        BoundingRegion br1 = regions.get(pair.a);
+        BoundingRegion br2 = regions.get(pair.b);
+
+        if (States::isActive(&br2.instance->state, INSTANCE_MOVED)) {
+            Octree::checkCollisionsPair(br1, br2);
+        }
+        if (States::isActive(&br1.instance->state, INSTANCE_MOVED)) {
+            Octree::checkCollisionsPair(br2, br1);
+        }
+    }
+}
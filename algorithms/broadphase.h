@@ -0,0 +1,139 @@
+/*****************************************************************
+ *   Author: Tyanna Prince
+ *   Date: 07/15/2023
+ *   Description: An enhancement of my cs330 OpenGL project where I added functionality such as charater movement,
+ *  directional lighting, and shadow mapping, a cubemap, and joystick support.
+ *  copyright (c) 2023 Tyanna Prince
+ *  version 2.0
+ *****************************************************************/
+
+#ifndef BROADPHASE_H
+#define BROADPHASE_H
+
+#include <vector>
+
+#include "bounds.h"
+#include "regionstore.h"
+
+/*
+    namespace to tie together the collision broadphase stages
+
+    - a stage takes the regions in the scene (split into hot and cold arrays) and
+      produces one sorted, deduplicated list of pairs whose bounds overlap
+    - narrowphase then runs as a separate pass over that list
+*/
+
+namespace Broadphase {
+    /*
+        enum to represent broadphase backends
+    */
+
+    enum class Type : unsigned char {
+        OCTREE          = 0x00, // pairs tested while the octree is updated (no pair list)
+        SWEEP_AND_PRUNE = 0x01  // sorted endpoints along one axis
+    };
+
+    /*
+        struct to represent a pair of overlapping regions
+    */
+
+    struct collisionPair {
+        // handles in the region store (a < b)
+        unsigned int a;
+        unsigned int b;
+
+        // initialize with indices in any order
+        collisionPair(unsigned int i, unsigned int j);
+
+        // order by a, then b
+        bool operator<(const collisionPair& pair) const;
+
+        // test for equivalence
+        bool operator==(const collisionPair& pair) const;
+    };
+
+    /*
+        base class for all broadphase stages
+    */
+
+    class stage {
+    public:
+        // regions tested this frame (filled by the scene)
+        RegionStore regions;
+
+        // sorted, deduplicated overlapping pairs found this frame
+        std::vector<collisionPair> pairs;
+
+        // destructor
+        virtual ~stage() {}
+
+        // find all overlapping pairs in regions where at least one instance moved
+        virtual void findPairs() = 0;
+
+    protected:
+        // add pair if the regions belong to different instances and one of them moved
+        void addPair(unsigned int i, unsigned int j);
+
+        // sort and remove duplicate pairs
+        void finalizePairs();
+    };
+
+    /*
+        incremental sweep and prune stage
+
+        - the min and max endpoints of every region along the sweep axis stay sorted
+          between frames, so re-sorting after small movements is nearly linear
+        - endpoints refer to region handles, which the store keeps stable between frames
+          (regions are synced, not reassigned)
+    */
+
+    class sweepAndPrune : public stage {
+    public:
+        /*
+            struct to represent the start or end of a region along the sweep axis
+        */
+        struct endpoint {
+            // position along the sweep axis
+            float value;
+            // handle of region in the region store
+            RegionHandle region;
+            // if this is the start of the region
+            bool isMin;
+        };
+
+        // axis the endpoints are sorted along (0 = x, 1 = y, 2 = z)
+        unsigned char axis = 0;
+
+        // list of endpoints sorted by value
+        std::vector<endpoint> endpoints;
+
+        // find all overlapping pairs in regions where at least one instance moved
+        void findPairs();
+
+    private:
+        // regions whose start has been passed but not their end during the sweep
+        std::vector<RegionHandle> active;
+        // index of each active region in the active list
+        std::vector<unsigned int> activeSlot;
+        // if the endpoints of each handle are in the list
+        std::vector<bool> inSweep;
+
+        // pick the axis the region centers are most spread along
+        unsigned char chooseAxis();
+
+        // regenerate endpoints from scratch
+        void rebuildEndpoints();
+
+        // refresh endpoint values from the regions, drop removed regions, add new ones and restore order
+        void updateEndpoints();
+    };
+
+    /*
+        utility methods
+    */
+
+    // run narrowphase on every pair (response is applied to the moved instance)
+    void narrowphase(RegionStore& regions, std::vector<collisionPair>& pairs);
+}
+
+#endif
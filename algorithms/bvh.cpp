@@ -0,0 +1,554 @@
+/*****************************************************************
+ *   Author: Tyanna Prince
+ *   Date: 07/15/2023
+ *   Description: An enhancement of my cs330 OpenGL project where I added functionality such as charater movement,
+ *  directional lighting, and shadow mapping, a cubemap, and joystick support.
+ *  copyright (c) 2023 Tyanna Prince
+ *  version 2.0
+ *****************************************************************/
+
+#include "bvh.h"
+#include "octree.h"
+#include "../graphics/models/box.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <utility>
+
+/*
+    utility methods
+*/
+
+// surface area of the box between min and max
+static float surfaceArea(glm::vec3 min, glm::vec3 max) {
+    glm::vec3 d = max - min;
+    return 2.0f * (d.x * d.y + d.y * d.z + d.z * d.x);
+}
+
+// bin the center of a region falls into along an axis
+static int calculateBin(const BoundingRegion& br, int axis, float centerMin, float scale) {
+    int bin = (int)((br.calculateCenter()[axis] - centerMin) * scale);
+    return std::min(std::max(bin, 0), BVH_BINS - 1);
+}
+
+/*
+    functionality
+*/
+
+// add instance to pending queue
+void BVH::addToPending(RigidBody* instance, Model* model) {
+    // get all bounding regions of model and put them in queue
+    for (BoundingRegion br : model->boundingRegions) {
+        br.instance = instance;
+        br.transform();
+        queue.push_back(br);
+    }
+}
+
+// build tree from all objects (called during initialization)
+void BVH::build() {
+    nodes.clear();
+
+    if (objects.size() != 0) {
+        // a binary tree with leaves of at least one object never has more nodes than this
+        nodes.reserve(2 * objects.size() - 1);
+
+        node root;
+        root.firstObject = 0;
+        root.noObjects = objects.size();
+        root.left = 0;
+        nodes.push_back(root);
+
+        subdivide(0);
+    }
+
+    builtCost = currentCost = calculateCost();
+    noRebuilds++;
+}
+
+// update objects in tree (called during each iteration of main loop)
+void BVH::update(Box& box) {
+    for (node& n : nodes) {
+        box.positions.push_back(n.bounds.calculateCenter());
+        box.sizes.push_back(n.bounds.calculateDimensions());
+    }
+
+    // remove objects that don't exist anymore and refresh moved objects
+    std::vector<BoundingRegion> movedObjects;
+    unsigned int noAlive = 0;
+    for (unsigned int i = 0, len = objects.size(); i < len; i++) {
+        if (States::isActive(&objects[i].instance->state, INSTANCE_DEAD)) {
+            // remove if kill switch active
+            continue;
+        }
+
+        if (States::isActive(&objects[i].instance->state, INSTANCE_MOVED)) {
+            // if moved switch active, transform region
+            objects[i].transform();
+            movedObjects.push_back(objects[i]);
+        }
+
+        box.positions.push_back(objects[i].calculateCenter());
+        box.sizes.push_back(objects[i].calculateDimensions());
+
+        // compact list
+        if (noAlive != i) {
+            objects[noAlive] = objects[i];
+        }
+        noAlive++;
+    }
+
+    if (noAlive != objects.size()) {
+        // object ranges of the nodes are no longer valid
+        objects.resize(noAlive);
+        build();
+    }
+    else if (movedObjects.size() != 0) {
+        // grow and shrink boxes to fit, rebuild once they overlap too much
+        refit();
+        if (currentCost > builtCost * BVH_REBUILD_RATIO) {
+            build();
+        }
+    }
+
+    // collision detection (unless pairs are found by a separate broadphase stage)
+    for (unsigned int i = 0, len = detectCollisions ? movedObjects.size() : 0; i < len; i++) {
+        checkCollisionsRegion(movedObjects[i]);
+
+        if (linkedIndex) {
+            // objects kept in the other index
+            linkedIndex->checkCollisionsRegion(movedObjects[i]);
+        }
+    }
+
+    processPending();
+}
+
+// process pending queue (rebuilds the tree if objects were added)
+void BVH::processPending() {
+    if (queue.size() == 0) {
+        return;
+    }
+
+    for (const BoundingRegion& br : queue) {
+        if (!States::isActive(&br.instance->state, INSTANCE_DEAD)) {
+            objects.push_back(br);
+        }
+    }
+    queue.clear();
+
+    build();
+}
+
+// recalculate the boxes of every node from the objects bottom-up
+void BVH::refit() {
+    // children always come after their parent
+    for (int i = (int)nodes.size() - 1; i >= 0; i--) {
+        if (nodes[i].left == 0) {
+            nodes[i].bounds = calculateBounds(i);
+        }
+        else {
+            const BoundingRegion& left = nodes[nodes[i].left].bounds;
+            const BoundingRegion& right = nodes[nodes[i].left + 1].bounds;
+            nodes[i].bounds = BoundingRegion(glm::min(left.min, right.min), glm::max(left.max, right.max));
+        }
+    }
+
+    currentCost = calculateCost();
+}
+
+// check collisions with a ray (closest hit)
+BoundingRegion* BVH::checkCollisionsRay(Ray r, float& tmin) {
+    BoundingRegion* ret = nullptr;
+
+    float tmin_tmp = std::numeric_limits<float>::max();
+    float tmax_tmp = std::numeric_limits<float>::lowest();
+    float t_tmp = std::numeric_limits<float>::max();
+
+    if (nodes.size() == 0 ||
+        !r.intersectsBoundingRegion(nodes[0].bounds, tmin_tmp, tmax_tmp) || tmin_tmp >= tmin) {
+        // empty or missed
+        return nullptr;
+    }
+
+    // nodes to visit with the distance the ray enters them
+    std::vector<std::pair<unsigned int, float>> stack;
+    stack.push_back({ 0, tmin_tmp });
+
+    while (stack.size() != 0) {
+        unsigned int idx = stack.back().first;
+        float entry = stack.back().second;
+        stack.pop_back();
+
+        if (entry >= tmin) {
+            // found nearer collision
+            continue;
+        }
+
+        node& n = nodes[idx];
+        if (n.left == 0) {
+            // leaf, check objects
+            for (unsigned int i = n.firstObject, end = i + n.noObjects; i < end; i++) {
+                BoundingRegion& br = objects[i];
+
+                // coarse check (skip regions entirely behind the origin, start at the origin if inside)
+                if (!r.intersectsBoundingRegion(br, tmin_tmp, tmax_tmp) || tmax_tmp < 0.0f) {
+                    continue;
+                }
+                tmin_tmp = std::fmaxf(tmin_tmp, 0.0f);
+                if (tmin_tmp > tmin) {
+                    continue;
+                }
+
+                if (br.collisionMesh) {
+                    // fine grain check with collision mesh
+                    t_tmp = std::numeric_limits<float>::max();
+                    if (r.intersectsMesh(br.collisionMesh, br.instance, t_tmp) && t_tmp < tmin) {
+                        // found closer collision
+                        tmin = t_tmp;
+                        ret = &br;
+                    }
+                }
+                else if (tmin_tmp < tmin) {
+                    // rely on coarse check
+                    tmin = tmin_tmp;
+                    ret = &br;
+                }
+            }
+            continue;
+        }
+
+        // visit the child the ray enters first before the other one
+        float tLeft = std::numeric_limits<float>::max(), tRight = std::numeric_limits<float>::max();
+        bool hitLeft = r.intersectsBoundingRegion(nodes[n.left].bounds, tLeft, tmax_tmp) && tLeft < tmin;
+        bool hitRight = r.intersectsBoundingRegion(nodes[n.left + 1].bounds, tRight, tmax_tmp) && tRight < tmin;
+
+        if (hitLeft && hitRight) {
+            if (tLeft <= tRight) {
+                stack.push_back({ n.left + 1, tRight });
+                stack.push_back({ n.left, tLeft });
+            }
+            else {
+                stack.push_back({ n.left, tLeft });
+                stack.push_back({ n.left + 1, tRight });
+            }
+        }
+        else if (hitLeft) {
+            stack.push_back({ n.left, tLeft });
+        }
+        else if (hitRight) {
+            stack.push_back({ n.left + 1, tRight });
+        }
+    }
+
+    return ret;
+}
+
+// check collisions between the object and every other object it overlaps
+void BVH::checkCollisionsRegion(const BoundingRegion& obj) {
+    if (nodes.size() == 0) {
+        return;
+    }
+
+    std::vector<unsigned int> stack;
+    stack.push_back(0);
+
+    while (stack.size() != 0) {
+        node& n = nodes[stack.back()];
+        stack.pop_back();
+
+        if (!n.bounds.intersectsWith(obj)) {
+            // nothing in this branch can touch the object
+            continue;
+        }
+
+        if (n.left != 0) {
+            stack.push_back(n.left);
+            stack.push_back(n.left + 1);
+            continue;
+        }
+
+        for (unsigned int i = n.firstObject, end = i + n.noObjects; i < end; i++) {
+            if (objects[i].instance->instanceId == obj.instance->instanceId) {
+                // do not test collisions with the same instance
+                continue;
+            }
+
+            Octree::checkCollisionsPair(objects[i], obj);
+        }
+    }
+}
+
+// find objects with a region intersecting the region
+void BVH::queryRegion(const BoundingRegion& br, std::vector<BoundingRegion*>& found) {
+    std::vector<unsigned int> stack;
+    if (nodes.size() != 0) {
+        stack.push_back(0);
+    }
+
+    while (stack.size() != 0) {
+        node& n = nodes[stack.back()];
+        stack.pop_back();
+
+        if (!n.bounds.intersectsWith(br)) {
+            // nothing in this branch can touch the region
+            continue;
+        }
+
+        if (n.left != 0) {
+            stack.push_back(n.left);
+            stack.push_back(n.left + 1);
+            continue;
+        }
+
+        for (unsigned int i = n.firstObject, end = i + n.noObjects; i < end; i++) {
+            if (objects[i].intersectsWith(br)) {
+                found.push_back(&objects[i]);
+            }
+        }
+    }
+}
+
+// find instances with a region inside the frustum (skips nodes outside, stops testing inside)
+void BVH::checkCollisionsFrustum(Frustum& frustum, std::vector<RigidBody*>& instances) {
+    std::vector<unsigned int> stack;
+    if (nodes.size() != 0) {
+        stack.push_back(0);
+    }
+
+    while (stack.size() != 0) {
+        node& n = nodes[stack.back()];
+        stack.pop_back();
+
+        FrustumTest result = frustum.testRegion(n.bounds);
+        if (result == FrustumTest::OUTSIDE) {
+            // nothing in this branch can be seen
+            continue;
+        }
+
+        if (result == FrustumTest::INSIDE) {
+            // every object in this branch can be seen (they are contiguous)
+            for (unsigned int i = n.firstObject, end = i + n.noObjects; i < end; i++) {
+                instances.push_back(objects[i].instance);
+            }
+        }
+        else if (n.left != 0) {
+            stack.push_back(n.left);
+            stack.push_back(n.left + 1);
+        }
+        else {
+            for (unsigned int i = n.firstObject, end = i + n.noObjects; i < end; i++) {
+                if (frustum.testRegion(objects[i]) != FrustumTest::OUTSIDE) {
+                    instances.push_back(objects[i].instance);
+                }
+            }
+        }
+    }
+
+    // objects waiting to be inserted
+    for (const BoundingRegion& br : queue) {
+        if (frustum.testRegion(br) != FrustumTest::OUTSIDE) {
+            instances.push_back(br.instance);
+        }
+    }
+}
+
+// copy all objects in the tree into a list (pending objects are left out)
+void BVH::collectObjects(std::vector<BoundingRegion>& objectList) {
+    objectList.insert(objectList.end(), objects.begin(), objects.end());
+}
+
+// add the tree to the tree statistics
+void BVH::calculateStats(Stats::treeStats& stats) {
+    // nodes to visit with their depth
+    std::vector<std::pair<unsigned int, unsigned int>> stack;
+    if (nodes.size() != 0) {
+        stack.push_back({ 0, 0 });
+    }
+
+    while (stack.size() != 0) {
+        node& n = nodes[stack.back().first];
+        unsigned int depth = stack.back().second;
+        stack.pop_back();
+
+        bool isLeaf = n.left == 0;
+        stats.addNode(depth, isLeaf, isLeaf ? n.noObjects : 0, 0);
+
+        if (!isLeaf) {
+            stack.push_back({ n.left, depth + 1 });
+            stack.push_back({ n.left + 1, depth + 1 });
+        }
+    }
+
+    stats.noPending += queue.size();
+}
+
+// destroy object (free memory)
+void BVH::destroy() {
+    nodes.clear();
+    objects.clear();
+    queue.clear();
+    builtCost = currentCost = 0.0f;
+}
+
+/*
+    private methods
+*/
+
+// split the node at idx along the cheapest binned SAH plane, then its children
+void BVH::subdivide(unsigned int idx) {
+    nodes[idx].bounds = calculateBounds(idx);
+    nodes[idx].left = 0;
+
+    unsigned int first = nodes[idx].firstObject;
+    unsigned int count = nodes[idx].noObjects;
+    if (count <= BVH_MAX_LEAF_OBJECTS) {
+        return;
+    }
+
+    // splits are placed between object centers
+    glm::vec3 centerMin(std::numeric_limits<float>::max());
+    glm::vec3 centerMax(std::numeric_limits<float>::lowest());
+    for (unsigned int i = first; i < first + count; i++) {
+        glm::vec3 center = objects[i].calculateCenter();
+        centerMin = glm::min(centerMin, center);
+        centerMax = glm::max(centerMax, center);
+    }
+
+    // cost of keeping this node as a leaf (every object tested)
+    float bestCost = count * surfaceArea(nodes[idx].bounds.min, nodes[idx].bounds.max);
+    int bestAxis = -1;
+    int bestSplit = 0; // last bin on the left side
+
+    for (int axis = 0; axis < 3; axis++) {
+        float extent = centerMax[axis] - centerMin[axis];
+        if (extent <= 0.0f) {
+            // all centers in one plane
+            continue;
+        }
+        float scale = BVH_BINS / extent;
+
+        // count objects and grow the box of each bin
+        unsigned int binCounts[BVH_BINS] = {};
+        glm::vec3 binMin[BVH_BINS], binMax[BVH_BINS];
+        for (int b = 0; b < BVH_BINS; b++) {
+            binMin[b] = glm::vec3(std::numeric_limits<float>::max());
+            binMax[b] = glm::vec3(std::numeric_limits<float>::lowest());
+        }
+        for (unsigned int i = first; i < first + count; i++) {
+            int b = calculateBin(objects[i], axis, centerMin[axis], scale);
+            glm::vec3 halfDimensions = objects[i].calculateDimensions() / 2.0f;
+            glm::vec3 center = objects[i].calculateCenter();
+
+            binCounts[b]++;
+            binMin[b] = glm::min(binMin[b], center - halfDimensions);
+            binMax[b] = glm::max(binMax[b], center + halfDimensions);
+        }
+
+        // sweep from the left to get the area and count left of each plane
+        float leftAreas[BVH_BINS - 1];
+        unsigned int leftCounts[BVH_BINS - 1];
+        glm::vec3 sweepMin(std::numeric_limits<float>::max());
+        glm::vec3 sweepMax(std::numeric_limits<float>::lowest());
+        unsigned int sweepCount = 0;
+        for (int b = 0; b < BVH_BINS - 1; b++) {
+            sweepCount += binCounts[b];
+            sweepMin = glm::min(sweepMin, binMin[b]);
+            sweepMax = glm::max(sweepMax, binMax[b]);
+            leftCounts[b] = sweepCount;
+            leftAreas[b] = sweepCount ? surfaceArea(sweepMin, sweepMax) : 0.0f;
+        }
+
+        // sweep from the right and evaluate each plane
+        sweepMin = glm::vec3(std::numeric_limits<float>::max());
+        sweepMax = glm::vec3(std::numeric_limits<float>::lowest());
+        sweepCount = 0;
+        for (int b = BVH_BINS - 1; b > 0; b--) {
+            sweepCount += binCounts[b];
+            sweepMin = glm::min(sweepMin, binMin[b]);
+            sweepMax = glm::max(sweepMax, binMax[b]);
+
+            if (sweepCount == 0 || leftCounts[b - 1] == 0) {
+                // plane does not split the objects
+                continue;
+            }
+
+            float cost = leftCounts[b - 1] * leftAreas[b - 1] + sweepCount * surfaceArea(sweepMin, sweepMax);
+            if (cost < bestCost) {
+                bestCost = cost;
+                bestAxis = axis;
+                bestSplit = b - 1;
+            }
+        }
+    }
+
+    if (bestAxis < 0) {
+        // no split is cheaper than testing every object
+        return;
+    }
+
+    // move objects left of the plane to the front
+    float centerMinAxis = centerMin[bestAxis];
+    float scale = BVH_BINS / (centerMax[bestAxis] - centerMinAxis);
+    unsigned int noLeft = std::partition(objects.begin() + first, objects.begin() + first + count,
+        [bestAxis, bestSplit, centerMinAxis, scale](const BoundingRegion& br) -> bool {
+            return calculateBin(br, bestAxis, centerMinAxis, scale) <= bestSplit;
+        }) - (objects.begin() + first);
+
+    // children are added together so the right one always follows the left one
+    unsigned int left = nodes.size();
+    node child;
+    child.left = 0;
+
+    child.firstObject = first;
+    child.noObjects = noLeft;
+    nodes.push_back(child);
+
+    child.firstObject = first + noLeft;
+    child.noObjects = count - noLeft;
+    nodes.push_back(child);
+
+    nodes[idx].left = left;
+
+    subdivide(left);
+    subdivide(left + 1);
+}
+
+// calculate box around the objects of the node at idx
+BoundingRegion BVH::calculateBounds(unsigned int idx) {
+    glm::vec3 min(std::numeric_limits<float>::max());
+    glm::vec3 max(std::numeric_limits<float>::lowest());
+
+    for (unsigned int i = nodes[idx].firstObject, end = i + nodes[idx].noObjects; i < end; i++) {
+        glm::vec3 halfDimensions = objects[i].calculateDimensions() / 2.0f;
+        glm::vec3 center = objects[i].calculateCenter();
+
+        min = glm::min(min, center - halfDimensions);
+        max = glm::max(max, center + halfDimensions);
+    }
+
+    glm::vec3 padding = (glm::abs(min) + glm::abs(max)) * BVH_PADDING;
+    return BoundingRegion(min - padding, max + padding);
+}
+
+// expected cost of a query relative to testing the root (SAH)
+float BVH::calculateCost() {
+    if (nodes.size() == 0) {
+        return 0.0f;
+    }
+
+    float rootArea = surfaceArea(nodes[0].bounds.min, nodes[0].bounds.max);
+    if (rootArea <= 0.0f) {
+        return 0.0f;
+    }
+
+    // every node is traversed and every object in a leaf is tested with the probability the box is hit
+    float cost = 0.0f;
+    for (node& n : nodes) {
+        float area = surfaceArea(n.bounds.min, n.bounds.max);
+        cost += (n.left == 0) ? area * n.noObjects : area;
+    }
+
+    return cost / rootArea;
+}
@@ -0,0 +1,121 @@
+/*****************************************************************
+ *   Author: Tyanna Prince
+ *   Date: 07/15/2023
+ *   Description: An enhancement of my cs330 OpenGL project where I added functionality such as charater movement,
+ *  directional lighting, and shadow mapping, a cubemap, and joystick support.
+ *  copyright (c) 2023 Tyanna Prince
+ *  version 2.0
+ *****************************************************************/
+
+#ifndef BVH_H
+#define BVH_H
+
+// buckets the object centers are sorted into when looking for the cheapest split
+#define BVH_BINS 16
+// nodes with at most this many objects are not split
+#define BVH_MAX_LEAF_OBJECTS 4
+// tree is rebuilt once refitting has made it this many times more expensive to traverse than when it was built
+#define BVH_REBUILD_RATIO 2.0f
+// leaf boxes are padded by this fraction of their coordinates, so rounding never prunes touching objects
+#define BVH_PADDING 1e-5f
+
+#include <vector>
+
+#include "spatialindex.h"
+
+/*
+    bounding volume hierarchy
+
+    - binary tree of boxes built top-down with the surface area heuristic (SAH),
+      evaluated over BVH_BINS buckets per axis
+    - every object ends up in exactly one leaf, so objects straddling a split are
+      never held back in upper nodes like in the octree
+    - moved objects refit the boxes bottom-up, the tree is rebuilt when refitting
+      has degraded it too far or objects were added or removed
+*/
+
+class BVH : public SpatialIndex {
+public:
+    /*
+        struct to represent each node in the hierarchy
+    */
+    struct node {
+        // box around every object in the branch (AABB)
+        BoundingRegion bounds;
+
+        // objects in the branch are contiguous in the object list
+        unsigned int firstObject;
+        unsigned int noObjects;
+
+        // index of left child (right child follows it), 0 for leaves
+        unsigned int left;
+    };
+
+    // list of nodes (root first, children always after their parent)
+    std::vector<node> nodes;
+
+    // list of objects sorted so the objects of every branch are contiguous
+    std::vector<BoundingRegion> objects;
+
+    // queue of objects to be inserted on the next rebuild
+    std::vector<BoundingRegion> queue;
+
+    // expected cost of a query (SAH) when the tree was built and after the last refit
+    float builtCost = 0.0f;
+    float currentCost = 0.0f;
+
+    // number of times the tree was rebuilt
+    unsigned int noRebuilds = 0;
+
+    /*
+        functionality
+    */
+
+    // add instance to pending queue
+    void addToPending(RigidBody* instance, Model* model);
+
+    // build tree from all objects (called during initialization)
+    void build();
+
+    // update objects in tree (called during each iteration of main loop)
+    void update(Box& box);
+
+    // process pending queue (rebuilds the tree if objects were added)
+    void processPending();
+
+    // recalculate the boxes of every node from the objects bottom-up
+    void refit();
+
+    // check collisions with a ray (closest hit)
+    BoundingRegion* checkCollisionsRay(Ray r, float& tmin);
+
+    // check collisions between the object and every other object it overlaps
+    void checkCollisionsRegion(const BoundingRegion& obj);
+
+    // find objects with a region intersecting the region
+    void queryRegion(const BoundingRegion& br, std::vector<BoundingRegion*>& found);
+
+    // find instances with a region inside the frustum (skips nodes outside, stops testing inside)
+    void checkCollisionsFrustum(Frustum& frustum, std::vector<RigidBody*>& instances);
+
+    // copy all objects in the tree into a list (pending objects are left out)
+    void collectObjects(std::vector<BoundingRegion>& objectList);
+
+    // add the tree to the tree statistics
+    void calculateStats(Stats::treeStats& stats);
+
+    // destroy object (free memory)
+    void destroy();
+
+private:
+    // split the node at idx along the cheapest binned SAH plane, then its children
+    void subdivide(unsigned int idx);
+
+    // calculate box around the objects of the node at idx
+    BoundingRegion calculateBounds(unsigned int idx);
+
+    // expected cost of a query relative to testing the root (SAH)
+    float calculateCost();
+};
+
+#endif
@@ -0,0 +1,132 @@
+/*****************************************************************
+ *   Author: Tyanna Prince
+ *   Date: 07/15/2023
+ *   Description: An enhancement of my cs330 OpenGL project where I added functionality such as charater movement,
+ *  directional lighting, and shadow mapping, a cubemap, and joystick support.
+ *  copyright (c) 2023 Tyanna Prince
+ *  version 2.0
+ *****************************************************************/
+
+#include "ccd.h"
+#include "events.h"
+#include "ray.h"
+#include "math/linalg.h"
+#include "../graphics/objects/model.h"
+#include "../physics/collisionmesh.h"
+#include "../physics/rigidbody.h"
+
+#include <limits>
+
+// radius of the sphere swept for a region (boxes sweep the largest sphere inside them)
+float CCD::calculateSweepRadius(const BoundingRegion& br) {
+    if (br.type == BoundTypes::SPHERE) {
+        return br.radius;
+    }
+
+    glm::vec3 dimensions = br.calculateDimensions();
+    return glm::min(dimensions.x, glm::min(dimensions.y, dimensions.z)) / 2.0f;
+}
+
+// time of impact (fraction of the motion) of a sphere moving from start to end against a region without a collision mesh
+bool CCD::sweepSphere(glm::vec3 start, glm::vec3 end, float radius, const BoundingRegion& br, float& t, glm::vec3& norm) {
+    glm::vec3 motion = end - start;
+
+    if (br.type == BoundTypes::SPHERE) {
+        // center reaches the sphere grown by the radius
+        if (!sweepSpherePoint(start, motion, radius + br.radius, br.center, t)) {
+            return false;
+        }
+        norm = start + t * motion - br.center;
+    }
+    else {
+        // center enters the box grown by the radius (corners are treated as square)
+        BoundingRegion grown(br.min - glm::vec3(radius), br.max + glm::vec3(radius));
+        float tmin = 0.0f, tmax = 0.0f;
+        if (!Ray(start, motion).intersectsBoundingRegion(grown, tmin, tmax) || tmin > 1.0f) {
+            return false;
+        }
+        t = std::fmaxf(tmin, 0.0f);
+
+        // from the closest point of the box to the center
+        glm::vec3 center = start + t * motion;
+        norm = center - glm::clamp(center, br.min, br.max);
+    }
+
+    if (glm::dot(norm, norm) == 0.0f) {
+        // center already inside, push back along the motion
+        norm = -motion;
+    }
+    return true;
+}
+
+// sweep an instance from its previous position through the indices, clamp it at the first contact and respond (false if nothing was hit)
+bool CCD::sweepInstance(RigidBody* instance, Model* model, std::vector<SpatialIndex*>& indices) {
+    glm::vec3 motion = instance->pos - instance->prevPos;
+    float travel = glm::length(motion);
+
+    // first contact
+    float tmin = std::numeric_limits<float>::max();
+    glm::vec3 norm;
+    RigidBody* hit = nullptr;
+
+    std::vector<BoundingRegion*> candidates;
+    for (BoundingRegion br : model->boundingRegions) {
+        br.instance = instance;
+        br.transform();
+
+        float radius = calculateSweepRadius(br);
+        if (travel <= CCD_TRAVEL_RATIO * radius) {
+            // too slow to pass through anything the discrete test would miss
+            continue;
+        }
+
+        glm::vec3 end = br.calculateCenter();
+        glm::vec3 start = end - motion;
+
+        // objects touching the region passed through during the step
+        BoundingRegion swept(glm::min(start, end) - glm::vec3(radius), glm::max(start, end) + glm::vec3(radius));
+        candidates.clear();
+        for (SpatialIndex* index : indices) {
+            index->queryRegion(swept, candidates);
+        }
+
+        for (BoundingRegion* candidate : candidates) {
+            if (candidate->instance == instance) {
+                // do not test collisions with the same instance
+                continue;
+            }
+
+            float t = 0.0f;
+            glm::vec3 n;
+            if (candidate->collisionMesh) {
+                // fine grain check with the faces of the collision mesh along the path
+                if (candidate->collisionMesh->sweepSphere(candidate->instance, start, end, radius, t, n) &&
+                    t < tmin) {
+                    // found closer contact (moving into the face)
+                    tmin = t;
+                    norm = n;
+                    hit = candidate->instance;
+                }
+            }
+            else if (sweepSphere(start, end, radius, *candidate, t, n) &&
+                t < tmin && glm::dot(n, motion) < 0.0f) {
+                // found closer contact (moving into the region)
+                tmin = t;
+                norm = n;
+                hit = candidate->instance;
+            }
+        }
+    }
+
+    if (!hit) {
+        return false;
+    }
+
+    // clamp at the first contact (the rest of the step is dropped), then respond (touching, so no overlap)
+    instance->pos = instance->prevPos + tmin * motion;
+    instance->update(0.0f);
+    Events::record(hit, instance, norm, 0.0f, Events::CollisionCase::SWEPT);
+    instance->handleCollision(hit, norm, 0.0f);
+
+    return true;
+}
@@ -0,0 +1,48 @@
+/*****************************************************************
+ *   Author: Tyanna Prince
+ *   Date: 07/15/2023
+ *   Description: An enhancement of my cs330 OpenGL project where I added functionality such as charater movement,
+ *  directional lighting, and shadow mapping, a cubemap, and joystick support.
+ *  copyright (c) 2023 Tyanna Prince
+ *  version 2.0
+ *****************************************************************/
+
+#ifndef CCD_H
+#define CCD_H
+
+// instances are only swept once they move further than this fraction of their radius in one step
+#define CCD_TRAVEL_RATIO 0.5f
+
+#include <vector>
+
+#include <glm/glm.hpp>
+
+#include "bounds.h"
+#include "spatialindex.h"
+
+// forward declaration
+class Model;
+class RigidBody;
+
+/*
+    namespace for continuous collision detection (CCD)
+
+    - the discrete tests only see where instances are at the end of a step, so an
+      instance moving further than its radius can pass straight through thin geometry
+    - instances with the INSTANCE_CCD switch sweep a sphere from their previous
+      position, find the time of impact against the objects along the way, then are
+      clamped at the first contact
+*/
+
+namespace CCD {
+    // radius of the sphere swept for a region (boxes sweep the largest sphere inside them)
+    float calculateSweepRadius(const BoundingRegion& br);
+
+    // time of impact (fraction of the motion) of a sphere moving from start to end against a region without a collision mesh
+    bool sweepSphere(glm::vec3 start, glm::vec3 end, float radius, const BoundingRegion& br, float& t, glm::vec3& norm);
+
+    // sweep an instance from its previous position through the indices, clamp it at the first contact and respond (false if nothing was hit)
+    bool sweepInstance(RigidBody* instance, Model* model, std::vector<SpatialIndex*>& indices);
+}
+
+#endif
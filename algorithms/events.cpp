@@ -0,0 +1,208 @@
+/*****************************************************************
+ *   Author: Tyanna Prince
+ *   Date: 07/15/2023
+ *   Description: An enhancement of my cs330 OpenGL project where I added functionality such as charater movement,
+ *  directional lighting, and shadow mapping, a cubemap, and joystick support.
+ *  copyright (c) 2023 Tyanna Prince
+ *  version 2.0
+ *****************************************************************/
+
+#include "events.h"
+#include "../physics/rigidbody.h"
+
+#include <algorithm>
+#include <future>
+#include <iostream>
+#include <sstream>
+#include <string>
+#include <utility>
+
+/*
+    event buffers
+*/
+
+std::vector<Events::collision> Events::frame;
+
+// records of this frame
+static std::vector<Events::collision> pending;
+// pairs touching last frame (sorted by pair)
+static std::vector<Events::collision> touching;
+
+// subscribed listeners with their ids
+static std::vector<std::pair<unsigned int, Events::listener>> listeners;
+static unsigned int nextListenerId = 0;
+
+// console output
+static bool logging = false;
+static std::future<void> logTask;
+
+// order pairs regardless of which instance reported them
+static bool comparePairs(const Events::collision& c1, const Events::collision& c2) {
+    std::less<RigidBody*> less;
+    RigidBody* first1 = less(c1.b, c1.a) ? c1.b : c1.a;
+    RigidBody* second1 = less(c1.b, c1.a) ? c1.a : c1.b;
+    RigidBody* first2 = less(c2.b, c2.a) ? c2.b : c2.a;
+    RigidBody* second2 = less(c2.b, c2.a) ? c2.a : c2.b;
+
+    if (first1 != first2) {
+        return less(first1, first2);
+    }
+    return less(second1, second2);
+}
+
+// determine if two records are for the same pair
+static bool samePair(const Events::collision& c1, const Events::collision& c2) {
+    return (c1.a == c2.a && c1.b == c2.b) || (c1.a == c2.b && c1.b == c2.a);
+}
+
+// write a line per event (called on the main thread, the instances may be gone by the time it is written)
+static void writeEvent(std::ostringstream& out, const Events::collision& e) {
+    static const char* verbs[] = { "starts colliding with", "collides with", "stops colliding with" };
+
+    out << "Case " << (int)e.type << ": Instance " << e.a->instanceId
+        << " (" << e.a->modelId << ") " << verbs[(int)e.phase] << " instance "
+        << e.b->instanceId << " (" << e.b->modelId << ")";
+    if (e.faceA >= 0 || e.faceB >= 0) {
+        out << " [faces " << e.faceA << ", " << e.faceB << "]";
+    }
+    out << '\n';
+}
+
+/*
+    recording
+*/
+
+// record a contact found this frame (norm points from a toward b)
+void Events::record(RigidBody* a, RigidBody* b, glm::vec3 norm, float depth, CollisionCase type, int faceA, int faceB) {
+    float length = glm::length(norm);
+    if (length > 0.0f) {
+        norm /= length;
+    }
+
+    pending.push_back({ a, b, norm, depth, faceA, faceB, type, CollisionPhase::BEGIN });
+}
+
+// turn the records of this frame into events and pass them to the listeners
+void Events::publish() {
+    // one record per pair, keep the deeper overlap
+    std::sort(pending.begin(), pending.end(), comparePairs);
+    unsigned int noPairs = 0;
+    for (unsigned int i = 0, len = pending.size(); i < len; i++) {
+        if (noPairs > 0 && samePair(pending[noPairs - 1], pending[i])) {
+            // reported again (both instances moved)
+            if (pending[i].depth > pending[noPairs - 1].depth) {
+                pending[noPairs - 1] = pending[i];
+            }
+        }
+        else {
+            pending[noPairs++] = pending[i];
+        }
+    }
+    pending.resize(noPairs);
+
+    // walk both sorted lists together
+    // - only this frame: BEGIN, both: STAY, only last frame: END (with the last contact)
+    frame.clear();
+    unsigned int i = 0, j = 0;
+    while (i < pending.size() || j < touching.size()) {
+        if (j == touching.size() || (i < pending.size() && comparePairs(pending[i], touching[j]))) {
+            pending[i].phase = CollisionPhase::BEGIN;
+            frame.push_back(pending[i++]);
+        }
+        else if (i == pending.size() || comparePairs(touching[j], pending[i])) {
+            touching[j].phase = CollisionPhase::END;
+            frame.push_back(touching[j++]);
+        }
+        else {
+            pending[i].phase = CollisionPhase::STAY;
+            frame.push_back(pending[i++]);
+            j++;
+        }
+    }
+
+    // this frame is last frame for the next publish (keeps both buffers allocated)
+    std::swap(touching, pending);
+    pending.clear();
+
+    // listeners must not subscribe or unsubscribe while being called
+    for (auto& l : listeners) {
+        for (const collision& e : frame) {
+            l.second(e);
+        }
+    }
+
+    if (logging && !frame.empty()) {
+        // format now (the instances may be deleted before the log is written), write in the background
+        std::ostringstream out;
+        for (const collision& e : frame) {
+            writeEvent(out, e);
+        }
+
+        // keep frames in order (only waits if the console falls behind)
+        if (logTask.valid()) {
+            logTask.wait();
+        }
+        logTask = std::async(std::launch::async, [](std::string text) {
+            std::cout << text << std::flush;
+        }, out.str());
+    }
+}
+
+/*
+    listeners
+*/
+
+// add a listener, returns the id to remove it with
+unsigned int Events::subscribe(listener l) {
+    listeners.push_back({ nextListenerId, l });
+    return nextListenerId++;
+}
+
+// remove a listener
+void Events::unsubscribe(unsigned int id) {
+    for (auto it = listeners.begin(); it != listeners.end(); it++) {
+        if (it->first == id) {
+            listeners.erase(it);
+            return;
+        }
+    }
+}
+
+/*
+    logging
+*/
+
+// write the events to the console on a background thread (off by default)
+void Events::setLogging(bool enabled) {
+    logging = enabled;
+}
+
+bool Events::isLogging() {
+    return logging;
+}
+
+/*
+    cleanup
+*/
+
+// forget the contacts of an instance being deleted (no END event, the instance is gone)
+void Events::removeInstance(RigidBody* rb) {
+    auto involves = [rb](const collision& c) -> bool {
+        return c.a == rb || c.b == rb;
+    };
+
+    pending.erase(std::remove_if(pending.begin(), pending.end(), involves), pending.end());
+    touching.erase(std::remove_if(touching.begin(), touching.end(), involves), touching.end());
+    frame.erase(std::remove_if(frame.begin(), frame.end(), involves), frame.end());
+}
+
+// forget every contact and wait for the log to be written
+void Events::clear() {
+    pending.clear();
+    touching.clear();
+    frame.clear();
+
+    if (logTask.valid()) {
+        logTask.wait();
+    }
+}
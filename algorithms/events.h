@@ -0,0 +1,98 @@
+/*****************************************************************
+ *   Author: Tyanna Prince
+ *   Date: 07/15/2023
+ *   Description: An enhancement of my cs330 OpenGL project where I added functionality such as charater movement,
+ *  directional lighting, and shadow mapping, a cubemap, and joystick support.
+ *  copyright (c) 2023 Tyanna Prince
+ *  version 2.0
+ *****************************************************************/
+
+#ifndef EVENTS_H
+#define EVENTS_H
+
+#include <functional>
+#include <vector>
+
+#include <glm/glm.hpp>
+
+// forward declaration
+class RigidBody;
+
+/*
+    namespace for the collision event stream
+
+    - the narrowphase records each contact it finds as a plain record (no output, no allocation
+      once the buffer has grown), a pair reported twice in a frame counts once
+    - at the end of the frame the records are compared with the pairs touching last frame, so
+      each pair produces one BEGIN, STAY or END event, which is passed to the subscribed listeners
+    - writing the events to the console is opt-in and done on a background thread
+*/
+
+namespace Events {
+    // which test found the contact (numbered like the old console output)
+    enum class CollisionCase : unsigned char {
+        MESH_MESH = 1,      // both instances have collision meshes
+        MESH_SPHERE = 2,    // first instance has a collision mesh, second does not
+        SPHERE_MESH = 3,    // second instance has a collision mesh, first does not
+        REGIONS = 4,        // neither has a collision mesh (bounding regions)
+        SWEPT = 5           // continuous collision sweep
+    };
+
+    // how a contact relates to the last frame
+    enum class CollisionPhase : unsigned char {
+        BEGIN = 0x00,       // touching, was not last frame
+        STAY = 0x01,        // touching this frame and last frame
+        END = 0x02          // touched last frame, not any more
+    };
+
+    /*
+        struct to represent a collision event
+    */
+
+    struct collision {
+        // pair (as reported by the narrowphase)
+        RigidBody* a;
+        RigidBody* b;
+
+        // unit normal from a toward b
+        glm::vec3 norm;
+        // overlap along the normal in m
+        float depth;
+
+        // index of the face hit in the collision mesh of a and b (-1 if none)
+        int faceA;
+        int faceB;
+
+        CollisionCase type;
+        CollisionPhase phase;
+    };
+
+    // function called with each event
+    typedef std::function<void(const collision&)> listener;
+
+    // events published for the last frame
+    extern std::vector<collision> frame;
+
+    // record a contact found this frame (norm points from a toward b)
+    void record(RigidBody* a, RigidBody* b, glm::vec3 norm, float depth, CollisionCase type, int faceA = -1, int faceB = -1);
+
+    // turn the records of this frame into events and pass them to the listeners
+    void publish();
+
+    // add a listener, returns the id to remove it with
+    unsigned int subscribe(listener l);
+    // remove a listener
+    void unsubscribe(unsigned int id);
+
+    // write the events to the console on a background thread (off by default)
+    void setLogging(bool enabled);
+    bool isLogging();
+
+    // forget the contacts of an instance being deleted (no END event, the instance is gone)
+    void removeInstance(RigidBody* rb);
+
+    // forget every contact and wait for the log to be written
+    void clear();
+}
+
+#endif
@@ -0,0 +1,80 @@
+/*****************************************************************
+ *   Author: Tyanna Prince
+ *   Date: 07/15/2023
+ *   Description: An enhancement of my cs330 OpenGL project where I added functionality such as charater movement,
+ *  directional lighting, and shadow mapping, a cubemap, and joystick support.
+ *  copyright (c) 2023 Tyanna Prince
+ *  version 2.0
+ *****************************************************************/
+
+#include "frustum.h"
+
+/*
+    constructors
+*/
+
+// default (contains everything)
+Frustum::Frustum() {
+    for (int i = 0; i < NO_FRUSTUM_PLANES; i++) {
+        planes[i] = glm::vec4(0.0f);
+    }
+}
+
+// extract planes from the combined projection * view matrix
+Frustum::Frustum(glm::mat4 viewProjection) {
+    // rows of the matrix (glm is column major)
+    glm::vec4 rows[4];
+    for (int i = 0; i < 4; i++) {
+        rows[i] = glm::vec4(viewProjection[0][i], viewProjection[1][i], viewProjection[2][i], viewProjection[3][i]);
+    }
+
+    // each plane is the w row plus or minus the x, y or z row
+    for (int i = 0; i < 3; i++) {
+        planes[2 * i] = rows[3] + rows[i];
+        planes[2 * i + 1] = rows[3] - rows[i];
+    }
+
+    // normalize so distances are in world units
+    for (int i = 0; i < NO_FRUSTUM_PLANES; i++) {
+        planes[i] /= glm::length(glm::vec3(planes[i]));
+    }
+}
+
+/*
+    testing methods
+*/
+
+// determine if region is outside, crossing or inside the frustum
+FrustumTest Frustum::testRegion(const BoundingRegion& br) {
+    glm::vec3 center;
+    glm::vec3 halfDimensions;
+    if (br.type == BoundTypes::AABB) {
+        center = br.calculateCenter();
+        halfDimensions = br.calculateDimensions() / 2.0f;
+    }
+    else {
+        center = br.center;
+    }
+
+    FrustumTest ret = FrustumTest::INSIDE;
+    for (int i = 0; i < NO_FRUSTUM_PLANES; i++) {
+        glm::vec3 norm = glm::vec3(planes[i]);
+
+        // signed distance of center and how far the region reaches towards the plane
+        float dist = glm::dot(norm, center) + planes[i].w;
+        float reach = br.type == BoundTypes::AABB
+            ? glm::dot(halfDimensions, glm::abs(norm))
+            : br.radius;
+
+        if (dist < -reach) {
+            // completely behind this plane
+            return FrustumTest::OUTSIDE;
+        }
+        if (dist < reach) {
+            // crosses this plane
+            ret = FrustumTest::INTERSECTS;
+        }
+    }
+
+    return ret;
+}
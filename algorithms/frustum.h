@@ -0,0 +1,56 @@
+/*****************************************************************
+ *   Author: Tyanna Prince
+ *   Date: 07/15/2023
+ *   Description: An enhancement of my cs330 OpenGL project where I added functionality such as charater movement,
+ *  directional lighting, and shadow mapping, a cubemap, and joystick support.
+ *  copyright (c) 2023 Tyanna Prince
+ *  version 2.0
+ *****************************************************************/
+
+#ifndef FRUSTUM_H
+#define FRUSTUM_H
+
+#define NO_FRUSTUM_PLANES 6
+
+#include <glm/glm.hpp>
+
+#include "bounds.h"
+
+/*
+    enum for results of testing a region against the frustum
+*/
+
+enum class FrustumTest : unsigned char {
+    OUTSIDE     = 0x00,	// completely outside at least one plane
+    INTERSECTS  = 0x01,	// crosses at least one plane
+    INSIDE      = 0x02	// completely inside all planes
+};
+
+/*
+    class to represent the view frustum of a camera
+*/
+
+class Frustum {
+public:
+    // planes (xyz = normal pointing inwards, w = distance): left, right, bottom, top, near, far
+    glm::vec4 planes[NO_FRUSTUM_PLANES];
+
+    /*
+        constructors
+    */
+
+    // default (contains everything)
+    Frustum();
+
+    // extract planes from the combined projection * view matrix
+    Frustum(glm::mat4 viewProjection);
+
+    /*
+        testing methods
+    */
+
+    // determine if region is outside, crossing or inside the frustum
+    FrustumTest testRegion(const BoundingRegion& br);
+};
+
+#endif
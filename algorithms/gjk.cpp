@@ -0,0 +1,298 @@
+/*****************************************************************
+ *   Author: Tyanna Prince
+ *   Date: 07/15/2023
+ *   Description: An enhancement of my cs330 OpenGL project where I added functionality such as charater movement,
+ *  directional lighting, and shadow mapping, a cubemap, and joystick support.
+ *  copyright (c) 2023 Tyanna Prince
+ *  version 2.0
+ *****************************************************************/
+
+#include "gjk.h"
+#include "stats.h"
+
+#include <limits>
+
+/*
+    struct to represent each face of the EPA polytope
+*/
+
+struct polytopeFace {
+    // corners (wound so the normal points out of the polytope)
+    glm::vec3 points[3];
+    // unit normal
+    glm::vec3 norm;
+};
+
+// point of the Minkowski difference (b - a) furthest along a direction
+static glm::vec3 supportDifference(const std::vector<glm::vec3>& a, const std::vector<glm::vec3>& b, glm::vec3 dir) {
+    return GJK::support(b, dir) - GJK::support(a, -dir);
+}
+
+// reduce a triangle simplex to the feature closest to the origin and get the next search direction (a is the newest point)
+static void updateTriangle(glm::vec3& a, glm::vec3& b, glm::vec3& c, glm::vec3& d, int& noPoints, glm::vec3& dir) {
+    glm::vec3 n = glm::cross(b - a, c - a);
+    glm::vec3 ao = -a;
+
+    noPoints = 2;
+    if (glm::dot(glm::cross(b - a, n), ao) > 0.0f) {
+        // closest to edge ab
+        c = a;
+        dir = glm::cross(glm::cross(b - a, ao), b - a);
+        return;
+    }
+    if (glm::dot(glm::cross(n, c - a), ao) > 0.0f) {
+        // closest to edge ac
+        b = a;
+        dir = glm::cross(glm::cross(c - a, ao), c - a);
+        return;
+    }
+
+    noPoints = 3;
+    if (glm::dot(n, ao) > 0.0f) {
+        // above the triangle
+        d = c;
+        c = b;
+        b = a;
+        dir = n;
+        return;
+    }
+
+    // below the triangle (flip winding so the origin is above)
+    d = b;
+    b = a;
+    dir = -n;
+}
+
+// reduce a tetrahedron simplex to the face the origin is in front of (true if the origin is enclosed, a is the newest point)
+static bool updateTetrahedron(glm::vec3& a, glm::vec3& b, glm::vec3& c, glm::vec3& d, int& noPoints, glm::vec3& dir) {
+    // the origin is known to be above bcd, so only the faces through a are checked
+    glm::vec3 abc = glm::cross(b - a, c - a);
+    glm::vec3 acd = glm::cross(c - a, d - a);
+    glm::vec3 adb = glm::cross(d - a, b - a);
+    glm::vec3 ao = -a;
+
+    noPoints = 3;
+    if (glm::dot(abc, ao) > 0.0f) {
+        // in front of abc
+        d = c;
+        c = b;
+        b = a;
+        dir = abc;
+        return false;
+    }
+    if (glm::dot(acd, ao) > 0.0f) {
+        // in front of acd
+        b = a;
+        dir = acd;
+        return false;
+    }
+    if (glm::dot(adb, ao) > 0.0f) {
+        // in front of adb
+        c = d;
+        d = b;
+        b = a;
+        dir = adb;
+        return false;
+    }
+
+    // behind every face
+    return true;
+}
+
+// make a polytope face wound away from a point inside (false if the face has no area)
+static bool makeFace(glm::vec3 p1, glm::vec3 p2, glm::vec3 p3, glm::vec3 inside, polytopeFace& face) {
+    glm::vec3 n = glm::cross(p2 - p1, p3 - p1);
+    float length = glm::length(n);
+    if (length == 0.0f) {
+        return false;
+    }
+    n /= length;
+
+    if (glm::dot(n, p1 - inside) < 0.0f) {
+        // facing inward, flip
+        face = { { p1, p3, p2 }, -n };
+    }
+    else {
+        face = { { p1, p2, p3 }, n };
+    }
+    return true;
+}
+
+// grow the tetrahedron around the origin out to the surface of the Minkowski difference (EPA), get the closest face
+static void expandPolytope(glm::vec3 a, glm::vec3 b, glm::vec3 c, glm::vec3 d,
+    const std::vector<glm::vec3>& shapeA, const std::vector<glm::vec3>& shapeB, glm::vec3& norm, float& depth) {
+    polytopeFace faces[EPA_MAX_FACES];
+    int noFaces = 0;
+
+    glm::vec3 centroid = (a + b + c + d) / 4.0f;
+    glm::vec3 corners[4][3] = { { a, b, c }, { a, c, d }, { a, d, b }, { b, d, c } };
+    for (int i = 0; i < 4; i++) {
+        if (makeFace(corners[i][0], corners[i][1], corners[i][2], centroid, faces[noFaces])) {
+            noFaces++;
+        }
+    }
+
+    if (noFaces < 4) {
+        // flat tetrahedron, the origin is on its surface (touching)
+        norm = glm::vec3(0.0f);
+        depth = 0.0f;
+        return;
+    }
+
+    int closest = 0;
+    float minDistance = 0.0f;
+    for (int iterations = 0; iterations < EPA_MAX_ITERATIONS; iterations++) {
+        // find face closest to the origin
+        minDistance = std::numeric_limits<float>::max();
+        for (int i = 0; i < noFaces; i++) {
+            float distance = glm::dot(faces[i].points[0], faces[i].norm);
+            if (distance < minDistance) {
+                minDistance = distance;
+                closest = i;
+            }
+        }
+
+        // search past that face
+        glm::vec3 searchDir = faces[closest].norm;
+        glm::vec3 p = supportDifference(shapeA, shapeB, searchDir);
+        if (glm::dot(p, searchDir) - minDistance < EPA_TOLERANCE) {
+            // surface reached
+            break;
+        }
+
+        // remove faces that can see p, keeping the edges of the hole they leave
+        glm::vec3 looseEdges[EPA_MAX_LOOSE_EDGES][2];
+        int noLooseEdges = 0;
+        for (int i = 0; i < noFaces; i++) {
+            if (glm::dot(faces[i].norm, p - faces[i].points[0]) <= 0.0f) {
+                continue;
+            }
+
+            for (int j = 0; j < 3; j++) {
+                glm::vec3 edge[2] = { faces[i].points[j], faces[i].points[(j + 1) % 3] };
+
+                // an edge shared with another removed face (wound the other way) is inside the hole
+                bool found = false;
+                for (int k = 0; k < noLooseEdges; k++) {
+                    if (looseEdges[k][0] == edge[1] && looseEdges[k][1] == edge[0]) {
+                        noLooseEdges--;
+                        looseEdges[k][0] = looseEdges[noLooseEdges][0];
+                        looseEdges[k][1] = looseEdges[noLooseEdges][1];
+                        found = true;
+                        break;
+                    }
+                }
+
+                if (!found && noLooseEdges < EPA_MAX_LOOSE_EDGES) {
+                    looseEdges[noLooseEdges][0] = edge[0];
+                    looseEdges[noLooseEdges][1] = edge[1];
+                    noLooseEdges++;
+                }
+            }
+
+            // swap-and-pop
+            noFaces--;
+            faces[i] = faces[noFaces];
+            i--;
+        }
+
+        // close the hole with faces to p
+        for (int i = 0; i < noLooseEdges && noFaces < EPA_MAX_FACES; i++) {
+            if (makeFace(looseEdges[i][0], looseEdges[i][1], p, centroid, faces[noFaces])) {
+                noFaces++;
+            }
+        }
+
+        if (noFaces == 0) {
+            // rounding removed the whole polytope
+            norm = searchDir;
+            depth = minDistance;
+            return;
+        }
+    }
+
+    // closest face found (converged or out of iterations)
+    norm = faces[closest].norm;
+    depth = minDistance;
+}
+
+// point of the shape furthest along a direction
+glm::vec3 GJK::support(const std::vector<glm::vec3>& points, glm::vec3 dir) {
+    unsigned int furthest = 0;
+    float maxDistance = std::numeric_limits<float>::lowest();
+    for (unsigned int i = 0, len = points.size(); i < len; i++) {
+        float distance = glm::dot(points[i], dir);
+        if (distance > maxDistance) {
+            maxDistance = distance;
+            furthest = i;
+        }
+    }
+    return points[furthest];
+}
+
+// check if two convex shapes (given by their points) overlap
+bool GJK::collide(const std::vector<glm::vec3>& a, const std::vector<glm::vec3>& b, glm::vec3& norm, float& depth) {
+    Stats::noConvexTests++;
+
+    if (a.size() == 0 || b.size() == 0) {
+        return false;
+    }
+
+    // simplex (p1 is always the newest point)
+    glm::vec3 p1, p2, p3, p4;
+    int noPoints = 0;
+
+    // start with the direction between the shapes
+    glm::vec3 dir = b[0] - a[0];
+    if (glm::dot(dir, dir) == 0.0f) {
+        dir = glm::vec3(1.0f, 0.0f, 0.0f);
+    }
+
+    p3 = supportDifference(a, b, dir);
+    dir = -p3;
+
+    p2 = supportDifference(a, b, dir);
+    if (glm::dot(p2, dir) < 0.0f) {
+        // did not pass the origin
+        return false;
+    }
+
+    // search perpendicular to the segment toward the origin
+    dir = glm::cross(glm::cross(p3 - p2, -p2), p3 - p2);
+    if (glm::dot(dir, dir) == 0.0f) {
+        // origin on the segment, any perpendicular will do
+        dir = glm::cross(p3 - p2, glm::vec3(1.0f, 0.0f, 0.0f));
+        if (glm::dot(dir, dir) == 0.0f) {
+            dir = glm::cross(p3 - p2, glm::vec3(0.0f, 0.0f, 1.0f));
+        }
+    }
+    noPoints = 2;
+
+    for (int iterations = 0; iterations < GJK_MAX_ITERATIONS; iterations++) {
+        p1 = supportDifference(a, b, dir);
+        if (glm::dot(p1, dir) < 0.0f) {
+            // did not pass the origin
+            return false;
+        }
+
+        noPoints++;
+        if (noPoints == 3) {
+            updateTriangle(p1, p2, p3, p4, noPoints, dir);
+        }
+        else if (updateTetrahedron(p1, p2, p3, p4, noPoints, dir)) {
+            // origin enclosed, find how far they overlap
+            expandPolytope(p1, p2, p3, p4, a, b, norm, depth);
+
+            if (depth <= 0.0f) {
+                // only touching
+                return false;
+            }
+
+            // the difference moves out of the origin along the face normal when b moves against it
+            norm = -norm;
+            return true;
+        }
+    }
+
+    return false;
+}
@@ -0,0 +1,48 @@
+/*****************************************************************
+ *   Author: Tyanna Prince
+ *   Date: 07/15/2023
+ *   Description: An enhancement of my cs330 OpenGL project where I added functionality such as charater movement,
+ *  directional lighting, and shadow mapping, a cubemap, and joystick support.
+ *  copyright (c) 2023 Tyanna Prince
+ *  version 2.0
+ *****************************************************************/
+
+#ifndef GJK_H
+#define GJK_H
+
+// simplex updates before GJK gives up (only reached by rounding on touching shapes)
+#define GJK_MAX_ITERATIONS 64
+// polytope expansions before EPA settles for the closest face found
+#define EPA_MAX_ITERATIONS 64
+// most faces/open edges the EPA polytope can hold
+#define EPA_MAX_FACES 64
+#define EPA_MAX_LOOSE_EDGES 32
+// EPA stops once a new support point is no further than this from the closest face (in m)
+#define EPA_TOLERANCE 1e-4f
+
+#include <vector>
+
+#include <glm/glm.hpp>
+
+/*
+    namespace for the GJK and EPA algorithms on convex shapes
+
+    - the shapes overlap if the Minkowski difference (every point of b minus
+      every point of a) contains the origin
+    - GJK searches the difference with support points (the point furthest along
+      a direction) for a tetrahedron around the origin, so a convex mesh is
+      tested in a handful of passes over its points instead of face by face
+    - EPA grows that tetrahedron out to the surface of the difference, the face
+      closest to the origin gives the penetration normal and depth
+*/
+
+namespace GJK {
+    // point of the shape furthest along a direction
+    glm::vec3 support(const std::vector<glm::vec3>& points, glm::vec3 dir);
+
+    // check if two convex shapes (given by their points) overlap
+    // - norm points from a toward b (direction to push b out), depth is how far b has to move
+    bool collide(const std::vector<glm::vec3>& a, const std::vector<glm::vec3>& b, glm::vec3& norm, float& depth);
+}
+
+#endif
@@ -0,0 +1,431 @@
+/*****************************************************************
+ *   Author: Tyanna Prince
+ *   Date: 07/15/2023
+ *   Description: An enhancement of my cs330 OpenGL project where I added functionality such as charater movement,
+ *  directional lighting, and shadow mapping, a cubemap, and joystick support.
+ *  copyright (c) 2023 Tyanna Prince
+ *  version 2.0
+ *****************************************************************/
+
+#include "hashgrid.h"
+#include "octree.h"
+#include "../graphics/models/box.hpp"
+
+#include <algorithm>
+#include <cmath>
+
+/*
+    constructor
+*/
+
+// initialize with edge length of the cells
+HashGrid::HashGrid(float cellSize)
+    : cellSize(cellSize), maxHalfDimensions(0.0f),
+    minCell(std::numeric_limits<int>::max()), maxCell(std::numeric_limits<int>::lowest()) {}
+
+/*
+    functionality
+*/
+
+// add instance to pending queue
+void HashGrid::addToPending(RigidBody* instance, Model* model) {
+    // get all bounding regions of model and put them in queue
+    for (BoundingRegion br : model->boundingRegions) {
+        br.instance = instance;
+        br.transform();
+        queue.push_back(br);
+    }
+}
+
+// insert objects waiting in the pending queue
+void HashGrid::processPending() {
+    for (const BoundingRegion& br : queue) {
+        if (!States::isActive(&br.instance->state, INSTANCE_DEAD)) {
+            insert(br);
+        }
+    }
+    queue.clear();
+}
+
+// update objects in grid (called during each iteration of main loop)
+void HashGrid::update(Box& box) {
+    for (std::pair<const unsigned long long, std::vector<unsigned int>>& cell : cells) {
+        BoundingRegion bounds = calculateBounds(cell.first);
+        box.positions.push_back(bounds.calculateCenter());
+        box.sizes.push_back(bounds.calculateDimensions());
+    }
+
+    /*
+        single pass over objects (removal is swap-and-pop, so do not advance i after removing)
+        - remove objects that don't exist anymore
+        - transform moved objects and move them to the cell now holding their center
+    */
+    std::vector<unsigned int> movedObjects;
+    for (unsigned int i = 0; i < objects.size();) {
+        // remove if kill switch active
+        if (States::isActive(&objects[i].instance->state, INSTANCE_DEAD)) {
+            removeObject(i);
+            continue;
+        }
+
+        if (States::isActive(&objects[i].instance->state, INSTANCE_MOVED)) {
+            // if moved switch active, transform region and find its cell
+            objects[i].transform();
+            maxHalfDimensions = glm::max(maxHalfDimensions, objects[i].calculateDimensions() / 2.0f);
+            movedObjects.push_back(i);
+
+            unsigned long long key = packCell(calculateCell(objects[i].calculateCenter()));
+            if (key != objectCells[i]) {
+                leaveCell(i);
+                enterCell(i, key);
+                noCellChanges++;
+            }
+        }
+
+        box.positions.push_back(objects[i].calculateCenter());
+        box.sizes.push_back(objects[i].calculateDimensions());
+
+        i++;
+    }
+
+    // collision detection once every object is in its new cell (unless pairs are found by a separate broadphase stage)
+    for (unsigned int i = 0, len = detectCollisions ? movedObjects.size() : 0; i < len; i++) {
+        BoundingRegion& movedObj = objects[movedObjects[i]];
+        checkCollisionsRegion(movedObj);
+
+        if (linkedIndex) {
+            // objects kept in the other index
+            linkedIndex->checkCollisionsRegion(movedObj);
+        }
+    }
+
+    processPending();
+}
+
+// check collisions with a ray (only hits nearer than tmin)
+BoundingRegion* HashGrid::checkCollisionsRay(Ray r, float& tmin) {
+    std::vector<RayHit> hits;
+    checkCollisionsCells(r, 0, RayQuery::CLOSEST, tmin, hits);
+
+    return hits.size() != 0 ? hits[0].region : nullptr;
+}
+
+// check collisions of a packet of rays (appends the hits of each ray sorted by distance)
+void HashGrid::checkCollisionsRays(std::vector<Ray>& rays, std::vector<RayHit>& hits, RayQuery mode, float maxDistance) {
+    std::vector<RayHit> rayHits;
+    for (unsigned int i = 0, len = rays.size(); i < len; i++) {
+        float tmin = maxDistance;
+        rayHits.clear();
+        checkCollisionsCells(rays[i], i, mode, tmin, rayHits);
+
+        std::sort(rayHits.begin(), rayHits.end(), [](const RayHit& h1, const RayHit& h2) -> bool {
+            return h1.t < h2.t;
+        });
+        hits.insert(hits.end(), rayHits.begin(), rayHits.end());
+    }
+}
+
+// check collisions between the object and every object in the grid it overlaps
+void HashGrid::checkCollisionsRegion(const BoundingRegion& obj) {
+    visitNeighbours(obj, [this, &obj](const std::vector<unsigned int>& cellObjects) -> void {
+        for (unsigned int idx : cellObjects) {
+            if (objects[idx].instance->instanceId == obj.instance->instanceId) {
+                // do not test collisions with the same instance
+                continue;
+            }
+
+            Octree::checkCollisionsPair(objects[idx], obj);
+        }
+    });
+}
+
+// find objects with a region intersecting the region
+void HashGrid::queryRegion(const BoundingRegion& br, std::vector<BoundingRegion*>& found) {
+    visitNeighbours(br, [this, &br, &found](const std::vector<unsigned int>& cellObjects) -> void {
+        for (unsigned int idx : cellObjects) {
+            if (objects[idx].intersectsWith(br)) {
+                found.push_back(&objects[idx]);
+            }
+        }
+    });
+}
+
+// find instances with a region inside the frustum (skips cells outside, stops testing inside)
+void HashGrid::checkCollisionsFrustum(Frustum& frustum, std::vector<RigidBody*>& instances) {
+    for (std::pair<const unsigned long long, std::vector<unsigned int>>& cell : cells) {
+        if (cell.second.size() == 1) {
+            // cheaper to test the object than the cell
+            if (frustum.testRegion(objects[cell.second[0]]) != FrustumTest::OUTSIDE) {
+                instances.push_back(objects[cell.second[0]].instance);
+            }
+            continue;
+        }
+
+        FrustumTest result = frustum.testRegion(calculateBounds(cell.first));
+        if (result == FrustumTest::OUTSIDE) {
+            // nothing in this cell can be seen
+            continue;
+        }
+
+        for (unsigned int idx : cell.second) {
+            if (result == FrustumTest::INSIDE || frustum.testRegion(objects[idx]) != FrustumTest::OUTSIDE) {
+                instances.push_back(objects[idx].instance);
+            }
+        }
+    }
+
+    // objects waiting to be inserted
+    for (const BoundingRegion& br : queue) {
+        if (frustum.testRegion(br) != FrustumTest::OUTSIDE) {
+            instances.push_back(br.instance);
+        }
+    }
+}
+
+// copy all objects in the grid into a list (pending objects are left out)
+void HashGrid::collectObjects(std::vector<BoundingRegion>& objectList) {
+    objectList.insert(objectList.end(), objects.begin(), objects.end());
+}
+
+// add the grid to the tree statistics (each occupied cell counts as a leaf)
+void HashGrid::calculateStats(Stats::treeStats& stats) {
+    for (std::pair<const unsigned long long, std::vector<unsigned int>>& cell : cells) {
+        stats.addNode(0, true, cell.second.size(), 0);
+    }
+    stats.noPending += queue.size();
+}
+
+// destroy object (free memory)
+void HashGrid::destroy() {
+    cells.clear();
+    objects.clear();
+    objectCells.clear();
+    cellSlots.clear();
+    queue.clear();
+    maxHalfDimensions = glm::vec3(0.0f);
+    minCell = glm::ivec3(std::numeric_limits<int>::max());
+    maxCell = glm::ivec3(std::numeric_limits<int>::lowest());
+}
+
+/*
+    cell methods
+*/
+
+// get coordinates of the cell containing the point
+glm::ivec3 HashGrid::calculateCell(glm::vec3 point) {
+    return glm::ivec3(glm::floor(point / cellSize));
+}
+
+// pack cell coordinates into a key
+unsigned long long HashGrid::packCell(glm::ivec3 cell) {
+    const unsigned long long mask = (1ull << HASH_GRID_KEY_BITS) - 1;
+
+    return (((unsigned long long)cell.x & mask) << (2 * HASH_GRID_KEY_BITS)) |
+        (((unsigned long long)cell.y & mask) << HASH_GRID_KEY_BITS) |
+        ((unsigned long long)cell.z & mask);
+}
+
+// unpack key into cell coordinates
+glm::ivec3 HashGrid::unpackCell(unsigned long long key) {
+    const unsigned long long mask = (1ull << HASH_GRID_KEY_BITS) - 1;
+    const int sign = 1 << (HASH_GRID_KEY_BITS - 1);
+
+    glm::ivec3 ret;
+    for (int i = 0; i < 3; i++) {
+        // sign extend each field
+        int field = (int)((key >> ((2 - i) * HASH_GRID_KEY_BITS)) & mask);
+        ret[i] = (field ^ sign) - sign;
+    }
+
+    return ret;
+}
+
+// calculate bounds of a cell widened to hold every object centered in it
+BoundingRegion HashGrid::calculateBounds(unsigned long long key) {
+    glm::vec3 min = glm::vec3(unpackCell(key)) * cellSize;
+
+    return BoundingRegion(min - maxHalfDimensions, min + glm::vec3(cellSize) + maxHalfDimensions);
+}
+
+/*
+    private methods
+*/
+
+// add object to the grid
+void HashGrid::insert(const BoundingRegion& br) {
+    objects.push_back(br);
+    objectCells.push_back(0);
+    cellSlots.push_back(0);
+    maxHalfDimensions = glm::max(maxHalfDimensions, br.calculateDimensions() / 2.0f);
+
+    unsigned int idx = objects.size() - 1;
+    enterCell(idx, packCell(calculateCell(br.calculateCenter())));
+}
+
+// remove object at idx (swap-and-pop, so the last object moves to idx)
+void HashGrid::removeObject(unsigned int idx) {
+    leaveCell(idx);
+
+    unsigned int last = objects.size() - 1;
+    if (idx != last) {
+        objects[idx] = objects[last];
+        objectCells[idx] = objectCells[last];
+        cellSlots[idx] = cellSlots[last];
+
+        // point the cell of the moved object at its new index
+        cells[objectCells[idx]][cellSlots[idx]] = idx;
+    }
+
+    objects.pop_back();
+    objectCells.pop_back();
+    cellSlots.pop_back();
+}
+
+// take the object at idx out of the list of its cell
+void HashGrid::leaveCell(unsigned int idx) {
+    auto it = cells.find(objectCells[idx]);
+    std::vector<unsigned int>& cellObjects = it->second;
+
+    // swap-and-pop within the cell
+    unsigned int slot = cellSlots[idx];
+    cellObjects[slot] = cellObjects.back();
+    cellSlots[cellObjects[slot]] = slot;
+    cellObjects.pop_back();
+
+    if (cellObjects.size() == 0) {
+        // only keep occupied cells
+        cells.erase(it);
+    }
+}
+
+// put the object at idx into the list of the cell with the key
+void HashGrid::enterCell(unsigned int idx, unsigned long long key) {
+    std::vector<unsigned int>& cellObjects = cells[key];
+    objectCells[idx] = key;
+    cellSlots[idx] = cellObjects.size();
+    cellObjects.push_back(idx);
+
+    glm::ivec3 coords = unpackCell(key);
+    minCell = glm::min(minCell, coords);
+    maxCell = glm::max(maxCell, coords);
+}
+
+// march a ray through the cells (3D DDA), checking the objects centered near each cell (hits recorded as in mode)
+void HashGrid::checkCollisionsCells(Ray& r, unsigned int rayIdx, RayQuery mode, float& tmin, std::vector<RayHit>& hits) {
+    if (objects.size() == 0) {
+        return;
+    }
+
+    // only march through the part of the ray that passes the occupied cells
+    BoundingRegion bounds(glm::vec3(minCell) * cellSize - maxHalfDimensions,
+        glm::vec3(maxCell + glm::ivec3(1)) * cellSize + maxHalfDimensions);
+    float tEnter = std::numeric_limits<float>::max();
+    float tExit = std::numeric_limits<float>::lowest();
+    if (!r.intersectsBoundingRegion(bounds, tEnter, tExit)) {
+        return;
+    }
+    tEnter = std::fmaxf(tEnter, 0.0f);
+
+    // an object can be hit from any cell within its half dimensions of its center
+    glm::ivec3 reach = glm::ivec3(maxHalfDimensions / cellSize) + glm::ivec3(1);
+
+    // cell holding the point the ray enters at, with the distance to the next border on each axis
+    glm::ivec3 cell = calculateCell(r.origin + r.dir * tEnter);
+    glm::ivec3 step;
+    glm::vec3 tNext, tDelta;
+    for (int i = 0; i < 3; i++) {
+        if (r.dir[i] > 0.0f) {
+            step[i] = 1;
+            tNext[i] = ((cell[i] + 1) * cellSize - r.origin[i]) / r.dir[i];
+            tDelta[i] = cellSize / r.dir[i];
+        }
+        else if (r.dir[i] < 0.0f) {
+            step[i] = -1;
+            tNext[i] = (cell[i] * cellSize - r.origin[i]) / r.dir[i];
+            tDelta[i] = -cellSize / r.dir[i];
+        }
+        else {
+            // never crosses a border on this axis
+            step[i] = 0;
+            tNext[i] = tDelta[i] = std::numeric_limits<float>::max();
+        }
+    }
+
+    // cells around the first cell
+    glm::ivec3 offset;
+    for (offset.x = -reach.x; offset.x <= reach.x; offset.x++) {
+        for (offset.y = -reach.y; offset.y <= reach.y; offset.y++) {
+            for (offset.z = -reach.z; offset.z <= reach.z; offset.z++) {
+                checkCollisionsCell(packCell(cell + offset), r, rayIdx, mode, tmin, hits);
+            }
+        }
+    }
+
+    while (true) {
+        // step into the next cell through the nearest border
+        int axis = tNext.x < tNext.y
+            ? (tNext.x < tNext.z ? 0 : 2)
+            : (tNext.y < tNext.z ? 1 : 2);
+        if (tNext[axis] > tExit || tNext[axis] >= tmin) {
+            // left the occupied cells, or every nearer hit is in a cell already checked
+            break;
+        }
+        cell[axis] += step[axis];
+        tNext[axis] += tDelta[axis];
+
+        // only the layer of cells that just came within reach
+        int axis1 = (axis + 1) % 3;
+        int axis2 = (axis + 2) % 3;
+        offset[axis] = step[axis] * reach[axis];
+        for (offset[axis1] = -reach[axis1]; offset[axis1] <= reach[axis1]; offset[axis1]++) {
+            for (offset[axis2] = -reach[axis2]; offset[axis2] <= reach[axis2]; offset[axis2]++) {
+                checkCollisionsCell(packCell(cell + offset), r, rayIdx, mode, tmin, hits);
+            }
+        }
+    }
+}
+
+// check collisions of a ray with the objects in a cell
+void HashGrid::checkCollisionsCell(unsigned long long key, Ray& r, unsigned int rayIdx, RayQuery mode, float& tmin, std::vector<RayHit>& hits) {
+    auto it = cells.find(key);
+    if (it == cells.end()) {
+        return;
+    }
+
+    float tmin_tmp = std::numeric_limits<float>::max();
+    float tmax_tmp = std::numeric_limits<float>::lowest();
+
+    for (unsigned int idx : it->second) {
+        BoundingRegion& br = objects[idx];
+
+        // coarse check
+        if (!r.intersectsBoundingRegion(br, tmin_tmp, tmax_tmp) || tmax_tmp < 0.0f) {
+            continue;
+        }
+        float t = std::fmaxf(tmin_tmp, 0.0f);
+        if (t >= tmin) {
+            // found nearer collision (or ray is done)
+            continue;
+        }
+
+        int face = -1;
+        if (br.collisionMesh) {
+            // fine grain check with collision mesh (only accepts hits closer than tmin)
+            t = tmin;
+            if (!r.intersectsMesh(br.collisionMesh, br.instance, t, face)) {
+                continue;
+            }
+        }
+
+        RayHit hit = { rayIdx, br.instance, &br, t, face };
+        if (mode == RayQuery::ALL) {
+            hits.push_back(hit);
+            continue;
+        }
+
+        // only keep the nearest hit, ANY stops the ray at its first hit
+        hits.clear();
+        hits.push_back(hit);
+        tmin = mode == RayQuery::ANY ? std::numeric_limits<float>::lowest() : t;
+    }
+}
@@ -0,0 +1,183 @@
+/*****************************************************************
+ *   Author: Tyanna Prince
+ *   Date: 07/15/2023
+ *   Description: An enhancement of my cs330 OpenGL project where I added functionality such as charater movement,
+ *  directional lighting, and shadow mapping, a cubemap, and joystick support.
+ *  copyright (c) 2023 Tyanna Prince
+ *  version 2.0
+ *****************************************************************/
+
+#ifndef HASHGRID_H
+#define HASHGRID_H
+
+// default edge length of a cell (should be at least the size of the objects stored)
+#define HASH_GRID_CELL_SIZE 1.0f
+// bits per axis in a packed cell key (cells further than 2^20 apart can share a key)
+#define HASH_GRID_KEY_BITS 21
+
+#include <vector>
+#include <unordered_map>
+#include <limits>
+
+#include "spatialindex.h"
+
+/*
+    uniform spatial hash grid
+
+    - space is divided into cubes of cellSize, only occupied cells are stored
+      (hashed on their packed coordinates)
+    - each object is kept in the cell holding its center, so a moved object
+      changes cells in constant time
+    - pairs are found by searching the cells around an object, widened by the
+      largest object in the grid (27 cells when objects are no larger than a cell)
+    - meant for many small objects of similar size (particles, projectiles), where
+      an octree spends most of its time moving objects between nodes
+*/
+
+class HashGrid : public SpatialIndex {
+public:
+    // edge length of each cell
+    float cellSize;
+
+    // occupied cells with the indices of the objects centered in them
+    std::unordered_map<unsigned long long, std::vector<unsigned int>> cells;
+
+    // list of objects
+    std::vector<BoundingRegion> objects;
+    // key of the cell holding each object (parallel to objects)
+    std::vector<unsigned long long> objectCells;
+    // position of each object in the list of its cell (parallel to objects)
+    std::vector<unsigned int> cellSlots;
+
+    // queue of objects to be inserted
+    std::vector<BoundingRegion> queue;
+
+    // largest half dimensions of any object inserted since the grid was emptied
+    glm::vec3 maxHalfDimensions;
+
+    // range of cells occupied since the grid was emptied (where rays are marched)
+    glm::ivec3 minCell;
+    glm::ivec3 maxCell;
+
+    // number of times a moved object changed cells
+    unsigned int noCellChanges = 0;
+
+    /*
+        constructor
+    */
+
+    // initialize with edge length of the cells
+    HashGrid(float cellSize = HASH_GRID_CELL_SIZE);
+
+    /*
+        functionality
+    */
+
+    // add instance to pending queue
+    void addToPending(RigidBody* instance, Model* model);
+
+    // insert objects waiting in the pending queue
+    void processPending();
+
+    // update objects in grid (called during each iteration of main loop)
+    void update(Box& box);
+
+    // check collisions with a ray (only hits nearer than tmin)
+    BoundingRegion* checkCollisionsRay(Ray r, float& tmin);
+
+    // check collisions of a packet of rays (appends the hits of each ray sorted by distance)
+    void checkCollisionsRays(std::vector<Ray>& rays, std::vector<RayHit>& hits,
+        RayQuery mode = RayQuery::CLOSEST, float maxDistance = std::numeric_limits<float>::max());
+
+    // check collisions between the object and every object in the grid it overlaps
+    void checkCollisionsRegion(const BoundingRegion& obj);
+
+    // find objects with a region intersecting the region
+    void queryRegion(const BoundingRegion& br, std::vector<BoundingRegion*>& found);
+
+    // find instances with a region inside the frustum (skips cells outside, stops testing inside)
+    void checkCollisionsFrustum(Frustum& frustum, std::vector<RigidBody*>& instances);
+
+    // copy all objects in the grid into a list (pending objects are left out)
+    void collectObjects(std::vector<BoundingRegion>& objectList);
+
+    // add the grid to the tree statistics (each occupied cell counts as a leaf)
+    void calculateStats(Stats::treeStats& stats);
+
+    // destroy object (free memory)
+    void destroy();
+
+    /*
+        cell methods
+    */
+
+    // get coordinates of the cell containing the point
+    glm::ivec3 calculateCell(glm::vec3 point);
+
+    // pack cell coordinates into a key
+    unsigned long long packCell(glm::ivec3 cell);
+
+    // unpack key into cell coordinates
+    glm::ivec3 unpackCell(unsigned long long key);
+
+    // calculate bounds of a cell widened to hold every object centered in it
+    BoundingRegion calculateBounds(unsigned long long key);
+
+private:
+    // visit the object list of every cell that can hold an object overlapping the region
+    template <typename Visitor>
+    void visitNeighbours(const BoundingRegion& br, Visitor&& visit) {
+        if (objects.size() == 0) {
+            return;
+        }
+
+        // an overlapping object has its center at most its half dimensions outside the region
+        glm::vec3 halfDimensions = br.calculateDimensions() / 2.0f;
+        glm::vec3 center = br.calculateCenter();
+        glm::ivec3 first = calculateCell(center - halfDimensions - maxHalfDimensions);
+        glm::ivec3 last = calculateCell(center + halfDimensions + maxHalfDimensions);
+        glm::ivec3 range = last - first + glm::ivec3(1);
+
+        if ((unsigned long long)range.x * range.y * range.z > cells.size()) {
+            // fewer occupied cells than cells in the range (large region), so go through the occupied ones
+            for (std::pair<const unsigned long long, std::vector<unsigned int>>& cell : cells) {
+                glm::ivec3 coords = unpackCell(cell.first);
+                if (glm::all(glm::greaterThanEqual(coords, first)) && glm::all(glm::lessThanEqual(coords, last))) {
+                    visit(cell.second);
+                }
+            }
+            return;
+        }
+
+        for (int x = first.x; x <= last.x; x++) {
+            for (int y = first.y; y <= last.y; y++) {
+                for (int z = first.z; z <= last.z; z++) {
+                    auto it = cells.find(packCell(glm::ivec3(x, y, z)));
+                    if (it != cells.end()) {
+                        visit(it->second);
+                    }
+                }
+            }
+        }
+    }
+
+    // add object to the grid
+    void insert(const BoundingRegion& br);
+
+    // remove object at idx (swap-and-pop, so the last object moves to idx)
+    void removeObject(unsigned int idx);
+
+    // take the object at idx out of the list of its cell
+    void leaveCell(unsigned int idx);
+
+    // put the object at idx into the list of the cell with the key
+    void enterCell(unsigned int idx, unsigned long long key);
+
+    // march a ray through the cells (3D DDA), checking the objects centered near each cell (hits recorded as in mode)
+    void checkCollisionsCells(Ray& r, unsigned int rayIdx, RayQuery mode, float& tmin, std::vector<RayHit>& hits);
+
+    // check collisions of a ray with the objects in a cell
+    void checkCollisionsCell(unsigned long long key, Ray& r, unsigned int rayIdx, RayQuery mode, float& tmin, std::vector<RayHit>& hits);
+};
+
+#endif
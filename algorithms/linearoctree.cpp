@@ -0,0 +1,677 @@
+/*****************************************************************
+ *   Author: Tyanna Prince
+ *   Date: 07/15/2023
+ *   Description: An enhancement of my cs330 OpenGL project where I added functionality such as charater movement,
+ *  directional lighting, and shadow mapping, a cubemap, and joystick support.
+ *  copyright (c) 2023 Tyanna Prince
+ *  version 2.0
+ *****************************************************************/
+
+#include "linearoctree.h"
+#include "../graphics/models/box.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <numeric>
+#include <limits>
+
+/*
+    utility methods
+*/
+
+// spread the lower 10 bits of v so there are 2 zero bits between each
+static unsigned int spreadBits(unsigned int v) {
+    v &= 0x000003ff;                    // ---- ---- ---- ---- ---- --98 7654 3210
+    v = (v | (v << 16)) & 0x030000ff;   // ---- --98 ---- ---- ---- ---- 7654 3210
+    v = (v | (v << 8)) & 0x0300f00f;    // ---- --98 ---- ---- 7654 ---- ---- 3210
+    v = (v | (v << 4)) & 0x030c30c3;    // ---- --98 ---- 76-- --54 ---- 32-- --10
+    v = (v | (v << 2)) & 0x09249249;    // ---- 9--8 --7- -6-- 5--4 --3- -2-- 1--0
+    return v;
+}
+
+// interleave the lower 10 bits of x, y and z into a Morton code
+unsigned int Octree::mortonEncode(unsigned int x, unsigned int y, unsigned int z) {
+    return spreadBits(x) | (spreadBits(y) << 1) | (spreadBits(z) << 2);
+}
+
+// get depth of a locational code (root = 0)
+unsigned char Octree::codeDepth(unsigned int code) {
+    unsigned char depth = 0;
+    while (code > LINEAR_ROOT_CODE) {
+        code >>= 3;
+        depth++;
+    }
+    return depth;
+}
+
+/*
+    constructor
+*/
+
+// initialize with bounds of the root
+Octree::linearTree::linearTree(BoundingRegion bounds)
+    : region(bounds), maxDepth(0) {
+    // subdivide while the cells are not too small (same rule as node::build)
+    glm::vec3 dimensions = region.calculateDimensions();
+    float minDim = std::min(dimensions.x, std::min(dimensions.y, dimensions.z));
+    while (minDim >= MIN_BOUNDS && maxDepth < LINEAR_MAX_DEPTH) {
+        minDim /= 2.0f;
+        maxDepth++;
+    }
+}
+
+/*
+    functionality
+*/
+
+// add instance to pending queue
+void Octree::linearTree::addToPending(RigidBody* instance, Model* model) {
+    // get all bounding regions of model and put them in queue
+    for (BoundingRegion br : model->boundingRegions) {
+        br.instance = instance;
+        br.transform();
+        queue.push_back(br);
+    }
+}
+
+// build tree by sorting all objects on their codes (called during initialization)
+void Octree::linearTree::build() {
+    // calculate the code of each object
+    objectCodes.resize(objects.size());
+    for (unsigned int i = 0, len = objects.size(); i < len; i++) {
+        objectCodes[i] = calculateCode(objects[i]);
+    }
+
+    sortObjects();
+
+    treeBuilt = true;
+}
+
+// update objects in tree (called during each iteration of main loop)
+void Octree::linearTree::update(Box& box) {
+    if (treeBuilt) {
+        if (nodesDirty) {
+            buildNodes();
+        }
+
+        for (linearNode& n : nodes) {
+            BoundingRegion bounds = calculateBounds(n.code);
+            box.positions.push_back(bounds.calculateCenter());
+            box.sizes.push_back(bounds.calculateDimensions());
+        }
+
+        // remove objects that don't exist anymore and refresh moved objects
+        std::vector<BoundingRegion> movedObjects;
+        std::vector<unsigned int> movedCodes;
+        bool codesChanged = false;
+        unsigned int noAlive = 0;
+        for (unsigned int i = 0, len = objects.size(); i < len; i++) {
+            if (States::isActive(&objects[i].instance->state, INSTANCE_DEAD)) {
+                // remove if kill switch active
+                codesChanged = true;
+                continue;
+            }
+
+            if (States::isActive(&objects[i].instance->state, INSTANCE_MOVED)) {
+                // if moved switch active, transform region and find its new node
+                objects[i].transform();
+                batchesDirty = true;
+
+                if (!region.containsRegion(objects[i])) {
+                    // left the root, wait in the queue
+                    queue.push_back(objects[i]);
+                    codesChanged = true;
+                    continue;
+                }
+
+                unsigned int code = calculateCode(objects[i]);
+                if (code != objectCodes[i]) {
+                    objectCodes[i] = code;
+                    codesChanged = true;
+                }
+                movedObjects.push_back(objects[i]);
+                movedCodes.push_back(code);
+            }
+
+            box.positions.push_back(objects[i].calculateCenter());
+            box.sizes.push_back(objects[i].calculateDimensions());
+
+            // compact list
+            if (noAlive != i) {
+                objects[noAlive] = objects[i];
+                objectCodes[noAlive] = objectCodes[i];
+            }
+            noAlive++;
+        }
+        objects.resize(noAlive);
+        objectCodes.resize(noAlive);
+
+        if (codesChanged) {
+            // move objects into their new nodes
+            sortObjects();
+        }
+
+        // collision detection (unless pairs are found by a separate broadphase stage)
+        for (unsigned int i = 0, len = detectCollisions ? movedObjects.size() : 0; i < len; i++) {
+            int nodeIdx = findNode(movedCodes[i]);
+
+            // itself and children
+            checkCollisionsSelf(nodeIdx, movedObjects[i]);
+            checkCollisionsChildren(nodeIdx, movedObjects[i]);
+
+            // parents
+            for (unsigned int code = movedCodes[i] >> 3; code >= LINEAR_ROOT_CODE; code >>= 3) {
+                checkCollisionsSelf(findNode(code), movedObjects[i]);
+            }
+
+            if (linkedIndex) {
+                // objects kept in the other index
+                linkedIndex->checkCollisionsRegion(movedObjects[i]);
+            }
+        }
+    }
+
+    processPending();
+}
+
+// process pending queue
+void Octree::linearTree::processPending() {
+    if (!treeBuilt) {
+        // add objects to be sorted when built
+        objects.insert(objects.end(), queue.begin(), queue.end());
+        queue.clear();
+        build();
+    }
+    else {
+        // objects that cannot be inserted yet are moved to the front of the queue
+        unsigned int noWaiting = 0;
+        for (unsigned int i = 0, len = queue.size(); i < len; i++) {
+            BoundingRegion& br = queue[i];
+
+            if (States::isActive(&br.instance->state, INSTANCE_DEAD)) {
+                // deleted while waiting
+                continue;
+            }
+
+            if (region.containsRegion(br) || grow(br)) {
+                // insert object immediately
+                insert(br);
+            }
+            else {
+                // return to queue
+                br.transform();
+                queue[noWaiting++] = br;
+            }
+        }
+        queue.resize(noWaiting);
+    }
+}
+
+// double the bounds of the root until the region fits (false if it would pass OCTREE_MAX_ROOT_SIZE)
+bool Octree::linearTree::grow(const BoundingRegion& br) {
+    glm::vec3 target = br.calculateCenter();
+    bool grown = false;
+
+    while (!region.containsRegion(br)) {
+        BoundingRegion bounds = growBounds(region, target);
+        glm::vec3 dimensions = bounds.calculateDimensions();
+        if (dimensions.x > OCTREE_MAX_ROOT_SIZE ||
+            dimensions.y > OCTREE_MAX_ROOT_SIZE ||
+            dimensions.z > OCTREE_MAX_ROOT_SIZE) {
+            // too far away, leave it in the queue
+            break;
+        }
+
+        // old root becomes an octant, so cells on the deepest level keep their size until the code is full
+        region = bounds;
+        if (maxDepth < LINEAR_MAX_DEPTH) {
+            maxDepth++;
+        }
+        noGrowths++;
+        grown = true;
+    }
+
+    if (grown) {
+        // every code changes with the root
+        build();
+    }
+
+    return region.containsRegion(br);
+}
+
+// dynamically insert object into tree
+bool Octree::linearTree::insert(BoundingRegion obj) {
+    unsigned int code = calculateCode(obj);
+
+    // insert after all objects with smaller or equal codes to keep list sorted
+    unsigned int idx = std::upper_bound(objectCodes.begin(), objectCodes.end(), code) - objectCodes.begin();
+    objects.insert(objects.begin() + idx, obj);
+    objectCodes.insert(objectCodes.begin() + idx, code);
+
+    // node offsets are now stale
+    nodesDirty = true;
+    batchesDirty = true;
+
+    return true;
+}
+
+// calculate code of the deepest node that completely contains the region
+unsigned int Octree::linearTree::calculateCode(BoundingRegion& br) {
+    // get AABB of region
+    glm::vec3 min, max;
+    if (br.type == BoundTypes::AABB) {
+        min = br.min;
+        max = br.max;
+    }
+    else {
+        min = br.center - glm::vec3(br.radius);
+        max = br.center + glm::vec3(br.radius);
+    }
+
+    // cell coordinates of both corners on the deepest level
+    int res = 1 << maxDepth;
+    glm::vec3 cellSize = region.calculateDimensions() / (float)res;
+    unsigned int q0[3], q1[3];
+    for (int i = 0; i < 3; i++) {
+        q0[i] = (unsigned int)glm::clamp((int)floorf((min[i] - region.min[i]) / cellSize[i]), 0, res - 1);
+        q1[i] = (unsigned int)glm::clamp((int)floorf((max[i] - region.min[i]) / cellSize[i]), 0, res - 1);
+    }
+
+    // move up until both corners are in the same cell
+    unsigned char depth = maxDepth;
+    while (depth > 0 &&
+        (q0[0] != q1[0] || q0[1] != q1[1] || q0[2] != q1[2])) {
+        for (int i = 0; i < 3; i++) {
+            q0[i] >>= 1;
+            q1[i] >>= 1;
+        }
+        depth--;
+    }
+
+    return (LINEAR_ROOT_CODE << (3 * depth)) | mortonEncode(q0[0], q0[1], q0[2]);
+}
+
+// calculate bounds of the node with the code
+BoundingRegion Octree::linearTree::calculateBounds(unsigned int code) {
+    glm::vec3 min = region.min;
+    glm::vec3 size = region.calculateDimensions();
+
+    // walk down from the root taking 3 bits (x, y, z) per level
+    for (int level = (int)codeDepth(code) - 1; level >= 0; level--) {
+        unsigned int octant = (code >> (3 * level)) & 0b111;
+        size /= 2.0f;
+        for (int i = 0; i < 3; i++) {
+            if (octant & (1 << i)) {
+                min[i] += size[i];
+            }
+        }
+    }
+
+    return BoundingRegion(min, min + size);
+}
+
+// get index of node with code (-1 if not found)
+int Octree::linearTree::findNode(unsigned int code) {
+    if (nodesDirty) {
+        buildNodes();
+    }
+
+    auto it = std::lower_bound(nodes.begin(), nodes.end(), code,
+        [](const linearNode& n, unsigned int c) -> bool {
+            return n.code < c;
+        });
+
+    return (it != nodes.end() && it->code == code) ? (int)(it - nodes.begin()) : -1;
+}
+
+// check collisions with all objects in node
+void Octree::linearTree::checkCollisionsSelf(int nodeIdx, const BoundingRegion& obj) {
+    if (nodeIdx < 0) {
+        return;
+    }
+
+    unsigned int firstBatch = getNodeBatches(nodeIdx);
+    unsigned int firstObject = nodes[nodeIdx].firstObject;
+    unsigned int noBatches = (nodes[nodeIdx].noObjects + SIMD_BATCH - 1) / SIMD_BATCH;
+
+    for (unsigned int b = 0; b < noBatches; b++) {
+        // coarse check against a batch of objects at once
+        unsigned int hits = SIMD::intersectsRegions(obj, objectBatches[firstBatch + b]);
+
+        for (unsigned int j = 0; hits; hits >>= 1, j++) {
+            if (!(hits & 1)) {
+                continue;
+            }
+
+            BoundingRegion& br = objects[firstObject + b * SIMD_BATCH + j];
+            if (br.instance->instanceId == obj.instance->instanceId) {
+                // do not test collisions with the same instance
+                continue;
+            }
+
+            checkCollisionsFine(br, obj);
+        }
+    }
+}
+
+// check collisions with all objects in child nodes
+void Octree::linearTree::checkCollisionsChildren(int nodeIdx, const BoundingRegion& obj) {
+    if (nodeIdx < 0) {
+        return;
+    }
+
+    unsigned int code = nodes[nodeIdx].code;
+    for (unsigned char flags = nodes[nodeIdx].activeOctants, i = 0;
+        flags > 0;
+        flags >>= 1, i++) {
+        if (States::isIndexActive(&flags, 0)) {
+            int childIdx = findNode((code << 3) | i);
+            checkCollisionsSelf(childIdx, obj);
+            checkCollisionsChildren(childIdx, obj);
+        }
+    }
+}
+
+// check collisions between the object and every object in the tree it overlaps
+void Octree::linearTree::checkCollisionsRegion(const BoundingRegion& obj) {
+    // deepest node that would hold the object (root if it does not fit)
+    BoundingRegion br = obj;
+    unsigned int code = (treeBuilt && region.containsRegion(br)) ? calculateCode(br) : LINEAR_ROOT_CODE;
+
+    // itself and children (missing if the branch is empty)
+    int nodeIdx = findNode(code);
+    checkCollisionsSelf(nodeIdx, obj);
+    checkCollisionsChildren(nodeIdx, obj);
+
+    // parents
+    for (code >>= 3; code >= LINEAR_ROOT_CODE; code >>= 3) {
+        checkCollisionsSelf(findNode(code), obj);
+    }
+}
+
+// find objects with a region intersecting the region
+void Octree::linearTree::queryRegion(const BoundingRegion& br, std::vector<BoundingRegion*>& found) {
+    // objects in the node at idx intersecting the region
+    auto queryNode = [this, &br, &found](int nodeIdx) -> void {
+        for (unsigned int i = nodes[nodeIdx].firstObject, end = i + nodes[nodeIdx].noObjects; i < end; i++) {
+            if (objects[i].intersectsWith(br)) {
+                found.push_back(&objects[i]);
+            }
+        }
+    };
+
+    // deepest node that would hold the region (root if it does not fit)
+    BoundingRegion query = br;
+    unsigned int code = (treeBuilt && region.containsRegion(query)) ? calculateCode(query) : LINEAR_ROOT_CODE;
+
+    // itself and children (missing if the branch is empty)
+    std::vector<int> stack;
+    int nodeIdx = findNode(code);
+    if (nodeIdx >= 0) {
+        stack.push_back(nodeIdx);
+    }
+    while (stack.size() != 0) {
+        nodeIdx = stack.back();
+        stack.pop_back();
+        queryNode(nodeIdx);
+
+        for (unsigned char flags = nodes[nodeIdx].activeOctants, i = 0;
+            flags > 0;
+            flags >>= 1, i++) {
+            if (States::isIndexActive(&flags, 0)) {
+                stack.push_back(findNode((nodes[nodeIdx].code << 3) | i));
+            }
+        }
+    }
+
+    // parents
+    for (code >>= 3; code >= LINEAR_ROOT_CODE; code >>= 3) {
+        nodeIdx = findNode(code);
+        if (nodeIdx >= 0) {
+            queryNode(nodeIdx);
+        }
+    }
+}
+
+// check collisions with a ray
+BoundingRegion* Octree::linearTree::checkCollisionsRay(Ray r, float& tmin) {
+    if (nodesDirty) {
+        buildNodes();
+    }
+
+    if (nodes.empty()) {
+        return nullptr;
+    }
+
+    // root is always the first node
+    return checkCollisionsRay(0, region, r, tmin);
+}
+
+// find instances with a region inside the frustum (skips nodes outside, stops testing inside)
+void Octree::linearTree::checkCollisionsFrustum(Frustum& frustum, std::vector<RigidBody*>& instances) {
+    if (nodesDirty) {
+        buildNodes();
+    }
+
+    // result for each node (parents come before their children)
+    std::vector<FrustumTest> results(nodes.size());
+    for (unsigned int i = 0, len = nodes.size(); i < len; i++) {
+        FrustumTest parentResult = (i == 0)
+            ? FrustumTest::INTERSECTS
+            : results[findNode(nodes[i].code >> 3)];
+
+        results[i] = (parentResult == FrustumTest::INTERSECTS)
+            ? frustum.testRegion(calculateBounds(nodes[i].code))
+            : parentResult;
+
+        if (results[i] == FrustumTest::OUTSIDE) {
+            continue;
+        }
+
+        for (unsigned int j = nodes[i].firstObject, end = j + nodes[i].noObjects; j < end; j++) {
+            if (results[i] == FrustumTest::INSIDE || frustum.testRegion(objects[j]) != FrustumTest::OUTSIDE) {
+                instances.push_back(objects[j].instance);
+            }
+        }
+    }
+
+    // objects waiting to be inserted (may be outside of the root)
+    for (const BoundingRegion& br : queue) {
+        if (frustum.testRegion(br) != FrustumTest::OUTSIDE) {
+            instances.push_back(br.instance);
+        }
+    }
+}
+
+// copy all objects in the tree into a list (pending objects are left out)
+void Octree::linearTree::collectObjects(std::vector<BoundingRegion>& objectList) {
+    objectList.insert(objectList.end(), objects.begin(), objects.end());
+}
+
+// add the tree to the tree statistics
+void Octree::linearTree::calculateStats(Stats::treeStats& stats) {
+    if (nodesDirty) {
+        buildNodes();
+    }
+
+    for (linearNode& n : nodes) {
+        stats.addNode(codeDepth(n.code), n.activeOctants == 0, n.noObjects, 0);
+    }
+    stats.noPending += queue.size();
+}
+
+// destroy object (free memory)
+void Octree::linearTree::destroy() {
+    nodes.clear();
+    objects.clear();
+    objectCodes.clear();
+    objectBatches.clear();
+    nodeBatches.clear();
+    batchesDirty = true;
+    queue.clear();
+}
+
+/*
+    private methods
+*/
+
+// sort objects on their codes and regenerate the node list
+void Octree::linearTree::sortObjects() {
+    // sort permutation so objects and codes stay parallel
+    std::vector<unsigned int> order(objects.size());
+    std::iota(order.begin(), order.end(), 0);
+    std::stable_sort(order.begin(), order.end(), [this](unsigned int a, unsigned int b) -> bool {
+        return objectCodes[a] < objectCodes[b];
+    });
+
+    std::vector<BoundingRegion> sortedObjects;
+    std::vector<unsigned int> sortedCodes;
+    sortedObjects.reserve(objects.size());
+    sortedCodes.reserve(objects.size());
+    for (unsigned int idx : order) {
+        sortedObjects.push_back(objects[idx]);
+        sortedCodes.push_back(objectCodes[idx]);
+    }
+    objects.swap(sortedObjects);
+    objectCodes.swap(sortedCodes);
+
+    buildNodes();
+}
+
+// regenerate node list from sorted object codes
+void Octree::linearTree::buildNodes() {
+    nodesDirty = false;
+    batchesDirty = true;
+
+    // every code in use plus all of its ancestors (root always exists)
+    std::vector<unsigned int> codes;
+    codes.push_back(LINEAR_ROOT_CODE);
+    for (unsigned int i = 0, len = objectCodes.size(); i < len; i++) {
+        if (i > 0 && objectCodes[i] == objectCodes[i - 1]) {
+            continue;
+        }
+        for (unsigned int code = objectCodes[i]; code > LINEAR_ROOT_CODE; code >>= 3) {
+            codes.push_back(code);
+        }
+    }
+    std::sort(codes.begin(), codes.end());
+    codes.erase(std::unique(codes.begin(), codes.end()), codes.end());
+
+    // generate nodes with their object ranges
+    nodes.resize(codes.size());
+    unsigned int objIdx = 0;
+    for (unsigned int i = 0, len = codes.size(); i < len; i++) {
+        nodes[i].code = codes[i];
+        nodes[i].activeOctants = 0;
+
+        // codes are sorted, so the objects of this node start here
+        nodes[i].firstObject = objIdx;
+        while (objIdx < objectCodes.size() && objectCodes[objIdx] == codes[i]) {
+            objIdx++;
+        }
+        nodes[i].noObjects = objIdx - nodes[i].firstObject;
+    }
+
+    // activate octants of each parent
+    for (unsigned int i = 1, len = nodes.size(); i < len; i++) {
+        int parentIdx = findNode(nodes[i].code >> 3);
+        States::activateIndex(&nodes[parentIdx].activeOctants, nodes[i].code & 0b111);
+    }
+}
+
+// get index of the first batch of the node at idx (loads the node if needed)
+int Octree::linearTree::getNodeBatches(int nodeIdx) {
+    if (batchesDirty || nodeBatches.size() != nodes.size()) {
+        // objects changed, so every node has to be reloaded
+        objectBatches.clear();
+        nodeBatches.assign(nodes.size(), -1);
+        batchesDirty = false;
+    }
+
+    if (nodeBatches[nodeIdx] < 0) {
+        nodeBatches[nodeIdx] = objectBatches.size();
+        SIMD::loadBatches(objects.data() + nodes[nodeIdx].firstObject, nodes[nodeIdx].noObjects, objectBatches);
+    }
+    return nodeBatches[nodeIdx];
+}
+
+// check collisions with a ray in the node at idx
+BoundingRegion* Octree::linearTree::checkCollisionsRay(int nodeIdx, BoundingRegion bounds, Ray r, float& tmin) {
+    float tmin_tmp = std::numeric_limits<float>::max();
+    float tmax_tmp = std::numeric_limits<float>::lowest();
+    float t_tmp = std::numeric_limits<float>::max();
+
+    // check current region
+    if (!r.intersectsBoundingRegion(bounds, tmin_tmp, tmax_tmp) || tmin_tmp >= tmin) {
+        // missed or found nearer collision
+        return nullptr;
+    }
+
+    BoundingRegion* ret = nullptr, * ret_tmp = nullptr;
+
+    // check objects in the node, a batch at a time
+    unsigned int firstBatch = getNodeBatches(nodeIdx);
+    unsigned int noBatches = (nodes[nodeIdx].noObjects + SIMD_BATCH - 1) / SIMD_BATCH;
+    float tminBatch[SIMD_BATCH];
+    float tmaxBatch[SIMD_BATCH];
+    for (unsigned int b = 0, i = nodes[nodeIdx].firstObject; b < noBatches; b++, i += SIMD_BATCH) {
+        // coarse check - check against every BR in the batch
+        unsigned int hits = SIMD::rayIntersectsRegions(r, objectBatches[firstBatch + b], tminBatch, tmaxBatch);
+
+        for (unsigned int j = 0; hits; hits >>= 1, j++) {
+            if (!(hits & 1) || tmaxBatch[j] < 0.0f) {
+                // missed or entirely behind the origin
+                continue;
+            }
+
+            BoundingRegion& br = objects[i + j];
+            tmin_tmp = std::fmaxf(tminBatch[j], 0.0f);
+
+            if (tmin_tmp > tmin) {
+                continue;
+            }
+            else if (br.collisionMesh) {
+                // fine grain check with collision mesh
+                t_tmp = std::numeric_limits<float>::max();
+                if (r.intersectsMesh(br.collisionMesh, br.instance, t_tmp)) {
+                    if (t_tmp < tmin) {
+                        // found closer collision
+                        tmin = t_tmp;
+                        ret = &br;
+                    }
+                }
+            }
+            else {
+                // rely on coarse check
+                if (tmin_tmp < tmin) {
+                    tmin = tmin_tmp;
+                    ret = &br;
+                }
+            }
+        }
+    }
+
+    // check children
+    unsigned int code = nodes[nodeIdx].code;
+    glm::vec3 half = bounds.calculateDimensions() / 2.0f;
+    for (unsigned char flags = nodes[nodeIdx].activeOctants, i = 0;
+        flags > 0;
+        flags >>= 1, i++) {
+        if (States::isIndexActive(&flags, 0)) {
+            // bounds of child from octant bits
+            glm::vec3 childMin = bounds.min;
+            for (int j = 0; j < 3; j++) {
+                if (i & (1 << j)) {
+                    childMin[j] += half[j];
+                }
+            }
+
+            ret_tmp = checkCollisionsRay(findNode((code << 3) | i), BoundingRegion(childMin, childMin + half), r, tmin);
+            if (ret_tmp) {
+                ret = ret_tmp;
+            }
+        }
+    }
+
+    return ret;
+}
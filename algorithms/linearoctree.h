@@ -0,0 +1,175 @@
+/*****************************************************************
+ *   Author: Tyanna Prince
+ *   Date: 07/15/2023
+ *   Description: An enhancement of my cs330 OpenGL project where I added functionality such as charater movement,
+ *  directional lighting, and shadow mapping, a cubemap, and joystick support.
+ *  copyright (c) 2023 Tyanna Prince
+ *  version 2.0
+ *****************************************************************/
+
+#ifndef LINEAROCTREE_H
+#define LINEAROCTREE_H
+
+// 3 bits per level plus the sentinel bit must fit in 32 bits
+#define LINEAR_MAX_DEPTH 10
+#define LINEAR_ROOT_CODE 1u
+
+#include <vector>
+
+#include "octree.h"
+
+/*
+    linear (pointerless) octree
+
+    - every node is identified by a locational code: a sentinel 1 bit followed by
+      3 bits (x, y, z) per level, so the root is 1, its children are 1xxx, etc.
+    - nodes live in one flat array sorted by code (parents before children)
+    - objects live in one flat array sorted by the code of the node containing them,
+      so all objects of a node are contiguous
+*/
+
+namespace Octree {
+    /*
+        utility methods
+    */
+
+    // interleave the lower 10 bits of x, y and z into a Morton code
+    unsigned int mortonEncode(unsigned int x, unsigned int y, unsigned int z);
+
+    // get depth of a locational code (root = 0)
+    unsigned char codeDepth(unsigned int code);
+
+    /*
+        struct to represent each node in the linear octree
+    */
+    struct linearNode {
+        // locational code of node
+        unsigned int code;
+
+        // index of first object in the tree's object list
+        unsigned int firstObject;
+        // number of objects in this node
+        unsigned int noObjects;
+
+        // switch for active octants
+        unsigned char activeOctants;
+    };
+
+    /*
+        class to represent the whole linear octree
+    */
+    class linearTree : public SpatialIndex {
+    public:
+        // region of bounds of the root (AABB)
+        BoundingRegion region;
+
+        // deepest level a node can be placed at (from MIN_BOUNDS)
+        unsigned char maxDepth;
+
+        // if tree is built
+        bool treeBuilt = false;
+        // if node list must be regenerated from object codes
+        bool nodesDirty = false;
+
+        // number of times the bounds of the root were doubled to fit objects
+        unsigned int noGrowths = 0;
+
+        // list of nodes sorted by code
+        std::vector<linearNode> nodes;
+
+        // list of objects sorted by code of their node
+        std::vector<BoundingRegion> objects;
+        // code of the node containing each object (parallel to objects)
+        std::vector<unsigned int> objectCodes;
+
+        // queue of objects to be dynamically inserted
+        std::vector<BoundingRegion> queue;
+
+        // if objects were added, removed or moved since their batches were loaded
+        bool batchesDirty = true;
+        // objects transposed for the batched kernels (loaded per node on first use)
+        std::vector<SIMD::batch> objectBatches;
+        // index of the first batch of each node (parallel to nodes, -1 if not loaded)
+        std::vector<int> nodeBatches;
+
+        /*
+            constructor
+        */
+
+        // initialize with bounds of the root
+        linearTree(BoundingRegion bounds);
+
+        /*
+            functionality
+        */
+
+        // add instance to pending queue
+        void addToPending(RigidBody* instance, Model* model);
+
+        // build tree by sorting all objects on their codes (called during initialization)
+        void build();
+
+        // update objects in tree (called during each iteration of main loop)
+        void update(Box& box);
+
+        // process pending queue
+        void processPending();
+
+        // double the bounds of the root until the region fits (false if it would pass OCTREE_MAX_ROOT_SIZE)
+        bool grow(const BoundingRegion& br);
+
+        // dynamically insert object into tree
+        bool insert(BoundingRegion obj);
+
+        // calculate code of the deepest node that completely contains the region
+        unsigned int calculateCode(BoundingRegion& br);
+
+        // calculate bounds of the node with the code
+        BoundingRegion calculateBounds(unsigned int code);
+
+        // get index of node with code (-1 if not found)
+        int findNode(unsigned int code);
+
+        // check collisions with all objects in node
+        void checkCollisionsSelf(int nodeIdx, const BoundingRegion& obj);
+
+        // check collisions with all objects in child nodes
+        void checkCollisionsChildren(int nodeIdx, const BoundingRegion& obj);
+
+        // check collisions between the object and every object in the tree it overlaps
+        void checkCollisionsRegion(const BoundingRegion& obj);
+
+        // find objects with a region intersecting the region
+        void queryRegion(const BoundingRegion& br, std::vector<BoundingRegion*>& found);
+
+        // check collisions with a ray
+        BoundingRegion* checkCollisionsRay(Ray r, float& tmin);
+
+        // find instances with a region inside the frustum (skips nodes outside, stops testing inside)
+        void checkCollisionsFrustum(Frustum& frustum, std::vector<RigidBody*>& instances);
+
+        // copy all objects in the tree into a list (pending objects are left out)
+        void collectObjects(std::vector<BoundingRegion>& objectList);
+
+        // add the tree to the tree statistics
+        void calculateStats(Stats::treeStats& stats);
+
+        // destroy object (free memory)
+        void destroy();
+
+    private:
+        // sort objects on their codes and regenerate the node list
+        void sortObjects();
+
+        // regenerate node list from sorted object codes
+        void buildNodes();
+
+        // get index of the first batch of the node at idx (loads the node if needed)
+        int getNodeBatches(int nodeIdx);
+
+        // check collisions with a ray in the node at idx
+        BoundingRegion* checkCollisionsRay(int nodeIdx, BoundingRegion bounds, Ray r, float& tmin);
+    };
+}
+
+#endif
@@ -148,3 +148,98 @@ bool faceContainsPointRange(glm::vec3 A, glm::vec3 B, glm::vec3 N, glm::vec3 poi
 bool faceContainsPoint(glm::vec3 A, glm::vec3 B, glm::vec3 N, glm::vec3 point) {
     return faceContainsPointRange(A, B, N, point, 0.0f);
 }
+
+/**
+ * Finds the first time a moving sphere touches a point.
+ *
+ * @param start The center of the sphere at t = 0.
+ * @param motion The distance the center moves from t = 0 to t = 1.
+ * @param radius The radius of the sphere.
+ * @param point The point to be checked.
+ * @param t The time of impact in the range [0, 1], only written if the sphere touches the point.
+ *
+ * @return True if the sphere touches the point during the motion, false otherwise.
+ *
+ * @throws None.
+ */
+bool sweepSpherePoint(glm::vec3 start, glm::vec3 motion, float radius, glm::vec3 point, float& t) {
+    // solve |start + t * motion - point| = radius for t
+    glm::vec3 d = start - point;
+    float a = glm::dot(motion, motion);
+    float b = 2.0f * glm::dot(motion, d);
+    float c = glm::dot(d, d) - radius * radius;
+
+    if (c <= 0.0f) {
+        // already touching
+        t = 0.0f;
+        return true;
+    }
+
+    float D = b * b - 4.0f * a * c;
+    if (a == 0.0f || D < 0.0f) {
+        // not moving or passes by
+        return false;
+    }
+
+    // first root (the sphere enters)
+    float root = (-b - sqrtf(D)) / (2.0f * a);
+    if (root < 0.0f || root > 1.0f) {
+        return false;
+    }
+
+    t = root;
+    return true;
+}
+
+/**
+ * Finds the first time a moving sphere touches the inside of a line segment (the end points are not checked).
+ *
+ * @param start The center of the sphere at t = 0.
+ * @param motion The distance the center moves from t = 0 to t = 1.
+ * @param radius The radius of the sphere.
+ * @param A The first end point of the segment.
+ * @param B The second end point of the segment.
+ * @param t The time of impact in the range [0, 1], only written if the sphere touches the segment.
+ *
+ * @return True if the sphere touches the segment during the motion, false otherwise.
+ *
+ * @throws None.
+ */
+bool sweepSphereSegment(glm::vec3 start, glm::vec3 motion, float radius, glm::vec3 A, glm::vec3 B, float& t) {
+    // solve for the center reaching the cylinder of the radius around the segment
+    glm::vec3 edge = B - A;
+    glm::vec3 d = start - A;
+
+    float ee = glm::dot(edge, edge);
+    float em = glm::dot(edge, motion);
+    float ed = glm::dot(edge, d);
+
+    // components perpendicular to the segment (scaled by ee)
+    float a = ee * glm::dot(motion, motion) - em * em;
+    float b = 2.0f * (ee * glm::dot(motion, d) - em * ed);
+    float c = ee * (glm::dot(d, d) - radius * radius) - ed * ed;
+
+    float root = 0.0f;
+    if (c > 0.0f) {
+        // outside the cylinder at the start
+        float D = b * b - 4.0f * a * c;
+        if (a == 0.0f || D < 0.0f) {
+            // moving along the segment or passes by
+            return false;
+        }
+
+        root = (-b - sqrtf(D)) / (2.0f * a);
+        if (root < 0.0f || root > 1.0f) {
+            return false;
+        }
+    }
+
+    // the point touched must be between the end points
+    float s = (ed + root * em) / ee;
+    if (s < 0.0f || s > 1.0f) {
+        return false;
+    }
+
+    t = root;
+    return true;
+}
@@ -74,6 +74,10 @@ bool faceContainsPointRange(glm::vec3 A, glm::vec3 B, glm::vec3 N, glm::vec3 poi
 
 bool faceContainsPoint(glm::vec3 A, glm::vec3 B, glm::vec3 N, glm::vec3 point);
 
+bool sweepSpherePoint(glm::vec3 start, glm::vec3 motion, float radius, glm::vec3 point, float& t);
+
+bool sweepSphereSegment(glm::vec3 start, glm::vec3 motion, float radius, glm::vec3 A, glm::vec3 B, float& t);
+
 /**
  * Performs row reduction on a matrix using Gaussian elimination.
  *
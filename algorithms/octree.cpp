@@ -9,6 +9,7 @@
 
 #include "octree.h"
 #include "avl.h"
+#include "events.h"
 #include "../graphics/models/box.hpp"
 
 // calculate bounds of specified quadrant in bounding region
@@ -42,21 +43,123 @@ void Octree::calculateBounds(BoundingRegion &out, Octant octant, BoundingRegion
     }
 }
 
+// enlarge region about its center by the looseness factor
+BoundingRegion Octree::looseBounds(BoundingRegion region, float looseness) {
+    if (looseness <= 1.0f) {
+        // tight octree
+        return region;
+    }
+
+    glm::vec3 center = region.calculateCenter();
+    glm::vec3 halfDimensions = region.calculateDimensions() * (0.5f * looseness);
+    return BoundingRegion(center - halfDimensions, center + halfDimensions);
+}
+
+// double region along each axis towards the point (region becomes one octant of the result)
+BoundingRegion Octree::growBounds(const BoundingRegion& region, glm::vec3 towards) {
+    glm::vec3 dimensions = region.calculateDimensions();
+    glm::vec3 center = region.calculateCenter();
+
+    BoundingRegion ret(region.min, region.max);
+    for (int i = 0; i < 3; i++) {
+        if (towards[i] < center[i]) {
+            ret.min[i] -= dimensions[i];
+        }
+        else {
+            ret.max[i] += dimensions[i];
+        }
+    }
+
+    return ret;
+}
+
+/*
+    node pool
+*/
+
+// pool that owns every node
+Octree::nodePool Octree::node::pool;
+
+// destructor
+Octree::nodePool::~nodePool() {
+    cleanup();
+}
+
+// get memory for one node
+void* Octree::nodePool::allocate() {
+    std::lock_guard<std::mutex> lock(mtx);
+
+    if (freeList.size() == 0) {
+        // out of memory, add new slab
+        char* slab = (char*)::operator new(sizeof(node) * NODE_POOL_SLAB_SIZE);
+        slabs.push_back(slab);
+        for (int i = NODE_POOL_SLAB_SIZE - 1; i >= 0; i--) {
+            freeList.push_back(slab + i * sizeof(node));
+        }
+    }
+
+    void* ret = freeList.back();
+    freeList.pop_back();
+
+    noLive++;
+    if (noLive > noPeak) {
+        noPeak = noLive;
+    }
+
+    return ret;
+}
+
+// destroy a node and return its memory to the pool
+void Octree::nodePool::release(node* n) {
+    n->~node();
+
+    std::lock_guard<std::mutex> lock(mtx);
+    freeList.push_back(n);
+    noLive--;
+}
+
+// free all slabs (only if no nodes are in use)
+void Octree::nodePool::cleanup() {
+    std::lock_guard<std::mutex> lock(mtx);
+
+    if (noLive > 0) {
+        return;
+    }
+
+    for (void* slab : slabs) {
+        ::operator delete(slab);
+    }
+    slabs.clear();
+    freeList.clear();
+}
+
+// number of nodes currently in use
+unsigned int Octree::nodePool::getNoLive() const {
+    std::lock_guard<std::mutex> lock(mtx);
+    return noLive;
+}
+
+// highest number of nodes in use at once
+unsigned int Octree::nodePool::getNoPeak() const {
+    std::lock_guard<std::mutex> lock(mtx);
+    return noPeak;
+}
+
 /*
     constructors
 */
 
 // default
 Octree::node::node()
-    : region(BoundTypes::AABB) {}
+    : parent(nullptr), children(), activeOctants(0), region(BoundTypes::AABB) {}
 
 // initialize with bounds (no objects yet)
 Octree::node::node(BoundingRegion bounds)
-    : region(bounds) {}
+    : parent(nullptr), children(), activeOctants(0), region(bounds) {}
 
 // initialize with bounds and list of objects
 Octree::node::node(BoundingRegion bounds, std::vector<BoundingRegion> objectList)
-    : region(bounds) {
+    : parent(nullptr), children(), activeOctants(0), region(bounds) {
     // insert entire list of objects
     objects.insert(objects.end(), objectList.begin(), objectList.end());
 }
@@ -71,7 +174,7 @@ void Octree::node::addToPending(RigidBody* instance, Model *model) {
     for (BoundingRegion br : model->boundingRegions) {
         br.instance = instance;
         br.transform();
-        queue.push(br);
+        queue.push_back(br);
     }
 }
 
@@ -79,8 +182,11 @@ void Octree::node::addToPending(RigidBody* instance, Model *model) {
 void Octree::node::build() {
     // variable declarations
     BoundingRegion octants[NO_CHILDREN];
+    BoundingRegion looseOctants[NO_CHILDREN]; // bounds objects are accepted in
     glm::vec3 dimensions = region.calculateDimensions();
     std::vector<BoundingRegion> octLists[NO_CHILDREN]; // array of lists of objects in each octant
+    std::vector<std::future<void>> childBuilds; // large subtrees being built on worker threads
+    SIMD::batch octantBatch; // loose octants transposed to be tested at once
     
     /*
         termination conditions (don't subdivide further)
@@ -105,22 +211,29 @@ void Octree::node::build() {
     // create regions
     for (int i = 0; i < NO_CHILDREN; i++) {
         calculateBounds(octants[i], (Octant)(1 << i), region);
+        looseOctants[i] = looseBounds(octants[i], looseness);
     }
+    octantBatch.load(looseOctants, NO_CHILDREN);
 
     // determine which octants to place objects in
     for (int i = 0, len = objects.size(); i < len; i++) {
         BoundingRegion br = objects[i];
-        for (int j = 0; j < NO_CHILDREN; j++) {
-            if (octants[j].containsRegion(br)) {
-                // octant contains region
-                octLists[j].push_back(br);
-                objects.erase(objects.begin() + i);
 
-                // offset because removed object from list
-                i--;
-                len--;
-                break;
+        // test every octant at once, the first one containing the region gets it
+        unsigned int containing = SIMD::containedInRegions(br, octantBatch);
+        if (containing) {
+            int j = 0;
+            while (!(containing & (1 << j))) {
+                j++;
             }
+
+            // octant contains region
+            octLists[j].push_back(br);
+            removeObject(i);
+
+            // offset because removed object from list
+            i--;
+            len--;
         }
     }
 
@@ -128,26 +241,46 @@ void Octree::node::build() {
     for (int i = 0; i < NO_CHILDREN; i++) {
         if (octLists[i].size() != 0) {
             // if children go into this octant, generate new child
-            children[i] = new node(octants[i], octLists[i]);
+            children[i] = pool.create(octants[i], octLists[i]);
             States::activateIndex(&activeOctants, i); // activate octant
             children[i]->parent = this;
-            children[i]->build();
+            children[i]->looseness = looseness;
+
+            if (octLists[i].size() >= PARALLEL_BUILD_THRESHOLD) {
+                // big subtree, build on a worker (subtrees share no data)
+                childBuilds.push_back(std::async(std::launch::async, &node::build, children[i]));
+            }
+            else {
+                children[i]->build();
+            }
         }
     }
+
+    // wait for subtrees on workers
+    for (std::future<void>& childBuild : childBuilds) {
+        childBuild.get();
+    }
     
 setVars:
     // set state variables
     treeBuilt = true;
     treeReady = true;
 
-    // set pointer to current cell of each object
+    // set pointer to current cell and slot of each object
     for (int i = 0; i < objects.size(); i++) {
         objects[i].cell = this;
+        objects[i].cellIdx = i;
     }
+    batchesDirty = true;
 }
 
 // update objects in tree (called during each iteration of main loop)
 void Octree::node::update(Box &box) {
+    if (parent == nullptr) {
+        // root starts a new frame
+        noReinsertions = 0;
+    }
+
     if (treeBuilt && treeReady) {
         box.positions.push_back(region.calculateCenter());
         box.sizes.push_back(region.calculateDimensions());
@@ -175,27 +308,50 @@ void Octree::node::update(Box &box) {
             }
         }
 
-        // remove objects that don't exist anymore
-        for (int i = 0, listSize = objects.size(); i < listSize; i++) {
+        /*
+            single pass over objects (removal is swap-and-pop, so do not advance i after removing)
+            - remove objects that don't exist anymore
+            - transform moved objects and pull out those that have to leave this node
+        */
+        std::vector<BoundingRegion> movedObjects;
+        BoundingRegion looseRegion = looseBounds(region, looseness);
+        for (unsigned int i = 0; i < objects.size();) {
             // remove if kill switch active
             if (States::isActive(&objects[i].instance->state, INSTANCE_DEAD)) {
-                objects.erase(objects.begin() + i);
-                // offset because removed item from list
-                i--;
-                listSize--;
+                removeObject(i);
+                continue;
             }
-        }
 
-        // get moved objects that were in this leaf in previous frame
-        std::stack<int> movedObjects;
-        for (int i = 0, listSize = objects.size(); i < listSize; i++) {
+            box.positions.push_back(objects[i].calculateCenter());
+            box.sizes.push_back(objects[i].calculateDimensions());
+
             if (States::isActive(&objects[i].instance->state, INSTANCE_MOVED)) {
                 // if moved switch active, transform region and push to list
                 objects[i].transform();
-                movedObjects.push(i);
+                movedObjects.push_back(objects[i]);
+                batchesDirty = true;
+
+                if (looseness <= 1.0f || !looseRegion.containsRegion(objects[i])) {
+                    // find new node once children are updated
+                    removeObject(i);
+                    continue;
+                }
             }
-            box.positions.push_back(objects[i].calculateCenter());
-            box.sizes.push_back(objects[i].calculateDimensions());
+            else if (getRoot()->staleRegions) {
+                // instance may have moved after the region was copied (not this frame, so no collision test)
+                objects[i].transform();
+                batchesDirty = true;
+
+                if (!looseRegion.containsRegion(objects[i])) {
+                    // insert again from the root
+                    getRoot()->queue.push_back(objects[i]);
+                    getRoot()->noReinsertions++;
+                    removeObject(i);
+                    continue;
+                }
+            }
+
+            i++;
         }
 
         // remove dead branches
@@ -210,8 +366,9 @@ void Octree::node::update(Box &box) {
                     children[i]->currentLifespan = -1;
                 }
                 else {
-                    // branch is dead
-                    free(children[i]);
+                    // branch is dead, recycle it
+                    children[i]->destroy();
+                    pool.release(children[i]);
                     children[i] = nullptr;
                     States::deactivateIndex(&activeOctants, i);
                 }
@@ -235,18 +392,29 @@ void Octree::node::update(Box &box) {
         }
         
         // move moved objects into new nodes
-        BoundingRegion movedObj; // placeholder
-        while (movedObjects.size() != 0) {
+        for (BoundingRegion& movedObj : movedObjects) {
             /*
                 for each moved object
                 - traverse up tree (start with current node) until find a node that completely encloses the object
                 - call insert (push object as far down as possible)
             */
 
-            movedObj = objects[movedObjects.top()]; // set to top object in stack
             node* current = this; // placeholder
 
-            while (!current->region.containsRegion(movedObj)) {
+            if (getRoot()->detectCollisions && getRoot()->linkedIndex) {
+                // objects kept in the other index
+                getRoot()->linkedIndex->checkCollisionsRegion(movedObj);
+            }
+
+            if (looseness > 1.0f && looseRegion.containsRegion(movedObj)) {
+                // still inside the loose bounds, so it stayed in this node
+                if (getRoot()->detectCollisions) {
+                    getRoot()->deferredChecks.push_back(movedObj);
+                }
+                continue;
+            }
+
+            while (!looseBounds(current->region, current->looseness).containsRegion(movedObj)) {
                 if (current->parent != nullptr) {
                     // set current to current's parent (recursion)
                     current = current->parent;
@@ -256,17 +424,21 @@ void Octree::node::update(Box &box) {
                 }
             }
 
-            /*
-                once finished
-                - remove from objects list
-                - remove from movedObjects stack
-                - insert into found region
-            */
-            objects.erase(objects.begin() + movedObjects.top());
-            movedObjects.pop();
-            current->queue.push(movedObj);
+            // insert into found region (already removed from objects list)
+            current->queue.push_back(movedObj);
+            getRoot()->noReinsertions++;
 
             // collision detection
+            if (!getRoot()->detectCollisions) {
+                // pairs are found by a separate broadphase stage
+                continue;
+            }
+            if (looseness > 1.0f) {
+                // loose bounds overlap, so neighbouring nodes can hold colliding objects
+                getRoot()->deferredChecks.push_back(movedObj);
+                continue;
+            }
+
             // itself
             current = movedObj.cell;
             current->checkCollisionsSelf(movedObj);
@@ -283,33 +455,107 @@ void Octree::node::update(Box &box) {
     }
 
     processPending();
+
+    if (parent == nullptr) {
+        // other moved objects are transformed and re-inserted by now
+        for (const BoundingRegion& movedObj : deferredChecks) {
+            checkCollisionsLoose(movedObj);
+        }
+        deferredChecks.clear();
+
+        staleRegions = false;
+    }
 }
 
 // process pending queue
 void Octree::node::processPending() {
     if (!treeBuilt) {
         // add objects to be sorted into branches when built
-        while (queue.size() != 0) {
-            objects.push_back(queue.front());
-            queue.pop();
-        }
+        objects.insert(objects.end(), queue.begin(), queue.end());
+        queue.clear();
         build();
     }
     else {
-        for (int i = 0, len = queue.size(); i < len; i++) {
-            BoundingRegion br = queue.front();
-            if (region.containsRegion(br)) {
+        // objects that cannot be inserted yet are moved to the front of the queue
+        unsigned int noWaiting = 0;
+        for (unsigned int i = 0, len = queue.size(); i < len; i++) {
+            BoundingRegion& br = queue[i];
+
+            if (States::isActive(&br.instance->state, INSTANCE_DEAD)) {
+                // deleted while waiting
+                continue;
+            }
+
+            if (looseBounds(region, looseness).containsRegion(br) ||
+                (parent == nullptr && grow(br))) {
                 // insert object immediately
                 insert(br);
+                getRoot()->noInsertions++;
             }
             else {
                 // return to queue
                 br.transform();
-                queue.push(br);
+                queue[noWaiting++] = br;
+            }
+        }
+        queue.resize(noWaiting);
+    }
+}
+
+// double the bounds until the region fits (root only, false if it would pass OCTREE_MAX_ROOT_SIZE)
+bool Octree::node::grow(const BoundingRegion& br) {
+    glm::vec3 target = br.calculateCenter();
+
+    while (!looseBounds(region, looseness).containsRegion(br)) {
+        BoundingRegion grown = growBounds(region, target);
+        glm::vec3 dimensions = grown.calculateDimensions();
+        if (dimensions.x > OCTREE_MAX_ROOT_SIZE ||
+            dimensions.y > OCTREE_MAX_ROOT_SIZE ||
+            dimensions.z > OCTREE_MAX_ROOT_SIZE) {
+            // too far away, leave it in the queue
+            return false;
+        }
+
+        // find the octant of the grown bounds the current bounds fill (centers of other octants are half the size away)
+        int octant = 0;
+        BoundingRegion octantBounds;
+        for (; octant < NO_CHILDREN - 1; octant++) {
+            calculateBounds(octantBounds, (Octant)(1 << octant), grown);
+            glm::vec3 offset = glm::abs(octantBounds.calculateCenter() - region.calculateCenter());
+            if (offset.x < dimensions.x / 4.0f && offset.y < dimensions.y / 4.0f && offset.z < dimensions.z / 4.0f) {
+                break;
             }
-            queue.pop();
         }
+
+        // move contents of this node down into a new child, so the root stays at the same address
+        node* child = pool.create(region);
+        child->parent = this;
+        child->looseness = looseness;
+        child->treeBuilt = treeBuilt;
+        child->treeReady = treeReady;
+        child->activeOctants = activeOctants;
+        child->objects.swap(objects);
+        for (int i = 0; i < NO_CHILDREN; i++) {
+            child->children[i] = children[i];
+            if (children[i]) {
+                children[i]->parent = child;
+            }
+            children[i] = nullptr;
+        }
+        for (BoundingRegion& obj : child->objects) {
+            obj.cell = child;
+        }
+        child->batchesDirty = true;
+        batchesDirty = true;
+
+        region = grown;
+        children[octant] = child;
+        activeOctants = 0;
+        States::activateIndex(&activeOctants, octant);
+        noGrowths++;
     }
+
+    return true;
 }
 
 // dynamically insert object into node
@@ -326,18 +572,18 @@ bool Octree::node::insert(BoundingRegion obj) {
         dimensions.y < MIN_BOUNDS ||
         dimensions.z < MIN_BOUNDS
         ) {
-        obj.cell = this;
-        objects.push_back(obj);
+        addObject(obj);
         return true;
     }
 
     // safeguard if object doesn't fit
-    if (!region.containsRegion(obj)) {
+    if (!looseBounds(region, looseness).containsRegion(obj)) {
         return parent == nullptr ? false : parent->insert(obj);
     }
 
     // create regions if not defined
     BoundingRegion octants[NO_CHILDREN];
+    BoundingRegion looseOctants[NO_CHILDREN]; // bounds objects are accepted in
     for (int i = 0; i < NO_CHILDREN; i++) {
         if (children[i] != nullptr) {
             // child exists, so take its region
@@ -347,19 +593,20 @@ bool Octree::node::insert(BoundingRegion obj) {
             // get region for this octant
             calculateBounds(octants[i], (Octant)(1 << i), region);
         }
+        looseOctants[i] = looseBounds(octants[i], looseness);
     }
 
-    objects.push_back(obj);
+    addObject(obj);
 
     // determine which octants to put objects in
     std::vector<BoundingRegion> octLists[NO_CHILDREN]; // array of list of objects in each octant
     for (int i = 0, len = objects.size(); i < len; i++) {
         objects[i].cell = this;
         for (int j = 0; j < NO_CHILDREN; j++) {
-            if (octants[j].containsRegion(objects[i])) {
+            if (looseOctants[j].containsRegion(objects[i])) {
                 octLists[j].push_back(objects[i]);
                 // remove from objects list
-                objects.erase(objects.begin() + i);
+                removeObject(i);
                 i--;
                 len--;
                 break;
@@ -378,8 +625,9 @@ bool Octree::node::insert(BoundingRegion obj) {
             }
             else {
                 // create new node
-                children[i] = new node(octants[i], octLists[i]);
+                children[i] = pool.create(octants[i], octLists[i]);
                 children[i]->parent = this;
+                children[i]->looseness = looseness;
                 States::activateIndex(&activeOctants, i);
                 children[i]->build();
             }
@@ -389,110 +637,138 @@ bool Octree::node::insert(BoundingRegion obj) {
     return true;
 }
 
-// check collisions with all objects in node
-void Octree::node::checkCollisionsSelf(BoundingRegion obj) {
-    for (BoundingRegion br : objects) {
-        if (br.instance->instanceId == obj.instance->instanceId) {
-            // do not test collisions with the same instance
-            continue;
+// add object to the end of the list and point it to its slot
+void Octree::node::addObject(BoundingRegion obj) {
+    obj.cell = this;
+    obj.cellIdx = objects.size();
+    objects.push_back(obj);
+    batchesDirty = true;
+}
+
+// remove object in O(1) by moving the last object into its slot
+void Octree::node::removeObject(unsigned int idx) {
+    if (idx != objects.size() - 1) {
+        objects[idx] = objects.back();
+        objects[idx].cellIdx = idx;
+    }
+    objects.pop_back();
+    batchesDirty = true;
+}
+
+// get objects transposed for the batched kernels (reloads if dirty)
+const std::vector<SIMD::batch>& Octree::node::getObjectBatches() {
+    if (batchesDirty) {
+        objectBatches.clear();
+        SIMD::loadBatches(objects.data(), objects.size(), objectBatches);
+        batchesDirty = false;
+    }
+    return objectBatches;
+}
+
+// check collisions between a pair of bounding regions (coarse then fine grain)
+void Octree::checkCollisionsPair(const BoundingRegion& br, const BoundingRegion& obj) {
+    // coarse check for bounding region intersection
+    if (br.intersectsWith(obj)) {
+        // coarse check passed
+        checkCollisionsFine(br, obj);
+    }
+}
+
+// check collisions between a pair whose bounding regions intersect (fine grain)
+void Octree::checkCollisionsFine(const BoundingRegion& br, const BoundingRegion& obj) {
+    unsigned int noFacesBr = br.collisionMesh ? br.collisionMesh->noFaces : 0;
+    unsigned int noFacesObj = obj.collisionMesh ? obj.collisionMesh->noFaces : 0;
+
+    // contact (norm points from br toward obj)
+    glm::vec3 norm;
+    float depth = 0.0f;
+    int faceBr = -1, faceObj = -1;
+
+    if (noFacesBr) {
+        if (noFacesObj) {
+            // both have collision meshes
+            // check faces in br against faces in obj (walks both face trees)
+            if (br.collisionMesh->collidesWithMesh(
+                br.instance,
+                obj.collisionMesh,
+                obj.instance,
+                norm,
+                depth,
+                faceBr,
+                faceObj
+            )) {
+                Events::record(br.instance, obj.instance, norm, depth, Events::CollisionCase::MESH_MESH, faceBr, faceObj);
+                obj.instance->handleCollision(br.instance, norm, depth);
+            }
         }
+        else {
+            // br has a collision mesh, obj does not
+            // check faces in br against the obj's sphere
+            if (br.collisionMesh->collidesWithSphere(
+                br.instance,
+                obj,
+                norm,
+                depth,
+                faceBr
+            )) {
+                Events::record(br.instance, obj.instance, norm, depth, Events::CollisionCase::MESH_SPHERE, faceBr, -1);
+                obj.instance->handleCollision(br.instance, norm, depth);
+            }
+        }
+    }
+    else {
+        if (noFacesObj) {
+            // obj has a collision mesh, br does not
+            // check faces in obj against br's sphere
+            if (obj.collisionMesh->collidesWithSphere(
+                obj.instance,
+                br,
+                norm,
+                depth,
+                faceObj
+            )) {
+                // face normal points toward br, flip to push obj
+                Events::record(br.instance, obj.instance, -norm, depth, Events::CollisionCase::SPHERE_MESH, -1, faceObj);
+                obj.instance->handleCollision(br.instance, -norm, depth);
+            }
+        }
+        else {
+            // neither have a collision mesh
+            // coarse grain test pased (test collision between spheres)
+            br.calculateContact(obj, norm, depth);
 
-        // coarse check for bounding region intersection
-        if (br.intersectsWith(obj)) {
-            // coarse check passed
-
-            unsigned int noFacesBr = br.collisionMesh ? br.collisionMesh->faces.size() : 0;
-            unsigned int noFacesObj = obj.collisionMesh ? obj.collisionMesh->faces.size() : 0;
-
-            glm::vec3 norm;
-
-            if (noFacesBr) {
-                unsigned int noFacesBr = br.collisionMesh->faces.size();
-
-                if (noFacesObj) {
-                    // both have collision meshes
-                    unsigned int noFacesObj = obj.collisionMesh->faces.size();
-
-                    // check all faces in br against all faces in obj
-                    for (unsigned int i = 0; i < noFacesBr; i++) {
-                        for (unsigned int j = 0; j < noFacesObj; j++) {
-                            if (br.collisionMesh->faces[i].collidesWithFace(
-                                br.instance,
-                                obj.collisionMesh->faces[j],
-                                obj.instance,
-                                norm
-                            )) {
-                                std::cout << "Case 1: Instance " << br.instance->instanceId
-                                    << " (" << br.instance->modelId << ") collides with instance "
-                                    << obj.instance->instanceId << " (" << obj.instance->modelId << ")" << std::endl;
-                                
-                                obj.instance->handleCollision(br.instance, norm);
-                                
-                                break;
-                            }
-                        }
-                    }
-                }
-                else {
-                    // br has a collision mesh, obj does not
-                    // check all faces in br against the obj's sphere
-                    for (unsigned int i = 0; i < noFacesBr; i++) {
-                        if (br.collisionMesh->faces[i].collidesWithSphere(
-                            br.instance,
-                            obj,
-                            norm
-                        )) {
-                            std::cout << "Case 2: Instance " << br.instance->instanceId
-                                << " (" << br.instance->modelId << ") collides with instance "
-                                << obj.instance->instanceId << " (" << obj.instance->modelId << ")" << std::endl;
-                            
-                            obj.instance->handleCollision(br.instance, norm);
-                            
-                            break;
-                        }
-                    }
-                }
+            Events::record(br.instance, obj.instance, norm, depth, Events::CollisionCase::REGIONS);
+            obj.instance->handleCollision(br.instance, norm, depth);
+        }
+    }
+}
+
+// check collisions with all objects in node
+void Octree::node::checkCollisionsSelf(const BoundingRegion& obj) {
+    const std::vector<SIMD::batch>& batches = getObjectBatches();
+
+    for (unsigned int b = 0, len = batches.size(); b < len; b++) {
+        // coarse check against a batch of objects at once
+        unsigned int hits = SIMD::intersectsRegions(obj, batches[b]);
+
+        for (unsigned int j = 0; hits; hits >>= 1, j++) {
+            if (!(hits & 1)) {
+                continue;
             }
-            else {
-                if (noFacesObj) {
-                    // obj has a collision mesh, br does not
-                    // check all faces in obj against br's sphere
-                    unsigned int noFacesObj = obj.collisionMesh->faces.size();
-
-                    for (int i = 0; i < noFacesObj; i++) {
-                        if (obj.collisionMesh->faces[i].collidesWithSphere(
-                            obj.instance,
-                            br,
-                            norm
-                        )) {
-                            std::cout << "Case 3: Instance " << br.instance->instanceId
-                                << " (" << br.instance->modelId << ") collides with instance "
-                                << obj.instance->instanceId << " (" << obj.instance->modelId << ")" << std::endl;
-                            
-                            obj.instance->handleCollision(br.instance, norm);
-
-                            break;
-                        }
-                    }
-                }
-                else {
-                    // neither have a collision mesh
-                    // coarse grain test pased (test collision between spheres)
-                    std::cout << "Case 4: Instance " << br.instance->instanceId
-                        << " (" << br.instance->modelId << ") collides with instance "
-                        << obj.instance->instanceId << " (" << obj.instance->modelId << ")" << std::endl;
-                
-                    norm = obj.center - br.center;
-
-                    obj.instance->handleCollision(br.instance, norm);
-                }
+
+            BoundingRegion& br = objects[b * SIMD_BATCH + j];
+            if (br.instance->instanceId == obj.instance->instanceId) {
+                // do not test collisions with the same instance
+                continue;
             }
+
+            checkCollisionsFine(br, obj);
         }
     }
 }
 
 // check collisions with all objects in child nodes
-void Octree::node::checkCollisionsChildren(BoundingRegion obj) {
+void Octree::node::checkCollisionsChildren(const BoundingRegion& obj) {
     if (children) {
         for (int flags = activeOctants, i = 0;
             flags > 0;
@@ -505,76 +781,461 @@ void Octree::node::checkCollisionsChildren(BoundingRegion obj) {
     }
 }
 
-// check collisions with a ray
+// check collisions with all objects in nodes whose loose bounds intersect the object
+void Octree::node::checkCollisionsLoose(const BoundingRegion& obj) {
+    if (!looseBounds(region, looseness).intersectsWith(obj)) {
+        // object cannot touch anything in this branch
+        return;
+    }
+
+    checkCollisionsSelf(obj);
+
+    for (int flags = activeOctants, i = 0;
+        flags > 0;
+        flags >>= 1, i++) {
+        if (States::isIndexActive(&flags, 0) && children[i]) {
+            children[i]->checkCollisionsLoose(obj);
+        }
+    }
+}
+
+// check collisions between the object and every object in the tree it overlaps
+void Octree::node::checkCollisionsRegion(const BoundingRegion& obj) {
+    // objects never leave the loose bounds of their node
+    getRoot()->checkCollisionsLoose(obj);
+}
+
+// find objects with a region intersecting the region (skips branches whose loose bounds miss it)
+void Octree::node::queryRegion(const BoundingRegion& br, std::vector<BoundingRegion*>& found) {
+    if (!looseBounds(region, looseness).intersectsWith(br)) {
+        // nothing in this branch can touch the region
+        return;
+    }
+
+    for (BoundingRegion& obj : objects) {
+        if (obj.intersectsWith(br)) {
+            found.push_back(&obj);
+        }
+    }
+
+    for (unsigned char flags = activeOctants, i = 0;
+        flags > 0;
+        flags >>= 1, i++) {
+        if (States::isIndexActive(&flags, 0) && children[i]) {
+            children[i]->queryRegion(br, found);
+        }
+    }
+}
+
+// check collisions with a ray (closest hit)
 BoundingRegion* Octree::node::checkCollisionsRay(Ray r, float& tmin) {
-    float tmin_tmp = std::numeric_limits<float>::max();
-    float tmax_tmp = std::numeric_limits<float>::lowest();
-    float t_tmp = std::numeric_limits<float>::max();
+    std::vector<Ray> rays = { r };
+    std::vector<RayHit> hits;
+    checkCollisionsRays(rays, hits, RayQuery::CLOSEST, tmin);
+
+    if (hits.size() == 0) {
+        return nullptr;
+    }
 
-    // check current region
-    if (r.intersectsBoundingRegion(region, tmin_tmp, tmax_tmp)) {
-        // know ray collides with the current region
-        if (tmin_tmp >= tmin) {
-            // found nearer collision
-            return nullptr;
+    tmin = hits[0].t;
+    return hits[0].region;
+}
+
+// keep rays that enter the bounds before their current best hit, returns nearest entry distance
+static float filterRays(std::vector<Ray>& rays, std::vector<unsigned int>& active, BoundingRegion bounds,
+    std::vector<float>& tmin, std::vector<unsigned int>& outRays, std::vector<float>& outEntries) {
+    float nearest = std::numeric_limits<float>::max();
+    float tmin_tmp, tmax_tmp;
+
+    for (unsigned int r : active) {
+        if (!rays[r].intersectsBoundingRegion(bounds, tmin_tmp, tmax_tmp) || tmax_tmp < 0.0f) {
+            continue;
         }
 
-        BoundingRegion* ret = nullptr, * ret_tmp = nullptr;
+        // ray can start inside the bounds
+        tmin_tmp = std::fmaxf(tmin_tmp, 0.0f);
+        if (tmin_tmp < tmin[r]) {
+            outRays.push_back(r);
+            outEntries.push_back(tmin_tmp);
+            nearest = std::fminf(nearest, tmin_tmp);
+        }
+    }
+
+    return nearest;
+}
+
+// check collisions with a packet of rays (hits sorted by ray, then distance)
+void Octree::node::checkCollisionsRays(std::vector<Ray>& rays, std::vector<RayHit>& hits, RayQuery mode, float maxDistance) {
+    hits.clear();
+
+    // distance each ray is still searched to (shrinks as closer hits are found)
+    std::vector<float> tmin(rays.size(), maxDistance);
+    // best hit of each ray (CLOSEST/ANY)
+    std::vector<RayHit> best(rays.size(), { 0, nullptr, nullptr, maxDistance, -1 });
+
+    std::vector<unsigned int> all(rays.size());
+    for (unsigned int i = 0, len = rays.size(); i < len; i++) {
+        all[i] = i;
+    }
+
+    // rays that enter the root
+    std::vector<unsigned int> active;
+    std::vector<float> entries;
+    filterRays(rays, all, looseBounds(region, looseness), tmin, active, entries);
+    if (active.size() == 0) {
+        return;
+    }
 
-        // check objects in the node
-        for (BoundingRegion& br : this->objects) {
-            tmin_tmp = std::numeric_limits<float>::max();
-            tmax_tmp = std::numeric_limits<float>::lowest();
+    if (mode == RayQuery::ALL) {
+        checkCollisionsPacket(rays, active, mode, tmin, hits);
 
-            // coarse check - check against BR
-            if (r.intersectsBoundingRegion(br, tmin_tmp, tmax_tmp)) {
-                std::cout << "Passed coarse check, ";
-                if (tmin_tmp > tmin) {
+        std::sort(hits.begin(), hits.end(), [](const RayHit& h1, const RayHit& h2) -> bool {
+            return h1.ray < h2.ray || (h1.ray == h2.ray && h1.t < h2.t);
+        });
+    }
+    else {
+        checkCollisionsPacket(rays, active, mode, tmin, best);
+
+        for (RayHit& hit : best) {
+            if (hit.instance) {
+                hits.push_back(hit);
+            }
+        }
+    }
+}
+
+// check active rays (known to enter this node) against objects, then children nearest first
+void Octree::node::checkCollisionsPacket(std::vector<Ray>& rays, std::vector<unsigned int>& active,
+    RayQuery mode, std::vector<float>& tmin, std::vector<RayHit>& hits) {
+    const std::vector<SIMD::batch>& batches = getObjectBatches();
+    SIMD::batch b;
+    float tminBatch[SIMD_BATCH];
+    float tmaxBatch[SIMD_BATCH];
+
+    // check objects in the node, a batch at a time
+    for (unsigned int i = 0, len = batches.size(); i < len; i++) {
+        for (unsigned int r : active) {
+            // coarse check - check against every BR in the batch
+            unsigned int hitMask = SIMD::rayIntersectsRegions(rays[r], batches[i], tminBatch, tmaxBatch);
+
+            for (unsigned int j = 0; hitMask; hitMask >>= 1, j++) {
+                if (!(hitMask & 1) || tmaxBatch[j] < 0.0f) {
                     continue;
                 }
-                else if (br.collisionMesh) {
-                    // fine grain check with collision mesh
-                    t_tmp = std::numeric_limits<float>::max();
-                    if (r.intersectsMesh(br.collisionMesh, br.instance, t_tmp)) {
-                        if (t_tmp < tmin) {
-                            // found closer collision
-                            tmin = t_tmp;
-                            ret = &br;
-                        }
+
+                BoundingRegion& br = objects[i * SIMD_BATCH + j];
+                float t = std::fmaxf(tminBatch[j], 0.0f);
+                if (t >= tmin[r]) {
+                    // found nearer collision (or ray is done)
+                    continue;
+                }
+
+                int face = -1;
+                if (br.collisionMesh) {
+                    // fine grain check with collision mesh (only accepts hits closer than tmin)
+                    t = tmin[r];
+                    if (!rays[r].intersectsMesh(br.collisionMesh, br.instance, t, face)) {
+                        continue;
                     }
                 }
+
+                RayHit hit = { r, br.instance, &br, t, face };
+                if (mode == RayQuery::ALL) {
+                    hits.push_back(hit);
+                }
                 else {
-                    // rely on coarse check
-                    if (tmin_tmp < tmin) {
-                        tmin = tmin_tmp;
-                        ret = &br;
-                    }
+                    hits[r] = hit;
+                    // ANY stops the ray at its first hit
+                    tmin[r] = mode == RayQuery::ANY ? std::numeric_limits<float>::lowest() : t;
                 }
             }
-            else {
-                std::cout << "Failed coarse check, ";
+        }
+    }
+
+    // find rays entering each child (all children are tested against a ray at once)
+    std::vector<unsigned int> childRays[NO_CHILDREN];
+    std::vector<float> childEntries[NO_CHILDREN];
+    float nearest[NO_CHILDREN];
+    unsigned char order[NO_CHILDREN];
+    unsigned char noChildren = 0;
+
+    BoundingRegion childBounds[NO_CHILDREN];
+    unsigned char childIdx[NO_CHILDREN];
+    unsigned char noActiveChildren = 0;
+    for (unsigned char flags = activeOctants, i = 0;
+        flags;
+        flags >>= 1, i++) {
+        if (States::isIndexActive(&flags, 0) && children[i]) {
+            childBounds[noActiveChildren] = looseBounds(children[i]->region, looseness);
+            childIdx[noActiveChildren++] = i;
+            nearest[i] = std::numeric_limits<float>::max();
+        }
+    }
+
+    if (noActiveChildren == 0) {
+        return;
+    }
+    b.load(childBounds, noActiveChildren);
+
+    for (unsigned int r : active) {
+        unsigned int hitMask = SIMD::rayIntersectsRegions(rays[r], b, tminBatch, tmaxBatch);
+
+        for (unsigned int j = 0; hitMask; hitMask >>= 1, j++) {
+            if (!(hitMask & 1) || tmaxBatch[j] < 0.0f) {
+                continue;
+            }
+
+            // ray can start inside the bounds
+            float t = std::fmaxf(tminBatch[j], 0.0f);
+            if (t < tmin[r]) {
+                unsigned char i = childIdx[j];
+                childRays[i].push_back(r);
+                childEntries[i].push_back(t);
+                nearest[i] = std::fminf(nearest[i], t);
             }
         }
+    }
 
-        // check children
-        if (children) {
-            for (unsigned char flags = activeOctants, i = 0;
-                flags;
-                flags >>= 1, i++) {
-                ret_tmp = children[i]->checkCollisionsRay(r, tmin);
-                if (ret_tmp) {
-                    ret = ret_tmp;
-                }
+    for (unsigned char j = 0; j < noActiveChildren; j++) {
+        if (childRays[childIdx[j]].size() != 0) {
+            order[noChildren++] = childIdx[j];
+        }
+    }
+
+    // visit nearest children first, so farther ones can be skipped once hits are found
+    std::sort(order, order + noChildren, [&nearest](unsigned char i1, unsigned char i2) -> bool {
+        return nearest[i1] < nearest[i2];
+    });
+
+    for (unsigned char c = 0; c < noChildren; c++) {
+        unsigned char i = order[c];
+
+        // drop rays that found a hit before entering this child
+        unsigned int noRays = 0;
+        for (unsigned int k = 0, len = childRays[i].size(); k < len; k++) {
+            if (childEntries[i][k] < tmin[childRays[i][k]]) {
+                childRays[i][noRays++] = childRays[i][k];
+            }
+        }
+        childRays[i].resize(noRays);
+
+        if (noRays != 0) {
+            children[i]->checkCollisionsPacket(rays, childRays[i], mode, tmin, hits);
+        }
+    }
+}
+
+// find instances with a region inside the frustum (skips nodes outside, stops testing inside)
+void Octree::node::checkCollisionsFrustum(Frustum& frustum, std::vector<RigidBody*>& instances) {
+    checkCollisionsFrustum(frustum, instances, false);
+
+    // objects waiting to be inserted (may be outside of the root, other nodes empty their queue while updating)
+    for (const BoundingRegion& br : queue) {
+        if (frustum.testRegion(br) != FrustumTest::OUTSIDE) {
+            instances.push_back(br.instance);
+        }
+    }
+}
+
+// find instances in this branch with a region inside the frustum (inside if the branch is known to be inside)
+void Octree::node::checkCollisionsFrustum(Frustum& frustum, std::vector<RigidBody*>& instances, bool inside) {
+    if (!inside) {
+        FrustumTest result = frustum.testRegion(looseBounds(region, looseness));
+        if (result == FrustumTest::OUTSIDE) {
+            // nothing in this branch can be seen
+            return;
+        }
+        // every object in this branch can be seen
+        inside = result == FrustumTest::INSIDE;
+    }
+
+    // objects in the node
+    for (BoundingRegion& br : objects) {
+        if (inside || frustum.testRegion(br) != FrustumTest::OUTSIDE) {
+            instances.push_back(br.instance);
+        }
+    }
+
+    for (int flags = activeOctants, i = 0;
+        flags > 0;
+        flags >>= 1, i++) {
+        if (States::isIndexActive(&flags, 0) && children[i]) {
+            children[i]->checkCollisionsFrustum(frustum, instances, inside);
+        }
+    }
+}
+
+// find instances with a region within radius of center, returns number found (only the first maxInstances are written)
+unsigned int Octree::node::queryRadius(glm::vec3 center, float radius, RigidBody** instances, unsigned int maxInstances) {
+    unsigned int noFound = 0;
+    queryRadius(center, radius, [instances, maxInstances, &noFound](RigidBody* instance) -> void {
+        if (noFound < maxInstances) {
+            instances[noFound] = instance;
+        }
+        noFound++;
+    });
+    return noFound;
+}
+
+// find instances with a region intersecting the box, returns number found (only the first maxInstances are written)
+unsigned int Octree::node::queryBox(const BoundingRegion& box, RigidBody** instances, unsigned int maxInstances) {
+    unsigned int noFound = 0;
+    queryBox(box, [instances, maxInstances, &noFound](RigidBody* instance) -> void {
+        if (noFound < maxInstances) {
+            instances[noFound] = instance;
+        }
+        noFound++;
+    });
+    return noFound;
+}
+
+// find the k instances nearest to point sorted by distance (k is capped at MAX_NEAREST, distances can be nullptr), returns number found
+unsigned int Octree::node::queryNearest(glm::vec3 point, unsigned int k, RigidBody** instances, float* distances) {
+    float buffer[MAX_NEAREST];
+    if (!distances) {
+        distances = buffer;
+    }
+    if (k > MAX_NEAREST) {
+        k = MAX_NEAREST;
+    }
+
+    unsigned int noFound = 0;
+    if (k > 0) {
+        queryNearest(point, k, instances, distances, noFound);
+    }
+    return noFound;
+}
+
+// add instance to the sorted k nearest if it is near enough
+static void insertNearest(RigidBody* instance, float dist, unsigned int k, RigidBody** instances, float* distances, unsigned int& noFound) {
+    // instance may already be listed through another of its regions
+    for (unsigned int i = 0; i < noFound; i++) {
+        if (instances[i] == instance) {
+            if (dist >= distances[i]) {
+                return;
+            }
+
+            // remove the farther entry
+            for (unsigned int j = i + 1; j < noFound; j++) {
+                instances[j - 1] = instances[j];
+                distances[j - 1] = distances[j];
             }
+            noFound--;
+            break;
         }
+    }
 
-        return ret;
+    if (noFound == k) {
+        if (dist >= distances[k - 1]) {
+            // farther than all found
+            return;
+        }
+        // drop the farthest
+        noFound--;
     }
 
-    return nullptr;
+    // shift farther entries back
+    unsigned int i = noFound;
+    while (i > 0 && distances[i - 1] > dist) {
+        instances[i] = instances[i - 1];
+        distances[i] = distances[i - 1];
+        i--;
+    }
+    instances[i] = instance;
+    distances[i] = dist;
+    noFound++;
 }
 
-// destroy object (free memory)
+// search this branch for instances nearer than the current k nearest
+void Octree::node::queryNearest(glm::vec3 point, unsigned int k, RigidBody** instances, float* distances, unsigned int& noFound) {
+    for (BoundingRegion& br : objects) {
+        insertNearest(br.instance, br.calculateDistance(point), k, instances, distances, noFound);
+    }
+
+    // distance to each child
+    float childDistances[NO_CHILDREN];
+    unsigned char order[NO_CHILDREN];
+    unsigned char noChildren = 0;
+    for (unsigned char flags = activeOctants, i = 0;
+        flags > 0;
+        flags >>= 1, i++) {
+        if (States::isIndexActive(&flags, 0) && children[i]) {
+            childDistances[i] = looseBounds(children[i]->region, looseness).calculateDistance(point);
+            order[noChildren++] = i;
+        }
+    }
+
+    // nearest children first, so farther ones can be skipped
+    std::sort(order, order + noChildren, [&childDistances](unsigned char i1, unsigned char i2) -> bool {
+        return childDistances[i1] < childDistances[i2];
+    });
+
+    for (unsigned char c = 0; c < noChildren; c++) {
+        unsigned char i = order[c];
+        if (noFound == k && childDistances[i] >= distances[k - 1]) {
+            // rest of the children are farther than the k nearest
+            break;
+        }
+
+        children[i]->queryNearest(point, k, instances, distances, noFound);
+    }
+}
+
+// copy all objects in the tree into a list (pending objects are left out)
+void Octree::node::collectObjects(std::vector<BoundingRegion>& objectList) {
+    objectList.insert(objectList.end(), objects.begin(), objects.end());
+
+    for (int flags = activeOctants, i = 0;
+        flags > 0;
+        flags >>= 1, i++) {
+        if (States::isIndexActive(&flags, 0) && children[i]) {
+            children[i]->collectObjects(objectList);
+        }
+    }
+}
+
+// copy all objects in the tree into a list, and all pending objects into a queue
+void Octree::node::collectObjects(std::vector<BoundingRegion>& objectList, std::vector<BoundingRegion>& pendingQueue) {
+    objectList.insert(objectList.end(), objects.begin(), objects.end());
+    pendingQueue.insert(pendingQueue.end(), queue.begin(), queue.end());
+
+    for (int flags = activeOctants, i = 0;
+        flags > 0;
+        flags >>= 1, i++) {
+        if (States::isIndexActive(&flags, 0) && children[i]) {
+            children[i]->collectObjects(objectList, pendingQueue);
+        }
+    }
+}
+
+// add the tree to the tree statistics
+void Octree::node::calculateStats(Stats::treeStats& stats) {
+    calculateStats(stats, 0);
+}
+
+// add this branch to the tree statistics
+void Octree::node::calculateStats(Stats::treeStats& stats, unsigned int depth) {
+    stats.addNode(depth, activeOctants == 0, objects.size(), queue.size());
+
+    for (int flags = activeOctants, i = 0;
+        flags > 0;
+        flags >>= 1, i++) {
+        if (States::isIndexActive(&flags, 0) && children[i]) {
+            children[i]->calculateStats(stats, depth + 1);
+        }
+    }
+}
+
+// get root node of the tree
+Octree::node* Octree::node::getRoot() {
+    node* current = this;
+    while (current->parent != nullptr) {
+        current = current->parent;
+    }
+    return current;
+}
+
+// destroy object (return children to the pool)
 void Octree::node::destroy() {
     // clearing out children
     if (children != nullptr) {
@@ -585,15 +1246,18 @@ void Octree::node::destroy() {
                 // active
                 if (children[i] != nullptr) {
                     children[i]->destroy();
+                    pool.release(children[i]);
                     children[i] = nullptr;
                 }
             }
         }
     }
 
+    activeOctants = 0;
+
     // clear this node
     objects.clear();
-    while (queue.size() != 0) {
-        queue.pop();
-    }
+    objectBatches.clear();
+    batchesDirty = true;
+    queue.clear();
 }
\ No newline at end of file
@@ -12,15 +12,29 @@
 
 #define NO_CHILDREN 8
 #define MIN_BOUNDS 0.5
+// subtrees with at least this many objects are built on a worker thread
+#define PARALLEL_BUILD_THRESHOLD 256
+// number of nodes allocated at once by the node pool
+#define NODE_POOL_SLAB_SIZE 256
+// most instances a nearest neighbour query can return
+#define MAX_NEAREST 64
+// largest size the root can grow to along any axis (objects further out wait in the pending queue)
+#define OCTREE_MAX_ROOT_SIZE 4096.0f
 
 #include <vector>
-#include <queue>
-#include <stack>
+#include <future>
+#include <mutex>
+#include <utility>
+#include <limits>
 
 #include "list.hpp"
 #include "states.hpp"
 #include "bounds.h"
+#include "frustum.h"
 #include "ray.h"
+#include "stats.h"
+#include "simd.h"
+#include "spatialindex.h"
 
 #include "../graphics/objects/model.h"
 
@@ -49,6 +63,16 @@ namespace Octree {
         O8 = 0x80	// = 0b10000000
     };
 
+    /*
+        enum to represent spatial index backends
+    */
+
+    enum class Backend : unsigned char {
+        POINTER = 0x00, // heap allocated nodes linked by child pointers
+        LINEAR  = 0x01, // flat array of nodes keyed by Morton code
+        BVH     = 0x02  // bounding volume hierarchy built with SAH (not an octree, see bvh.h)
+    };
+
     /*
         utility methods callbacks
     */
@@ -56,11 +80,28 @@ namespace Octree {
     // calculate bounds of specified quadrant in bounding region
     void calculateBounds(BoundingRegion &out, Octant octant, BoundingRegion parentRegion);
 
+    // enlarge region about its center by the looseness factor
+    BoundingRegion looseBounds(BoundingRegion region, float looseness);
+
+    // double region along each axis towards the point (region becomes one octant of the result)
+    BoundingRegion growBounds(const BoundingRegion& region, glm::vec3 towards);
+
+    // check collisions between a pair of bounding regions (coarse then fine grain)
+    void checkCollisionsPair(const BoundingRegion& br, const BoundingRegion& obj);
+
+    // check collisions between a pair whose bounding regions intersect (fine grain)
+    void checkCollisionsFine(const BoundingRegion& br, const BoundingRegion& obj);
+
+    class nodePool;
+
     /*
-        class to represent each node in the octree
+        class to represent each node in the octree (the root is the spatial index)
     */
-    class node {
+    class node : public SpatialIndex {
     public:
+        // pool that owns every node
+        static nodePool pool;
+
         // parent pointer
         node* parent;
         // array of children (8)
@@ -79,10 +120,31 @@ namespace Octree {
         // current lifespace
         short currentLifespan = -1;
 
+        // factor to enlarge the bounds objects are accepted in (1 = tight octree)
+        float looseness = 1.0f;
+
+        // if the regions were copied before their instances last moved, so the next update transforms every object (root only)
+        bool staleRegions = false;
+
+        // moved objects in loose nodes, tested once every node holds its updated regions (root only)
+        std::vector<BoundingRegion> deferredChecks;
+
+        // number of moved objects re-inserted during the last update (root only)
+        unsigned int noReinsertions = 0;
+        // number of objects dynamically inserted since the tree was built (root only)
+        unsigned int noInsertions = 0;
+        // number of times the bounds were doubled to fit objects since the tree was built (root only)
+        unsigned int noGrowths = 0;
+
         // list of objects in node
         std::vector<BoundingRegion> objects;
-        // queue of objects to be dynamically inserted
-        std::queue<BoundingRegion> queue;
+        // queue of objects to be dynamically inserted (a vector, so it can be searched without copying)
+        std::vector<BoundingRegion> queue;
+
+        // objects transposed for the batched kernels (reloaded when dirty)
+        std::vector<SIMD::batch> objectBatches;
+        // if objects were added, removed or moved since the batches were loaded
+        bool batchesDirty = true;
 
         // region of bounds of cell (AABB)
         BoundingRegion region;
@@ -116,20 +178,189 @@ namespace Octree {
         // process pending queue
         void processPending();
 
+        // double the bounds until the region fits (root only, false if it would pass OCTREE_MAX_ROOT_SIZE)
+        bool grow(const BoundingRegion& br);
+
         // dynamically insert object into node
         bool insert(BoundingRegion obj);
 
+        // add object to the end of the list and point it to its slot
+        void addObject(BoundingRegion obj);
+
+        // remove object in O(1) by moving the last object into its slot (order is not kept)
+        void removeObject(unsigned int idx);
+
         // check collisions with all objects in node
-        void checkCollisionsSelf(BoundingRegion obj);
+        void checkCollisionsSelf(const BoundingRegion& obj);
 
         // check collisions with all objects in child nodes
-        void checkCollisionsChildren(BoundingRegion obj);
+        void checkCollisionsChildren(const BoundingRegion& obj);
 
-        // check collisions with a ray
+        // check collisions with all objects in nodes whose loose bounds intersect the object
+        void checkCollisionsLoose(const BoundingRegion& obj);
+
+        // check collisions between the object and every object in the tree it overlaps
+        void checkCollisionsRegion(const BoundingRegion& obj);
+
+        // find objects with a region intersecting the region (skips branches whose loose bounds miss it)
+        void queryRegion(const BoundingRegion& br, std::vector<BoundingRegion*>& found);
+
+        // check collisions with a ray (closest hit)
         BoundingRegion* checkCollisionsRay(Ray r, float& tmin);
 
-        // destroy object (free memory)
+        // check collisions with a packet of rays (hits sorted by ray, then distance)
+        void checkCollisionsRays(std::vector<Ray>& rays, std::vector<RayHit>& hits,
+            RayQuery mode = RayQuery::CLOSEST, float maxDistance = std::numeric_limits<float>::max());
+
+        // find instances with a region inside the frustum (skips nodes outside, stops testing inside)
+        void checkCollisionsFrustum(Frustum& frustum, std::vector<RigidBody*>& instances);
+
+        /*
+            range queries (objects waiting in the pending queue are not searched,
+            and an instance with several regions is reported once per matching region)
+        */
+
+        // visit every instance with a region within radius of center
+        template <typename Visitor>
+        void queryRadius(glm::vec3 center, float radius, Visitor&& visit) {
+            if (looseBounds(region, looseness).calculateDistance(center) > radius) {
+                // branch is out of range
+                return;
+            }
+
+            for (BoundingRegion& br : objects) {
+                if (br.calculateDistance(center) <= radius) {
+                    visit(br.instance);
+                }
+            }
+
+            for (unsigned char flags = activeOctants, i = 0;
+                flags > 0;
+                flags >>= 1, i++) {
+                if (States::isIndexActive(&flags, 0) && children[i]) {
+                    children[i]->queryRadius(center, radius, visit);
+                }
+            }
+        }
+
+        // find instances with a region within radius of center, returns number found (only the first maxInstances are written)
+        unsigned int queryRadius(glm::vec3 center, float radius, RigidBody** instances, unsigned int maxInstances);
+
+        // visit every instance with a region intersecting the box
+        template <typename Visitor>
+        void queryBox(const BoundingRegion& box, Visitor&& visit) {
+            if (!looseBounds(region, looseness).intersectsWith(box)) {
+                // branch is out of range
+                return;
+            }
+
+            for (BoundingRegion& br : objects) {
+                if (br.intersectsWith(box)) {
+                    visit(br.instance);
+                }
+            }
+
+            for (unsigned char flags = activeOctants, i = 0;
+                flags > 0;
+                flags >>= 1, i++) {
+                if (States::isIndexActive(&flags, 0) && children[i]) {
+                    children[i]->queryBox(box, visit);
+                }
+            }
+        }
+
+        // find instances with a region intersecting the box, returns number found (only the first maxInstances are written)
+        unsigned int queryBox(const BoundingRegion& box, RigidBody** instances, unsigned int maxInstances);
+
+        // visit the k instances nearest to point in order of distance (k is capped at MAX_NEAREST)
+        template <typename Visitor>
+        void queryNearest(glm::vec3 point, unsigned int k, Visitor&& visit) {
+            RigidBody* instances[MAX_NEAREST];
+            float distances[MAX_NEAREST];
+            unsigned int noFound = queryNearest(point, k, instances, distances);
+
+            for (unsigned int i = 0; i < noFound; i++) {
+                visit(instances[i], distances[i]);
+            }
+        }
+
+        // find the k instances nearest to point sorted by distance (k is capped at MAX_NEAREST, distances can be nullptr), returns number found
+        unsigned int queryNearest(glm::vec3 point, unsigned int k, RigidBody** instances, float* distances);
+
+        // copy all objects in the tree into a list (pending objects are left out)
+        void collectObjects(std::vector<BoundingRegion>& objectList);
+
+        // copy all objects in the tree into a list, and all pending objects into a queue
+        void collectObjects(std::vector<BoundingRegion>& objectList, std::vector<BoundingRegion>& pendingQueue);
+
+        // add the tree to the tree statistics
+        void calculateStats(Stats::treeStats& stats);
+
+        // add this branch to the tree statistics
+        void calculateStats(Stats::treeStats& stats, unsigned int depth);
+
+        // get root node of the tree
+        node* getRoot();
+
+        // destroy object (return children to the pool)
         void destroy();
+
+    private:
+        // get objects transposed for the batched kernels (reloads if dirty)
+        const std::vector<SIMD::batch>& getObjectBatches();
+
+        // search this branch for instances nearer than the current k nearest
+        void queryNearest(glm::vec3 point, unsigned int k, RigidBody** instances, float* distances, unsigned int& noFound);
+
+        // find instances in this branch with a region inside the frustum (inside if the branch is known to be inside)
+        void checkCollisionsFrustum(Frustum& frustum, std::vector<RigidBody*>& instances, bool inside);
+
+        // check active rays (known to enter this node) against objects, then children nearest first
+        void checkCollisionsPacket(std::vector<Ray>& rays, std::vector<unsigned int>& active,
+            RayQuery mode, std::vector<float>& tmin, std::vector<RayHit>& hits);
+    };
+
+    /*
+        class to allocate nodes in slabs and recycle them through a free list
+        - nodes can be created from worker threads during a parallel build
+    */
+    class nodePool {
+    public:
+        // destructor
+        ~nodePool();
+
+        // construct a node in memory from the pool
+        template <typename... Args>
+        node* create(Args&&... args) {
+            return new (allocate()) node(std::forward<Args>(args)...);
+        }
+
+        // destroy a node and return its memory to the pool
+        void release(node* n);
+
+        // free all slabs (only if no nodes are in use)
+        void cleanup();
+
+        // number of nodes currently in use
+        unsigned int getNoLive() const;
+        // highest number of nodes in use at once
+        unsigned int getNoPeak() const;
+
+    private:
+        // counters (read through the getters, a rebuild may be allocating)
+        unsigned int noLive = 0;
+        unsigned int noPeak = 0;
+
+        // blocks of memory for NODE_POOL_SLAB_SIZE nodes
+        std::vector<void*> slabs;
+        // memory of released nodes
+        std::vector<void*> freeList;
+
+        // guards all members
+        mutable std::mutex mtx;
+
+        // get memory for one node
+        void* allocate();
     };
 }
 
@@ -8,9 +8,11 @@
  *****************************************************************/
 
 #include "ray.h"
+#include "simd.h"
 
 #include "../algorithms/math/linalg.h"
 #include <limits>
+#include <vector>
 
 Ray::Ray(glm::vec3 origin, glm::vec3 dir)
 	: origin(origin), dir(dir), invdir(1.0f) {
@@ -30,21 +32,9 @@ Ray::Ray(glm::vec3 origin, glm::vec3 dir)
  *
  * @throws None.
  */
-bool Ray::intersectsBoundingRegion(BoundingRegion br, float& tmin, float& tmax) {
+bool Ray::intersectsBoundingRegion(const BoundingRegion& br, float& tmin, float& tmax) {
 	if (br.type == BoundTypes::AABB) {
-		// slab algorithm
-		tmin = std::numeric_limits<float>::lowest(); // maxOfMin
-		tmax = std::numeric_limits<float>::max(); // minOfMax
-
-		for (int i = 0; i < 3; i++) {
-			float t1 = (br.min[i] - origin[i]) * invdir[i];
-			float t2 = (br.max[i] - origin[i]) * invdir[i];
-
-			tmin = std::fmaxf(tmin, std::fminf(t1, t2));
-			tmax = std::fminf(tmax, std::fmaxf(t1, t2));
-		}
-
-		return (tmax >= tmin) && tmax >= 0.0f;
+		return intersectsBox(br.min, br.max, tmin, tmax);
 	}
 	else {
 		// ray-sphere collision
@@ -74,6 +64,31 @@ bool Ray::intersectsBoundingRegion(BoundingRegion br, float& tmin, float& tmax)
 	}
 }
 
+/**
+ * Check if the ray intersects with a box (slab algorithm).
+ *
+ * @param min The minimum corner of the box.
+ * @param max The maximum corner of the box.
+ * @param tmin The distance the ray enters the box.
+ * @param tmax The distance the ray leaves the box.
+ *
+ * @return True if the ray intersects with the box in front of the origin, false otherwise.
+ */
+bool Ray::intersectsBox(const glm::vec3& min, const glm::vec3& max, float& tmin, float& tmax) {
+	tmin = std::numeric_limits<float>::lowest(); // maxOfMin
+	tmax = std::numeric_limits<float>::max(); // minOfMax
+
+	for (int i = 0; i < 3; i++) {
+		float t1 = (min[i] - origin[i]) * invdir[i];
+		float t2 = (max[i] - origin[i]) * invdir[i];
+
+		tmin = std::fmaxf(tmin, std::fminf(t1, t2));
+		tmax = std::fminf(tmax, std::fmaxf(t1, t2));
+	}
+
+	return (tmax >= tmin) && tmax >= 0.0f;
+}
+
 /**
  * Check if a ray intersects a collision mesh.
  *
@@ -84,35 +99,82 @@ bool Ray::intersectsBoundingRegion(BoundingRegion br, float& tmin, float& tmax)
  * @return True if the ray intersects the mesh, false otherwise.
  */
 bool Ray::intersectsMesh(CollisionMesh* mesh, RigidBody* rb, float& t) {
+	int faceIdx = -1;
+	return intersectsMesh(mesh, rb, t, faceIdx);
+}
+
+/**
+ * Check if a ray intersects a collision mesh and find the face it hits first.
+ *
+ * @param mesh The collision mesh to check against.
+ * @param rb The rigid body associated with the mesh.
+ * @param t The distance from the origin to the intersection point (output parameter, only closer hits are accepted).
+ * @param faceIdx The index of the closest face hit (output parameter).
+ *
+ * @return True if the ray intersects the mesh closer than t, false otherwise.
+ */
+bool Ray::intersectsMesh(CollisionMesh* mesh, RigidBody* rb, float& t, int& faceIdx) {
 	bool intersects = false;
 
-	for (Face& f : mesh->faces) {
-		float tmp = -1.0f;
-		glm::vec3 P1 = mat4vec3mult(rb->model, mesh->points[f.i1]);
-		glm::vec3 P2 = mat4vec3mult(rb->model, mesh->points[f.i2]) - P1;
-		glm::vec3 P3 = mat4vec3mult(rb->model, mesh->points[f.i3]) - P1;
-		glm::vec3 norm = rb->normalModel * f.norm;
+	if (mesh->nodes.size() == 0) {
+		// no faces
+		return false;
+	}
 
-		glm::vec3 U1 = origin - P1;
+	WorldMesh& worldMesh = rb->getWorldMesh(mesh);
 
-		LinePlaneIntCase intCase = linePlaneIntersection(glm::vec3(0.0f), norm, U1, dir, tmp);
-	
-		if ((char)intCase > 1) {
-			// intersection with the inifinite plane at one point
-			if (tmp < 0.0f || t < tmp) {
-				// collision happens behind the origin
-				// or have found a closer collision
+	float tmin = 0.0f, tmax = 0.0f;
+	if (!intersectsBox(worldMesh.mins[0], worldMesh.maxs[0], tmin, tmax) || t < tmin) {
+		// missed the whole mesh
+		return false;
+	}
 
-				continue;
-			}
+	// nodes of the face tree to visit with the distance the ray enters them
+	std::vector<std::pair<unsigned int, float>> stack;
+	stack.push_back({ 0, tmin });
+
+	while (stack.size() != 0) {
+		unsigned int idx = stack.back().first;
+		float entry = stack.back().second;
+		stack.pop_back();
 
-			// get point of intersection
-			glm::vec3 intersection = U1 + tmp * dir;
+		if (t < entry) {
+			// found a closer collision
+			continue;
+		}
 
-			if (faceContainsPoint(P2, P3, norm, intersection)) {
-				intersects = true;
-				t = fminf(t, tmp);
+		FaceNode& n = mesh->nodes[idx];
+		if (n.left != 0) {
+			// visit the child the ray enters first before the other one
+			float tLeft = 0.0f, tRight = 0.0f;
+			bool hitLeft = intersectsBox(worldMesh.mins[n.left], worldMesh.maxs[n.left], tLeft, tmax) && tLeft <= t;
+			bool hitRight = intersectsBox(worldMesh.mins[n.left + 1], worldMesh.maxs[n.left + 1], tRight, tmax) && tRight <= t;
+
+			if (hitLeft && hitRight) {
+				if (tLeft <= tRight) {
+					stack.push_back({ n.left + 1, tRight });
+					stack.push_back({ n.left, tLeft });
+				}
+				else {
+					stack.push_back({ n.left, tLeft });
+					stack.push_back({ n.left + 1, tRight });
+				}
+			}
+			else if (hitLeft) {
+				stack.push_back({ n.left, tLeft });
 			}
+			else if (hitRight) {
+				stack.push_back({ n.left + 1, tRight });
+			}
+
+			continue;
+		}
+
+		// leaf, check faces a vector at a time
+		int hit = SIMD::rayIntersectsTriangles(*this, worldMesh, n.firstFace, n.noFaces, t);
+		if (hit != -1) {
+			intersects = true;
+			faceIdx = hit;
 		}
 	}
 
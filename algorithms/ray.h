@@ -16,6 +16,35 @@
 #include "../physics/collisionmesh.h"
 #include "../physics/rigidbody.h"
 
+/*
+	enum for ray query modes
+*/
+
+enum class RayQuery : unsigned char {
+	CLOSEST	= 0x00,	// nearest hit per ray (picking)
+	ANY		= 0x01,	// first hit found per ray (line of sight)
+	ALL		= 0x02	// every hit per ray
+};
+
+/*
+	struct to represent a ray hitting an instance
+*/
+
+struct RayHit {
+	// index of ray in the packet
+	unsigned int ray;
+
+	// instance and region hit (region is only valid until the octree is next updated)
+	RigidBody* instance;
+	BoundingRegion* region;
+
+	// distance along ray (in lengths of dir)
+	float t;
+
+	// index of face hit in the collision mesh (-1 if region has no mesh)
+	int face;
+};
+
 class Ray {
 public:
 	glm::vec3 origin;
@@ -24,8 +53,10 @@ public:
 
 	Ray(glm::vec3 origin, glm::vec3 dir);
 
-	bool intersectsBoundingRegion(BoundingRegion br, float &tmin, float &tmax);
+	bool intersectsBoundingRegion(const BoundingRegion& br, float &tmin, float &tmax);
+	bool intersectsBox(const glm::vec3& min, const glm::vec3& max, float &tmin, float &tmax);
 	bool intersectsMesh(CollisionMesh* mesh, RigidBody* rb, float &t);
+	bool intersectsMesh(CollisionMesh* mesh, RigidBody* rb, float &t, int &faceIdx);
 };
 
 #endif
\ No newline at end of file
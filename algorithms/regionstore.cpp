@@ -0,0 +1,249 @@
+/*****************************************************************
+ *   Author: Tyanna Prince
+ *   Date: 07/15/2023
+ *   Description: An enhancement of my cs330 OpenGL project where I added functionality such as charater movement,
+ *  directional lighting, and shadow mapping, a cubemap, and joystick support.
+ *  copyright (c) 2023 Tyanna Prince
+ *  version 2.0
+ *****************************************************************/
+
+#include "regionstore.h"
+
+#include <algorithm>
+
+/*
+    modifiers
+*/
+
+// remove all regions
+void RegionStore::clear() {
+    types.clear();
+    mins.clear();
+    maxs.clear();
+    spheres.clear();
+    cold.clear();
+    live.clear();
+
+    instanceRegions.clear();
+    freeHandles.clear();
+}
+
+// allocate memory for regions
+void RegionStore::reserve(unsigned int noRegions) {
+    types.reserve(noRegions);
+    mins.reserve(noRegions);
+    maxs.reserve(noRegions);
+    spheres.reserve(noRegions);
+    cold.reserve(noRegions);
+    live.reserve(noRegions);
+}
+
+// add region to the end of the arrays
+RegionHandle RegionStore::add(const BoundingRegion& br) {
+    RegionHandle ret = types.size();
+
+    types.push_back(br.type);
+    mins.push_back(glm::vec3(0.0f));
+    maxs.push_back(glm::vec3(0.0f));
+    spheres.push_back(glm::vec4(0.0f));
+    cold.push_back(coldData());
+    live.push_back(true);
+
+    set(ret, br);
+    return ret;
+}
+
+// replace contents with a list of regions
+void RegionStore::assign(const std::vector<BoundingRegion>& regionList) {
+    clear();
+    reserve(regionList.size());
+    for (const BoundingRegion& br : regionList) {
+        add(br);
+    }
+}
+
+// update to a list of regions, keeping the handles of regions already stored
+void RegionStore::sync(const std::vector<BoundingRegion>& regionList) {
+    seen.assign(size(), false);
+
+    for (const BoundingRegion& br : regionList) {
+        // find the handle of the same region of the instance (regions may come in any order)
+        std::vector<RegionHandle>& handles = instanceRegions[br.instance];
+        bool found = false;
+        for (RegionHandle h : handles) {
+            if (!seen[h] && sameSource(h, br)) {
+                set(h, br);
+                seen[h] = true;
+                found = true;
+                break;
+            }
+        }
+
+        if (!found) {
+            // new region
+            RegionHandle h = acquire(br);
+            handles.push_back(h);
+            if (h >= seen.size()) {
+                seen.resize(h + 1, false);
+            }
+            seen[h] = true;
+        }
+    }
+
+    // free the handles of regions no longer in the list
+    for (auto it = instanceRegions.begin(); it != instanceRegions.end();) {
+        std::vector<RegionHandle>& handles = it->second;
+        for (unsigned int i = 0; i < handles.size();) {
+            if (seen[handles[i]]) {
+                i++;
+                continue;
+            }
+
+            live[handles[i]] = false;
+            freeHandles.push_back(handles[i]);
+            handles[i] = handles.back();
+            handles.pop_back();
+        }
+
+        if (handles.size() == 0) {
+            it = instanceRegions.erase(it);
+        }
+        else {
+            it++;
+        }
+    }
+}
+
+// overwrite region at handle
+void RegionStore::set(RegionHandle h, const BoundingRegion& br) {
+    types[h] = br.type;
+    if (br.type == BoundTypes::AABB) {
+        mins[h] = br.min;
+        maxs[h] = br.max;
+        spheres[h] = glm::vec4(0.0f);
+    }
+    else {
+        mins[h] = br.center - glm::vec3(br.radius);
+        maxs[h] = br.center + glm::vec3(br.radius);
+        spheres[h] = glm::vec4(br.center, br.radius);
+    }
+
+    coldData& c = cold[h];
+    c.instance = br.instance;
+    c.collisionMesh = br.collisionMesh;
+    c.cell = br.cell;
+    c.cellIdx = br.cellIdx;
+    c.ogCenter = br.ogCenter;
+    c.ogRadius = br.ogRadius;
+    c.ogMin = br.ogMin;
+    c.ogMax = br.ogMax;
+}
+
+/*
+    accessors
+*/
+
+// number of handles (including freed ones)
+unsigned int RegionStore::size() const {
+    return types.size();
+}
+
+// determine if handle is in use
+bool RegionStore::isLive(RegionHandle h) const {
+    return h < live.size() && live[h];
+}
+
+// rebuild full region at handle
+BoundingRegion RegionStore::get(RegionHandle h) const {
+    BoundingRegion ret(types[h]);
+
+    if (types[h] == BoundTypes::AABB) {
+        ret.min = mins[h];
+        ret.max = maxs[h];
+    }
+    else {
+        ret.center = glm::vec3(spheres[h]);
+        ret.radius = spheres[h].w;
+    }
+
+    const coldData& c = cold[h];
+    ret.instance = c.instance;
+    ret.collisionMesh = c.collisionMesh;
+    ret.cell = c.cell;
+    ret.cellIdx = c.cellIdx;
+    ret.ogCenter = c.ogCenter;
+    ret.ogRadius = c.ogRadius;
+    ret.ogMin = c.ogMin;
+    ret.ogMax = c.ogMax;
+
+    return ret;
+}
+
+// center of region at handle
+glm::vec3 RegionStore::calculateCenter(RegionHandle h) const {
+    return (mins[h] + maxs[h]) / 2.0f;
+}
+
+// determine if regions at handles intersect (only reads hot data)
+bool RegionStore::intersects(RegionHandle h1, RegionHandle h2) const {
+    // boxes must overlap on all axes (also rejects most sphere pairs)
+    for (int i = 0; i < 3; i++) {
+        if (mins[h1][i] > maxs[h2][i] || mins[h2][i] > maxs[h1][i]) {
+            return false;
+        }
+    }
+
+    if (types[h1] == BoundTypes::AABB && types[h2] == BoundTypes::AABB) {
+        // both boxes
+        return true;
+    }
+    else if (types[h1] == BoundTypes::SPHERE && types[h2] == BoundTypes::SPHERE) {
+        // both spheres - distance between centers must be less than combined radius
+        glm::vec3 centerDiff = glm::vec3(spheres[h1]) - glm::vec3(spheres[h2]);
+        float maxMag = spheres[h1].w + spheres[h2].w;
+        return glm::dot(centerDiff, centerDiff) <= maxMag * maxMag;
+    }
+    else {
+        // one sphere, one box
+        RegionHandle sphere = types[h1] == BoundTypes::SPHERE ? h1 : h2;
+        RegionHandle box = sphere == h1 ? h2 : h1;
+
+        glm::vec3 center = glm::vec3(spheres[sphere]);
+        glm::vec3 closestPt = glm::clamp(center, mins[box], maxs[box]);
+        glm::vec3 dist = closestPt - center;
+        return glm::dot(dist, dist) < spheres[sphere].w * spheres[sphere].w;
+    }
+}
+
+/*
+    private methods
+*/
+
+// get an unused handle for a region
+RegionHandle RegionStore::acquire(const BoundingRegion& br) {
+    if (freeHandles.size() == 0) {
+        return add(br);
+    }
+
+    RegionHandle ret = freeHandles.back();
+    freeHandles.pop_back();
+    live[ret] = true;
+    set(ret, br);
+    return ret;
+}
+
+// determine if handle stores the region br was transformed from
+bool RegionStore::sameSource(RegionHandle h, const BoundingRegion& br) const {
+    const coldData& c = cold[h];
+    if (types[h] != br.type || c.collisionMesh != br.collisionMesh) {
+        return false;
+    }
+
+    // only the untransformed values of the type are set
+    if (br.type == BoundTypes::AABB) {
+        return c.ogMin == br.ogMin && c.ogMax == br.ogMax;
+    }
+    else {
+        return c.ogCenter == br.ogCenter && c.ogRadius == br.ogRadius;
+    }
+}
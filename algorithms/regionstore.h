@@ -0,0 +1,133 @@
+/*****************************************************************
+ *   Author: Tyanna Prince
+ *   Date: 07/15/2023
+ *   Description: An enhancement of my cs330 OpenGL project where I added functionality such as charater movement,
+ *  directional lighting, and shadow mapping, a cubemap, and joystick support.
+ *  copyright (c) 2023 Tyanna Prince
+ *  version 2.0
+ *****************************************************************/
+
+#ifndef REGIONSTORE_H
+#define REGIONSTORE_H
+
+#include <unordered_map>
+#include <vector>
+
+#include <glm/glm.hpp>
+
+#include "bounds.h"
+
+// index of a region in a region store
+typedef unsigned int RegionHandle;
+
+/*
+    class to store bounding regions as a structure of arrays
+
+    - hot data (current bounds) is packed in parallel arrays so overlap tests
+      only pull the bytes they compare through the cache
+    - cold data (original bounds and pointers) lives in a side table that is
+      only read once an overlap has been found
+    - sync keeps the handle of each region of an instance between frames (freed
+      handles are reused), so stages can keep per-handle state sorted
+*/
+
+class RegionStore {
+public:
+    /*
+        struct to represent the fields of a region that overlap tests do not read
+    */
+    struct coldData {
+        // pointers for quick access to instance and collision mesh
+        RigidBody* instance;
+        CollisionMesh* collisionMesh;
+
+        // pointer to octree node and index in its object list
+        Octree::node* cell;
+        unsigned int cellIdx;
+
+        // untransformed values
+        glm::vec3 ogCenter;
+        float ogRadius;
+        glm::vec3 ogMin;
+        glm::vec3 ogMax;
+    };
+
+    /*
+        hot data (parallel arrays)
+    */
+
+    // type of each region
+    std::vector<BoundTypes> types;
+    // lower and upper bounds along each axis (box around the sphere for spheres)
+    std::vector<glm::vec3> mins;
+    std::vector<glm::vec3> maxs;
+    // center and radius (w) of spheres
+    std::vector<glm::vec4> spheres;
+
+    /*
+        cold data
+    */
+
+    // remaining fields of each region
+    std::vector<coldData> cold;
+
+    // if the handle is in use (false once freed by sync)
+    std::vector<bool> live;
+
+    /*
+        modifiers
+    */
+
+    // remove all regions
+    void clear();
+
+    // allocate memory for regions
+    void reserve(unsigned int noRegions);
+
+    // add region to the end of the arrays
+    RegionHandle add(const BoundingRegion& br);
+
+    // replace contents with a list of regions (new handles for every region)
+    void assign(const std::vector<BoundingRegion>& regionList);
+
+    // update to a list of regions, keeping the handles of regions already stored
+    void sync(const std::vector<BoundingRegion>& regionList);
+
+    // overwrite region at handle
+    void set(RegionHandle h, const BoundingRegion& br);
+
+    /*
+        accessors
+    */
+
+    // number of handles (including freed ones)
+    unsigned int size() const;
+
+    // determine if handle is in use
+    bool isLive(RegionHandle h) const;
+
+    // rebuild full region at handle
+    BoundingRegion get(RegionHandle h) const;
+
+    // center of region at handle
+    glm::vec3 calculateCenter(RegionHandle h) const;
+
+    // determine if regions at handles intersect (only reads hot data)
+    bool intersects(RegionHandle h1, RegionHandle h2) const;
+
+private:
+    // handles of the regions of each instance
+    std::unordered_map<RigidBody*, std::vector<RegionHandle>> instanceRegions;
+    // freed handles to reuse
+    std::vector<RegionHandle> freeHandles;
+    // handles found in the list being synced
+    std::vector<bool> seen;
+
+    // get an unused handle for a region
+    RegionHandle acquire(const BoundingRegion& br);
+
+    // determine if handle stores the region br was transformed from
+    bool sameSource(RegionHandle h, const BoundingRegion& br) const;
+};
+
+#endif
@@ -0,0 +1,420 @@
+/*****************************************************************
+ *   Author: Tyanna Prince
+ *   Date: 07/15/2023
+ *   Description: An enhancement of my cs330 OpenGL project where I added functionality such as charater movement,
+ *  directional lighting, and shadow mapping, a cubemap, and joystick support.
+ *  copyright (c) 2023 Tyanna Prince
+ *  version 2.0
+ *****************************************************************/
+
+#include "simd.h"
+#include "stats.h"
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+
+/*
+    lane operations for each instruction set
+    - every kernel is written once in terms of these
+*/
+
+#if defined(SIMD_AVX2)
+
+#include <immintrin.h>
+
+typedef __m256 vfloat;
+typedef __m256 vmask;
+
+static inline vfloat vload(const float* p) { return _mm256_loadu_ps(p); }
+static inline void vstore(float* p, vfloat v) { _mm256_storeu_ps(p, v); }
+static inline vfloat vset(float f) { return _mm256_set1_ps(f); }
+static inline vfloat vadd(vfloat a, vfloat b) { return _mm256_add_ps(a, b); }
+static inline vfloat vsub(vfloat a, vfloat b) { return _mm256_sub_ps(a, b); }
+static inline vfloat vmul(vfloat a, vfloat b) { return _mm256_mul_ps(a, b); }
+static inline vfloat vdiv(vfloat a, vfloat b) { return _mm256_div_ps(a, b); }
+static inline vfloat vmin(vfloat a, vfloat b) { return _mm256_min_ps(a, b); }
+static inline vfloat vmax(vfloat a, vfloat b) { return _mm256_max_ps(a, b); }
+static inline vfloat vsqrt(vfloat a) { return _mm256_sqrt_ps(a); }
+static inline vfloat vabs(vfloat a) { return _mm256_andnot_ps(_mm256_set1_ps(-0.0f), a); }
+static inline vmask vle(vfloat a, vfloat b) { return _mm256_cmp_ps(a, b, _CMP_LE_OQ); }
+static inline vmask vlt(vfloat a, vfloat b) { return _mm256_cmp_ps(a, b, _CMP_LT_OQ); }
+static inline vmask vge(vfloat a, vfloat b) { return _mm256_cmp_ps(a, b, _CMP_GE_OQ); }
+static inline vmask vgt(vfloat a, vfloat b) { return _mm256_cmp_ps(a, b, _CMP_GT_OQ); }
+static inline vmask vand(vmask a, vmask b) { return _mm256_and_ps(a, b); }
+static inline vmask vor(vmask a, vmask b) { return _mm256_or_ps(a, b); }
+static inline vmask vtrue() { return _mm256_castsi256_ps(_mm256_set1_epi32(-1)); }
+static inline vmask vnot(vmask a) { return _mm256_xor_ps(a, vtrue()); }
+static inline unsigned int vbits(vmask m) { return (unsigned int)_mm256_movemask_ps(m); }
+
+#elif defined(SIMD_SSE2)
+
+#include <emmintrin.h>
+
+typedef __m128 vfloat;
+typedef __m128 vmask;
+
+static inline vfloat vload(const float* p) { return _mm_loadu_ps(p); }
+static inline void vstore(float* p, vfloat v) { _mm_storeu_ps(p, v); }
+static inline vfloat vset(float f) { return _mm_set1_ps(f); }
+static inline vfloat vadd(vfloat a, vfloat b) { return _mm_add_ps(a, b); }
+static inline vfloat vsub(vfloat a, vfloat b) { return _mm_sub_ps(a, b); }
+static inline vfloat vmul(vfloat a, vfloat b) { return _mm_mul_ps(a, b); }
+static inline vfloat vdiv(vfloat a, vfloat b) { return _mm_div_ps(a, b); }
+static inline vfloat vmin(vfloat a, vfloat b) { return _mm_min_ps(a, b); }
+static inline vfloat vmax(vfloat a, vfloat b) { return _mm_max_ps(a, b); }
+static inline vfloat vsqrt(vfloat a) { return _mm_sqrt_ps(a); }
+static inline vfloat vabs(vfloat a) { return _mm_andnot_ps(_mm_set1_ps(-0.0f), a); }
+static inline vmask vle(vfloat a, vfloat b) { return _mm_cmple_ps(a, b); }
+static inline vmask vlt(vfloat a, vfloat b) { return _mm_cmplt_ps(a, b); }
+static inline vmask vge(vfloat a, vfloat b) { return _mm_cmpge_ps(a, b); }
+static inline vmask vgt(vfloat a, vfloat b) { return _mm_cmpgt_ps(a, b); }
+static inline vmask vand(vmask a, vmask b) { return _mm_and_ps(a, b); }
+static inline vmask vor(vmask a, vmask b) { return _mm_or_ps(a, b); }
+static inline vmask vtrue() { return _mm_castsi128_ps(_mm_set1_epi32(-1)); }
+static inline vmask vnot(vmask a) { return _mm_xor_ps(a, vtrue()); }
+static inline unsigned int vbits(vmask m) { return (unsigned int)_mm_movemask_ps(m); }
+
+#else
+
+// scalar fallback (one lane)
+typedef float vfloat;
+typedef bool vmask;
+
+static inline vfloat vload(const float* p) { return *p; }
+static inline void vstore(float* p, vfloat v) { *p = v; }
+static inline vfloat vset(float f) { return f; }
+static inline vfloat vadd(vfloat a, vfloat b) { return a + b; }
+static inline vfloat vsub(vfloat a, vfloat b) { return a - b; }
+static inline vfloat vmul(vfloat a, vfloat b) { return a * b; }
+static inline vfloat vdiv(vfloat a, vfloat b) { return a / b; }
+static inline vfloat vmin(vfloat a, vfloat b) { return std::fminf(a, b); }
+static inline vfloat vmax(vfloat a, vfloat b) { return std::fmaxf(a, b); }
+static inline vfloat vsqrt(vfloat a) { return sqrtf(a); }
+static inline vfloat vabs(vfloat a) { return std::fabs(a); }
+static inline vmask vle(vfloat a, vfloat b) { return a <= b; }
+static inline vmask vlt(vfloat a, vfloat b) { return a < b; }
+static inline vmask vge(vfloat a, vfloat b) { return a >= b; }
+static inline vmask vgt(vfloat a, vfloat b) { return a > b; }
+static inline vmask vand(vmask a, vmask b) { return a && b; }
+static inline vmask vor(vmask a, vmask b) { return a || b; }
+static inline vmask vtrue() { return true; }
+static inline vmask vnot(vmask a) { return !a; }
+static inline unsigned int vbits(vmask m) { return m ? 1 : 0; }
+
+#endif
+
+/*
+    batch
+*/
+
+// transpose count (at most SIMD_BATCH) regions into the batch
+void SIMD::batch::load(const BoundingRegion* regions, unsigned int count) {
+    this->count = count;
+    sphereMask = 0;
+
+    unsigned int i = 0;
+    for (; i < count; i++) {
+        const BoundingRegion& br = regions[i];
+
+        // selects instead of branches, so mixed types do not stall the loop
+        bool isSphere = br.type == BoundTypes::SPHERE;
+        sphereMask |= (unsigned int)isSphere << i;
+
+        float r = isSphere ? br.radius : 0.0f;
+        for (int j = 0; j < 3; j++) {
+            float c = isSphere ? br.center[j] : 0.0f;
+            min[j][i] = isSphere ? c - r : br.min[j];
+            max[j][i] = isSphere ? c + r : br.max[j];
+            center[j][i] = c;
+        }
+        radius[i] = r;
+    }
+
+    // unused lanes hold zeros so they never produce NaNs (their bits are masked off)
+    for (; i < SIMD_BATCH; i++) {
+        for (int j = 0; j < 3; j++) {
+            min[j][i] = max[j][i] = center[j][i] = 0.0f;
+        }
+        radius[i] = 0.0f;
+    }
+}
+
+// mask with a bit for each region loaded
+unsigned int SIMD::batch::calculateMask() const {
+    return count >= 32 ? 0xffffffff : (1u << count) - 1;
+}
+
+/*
+    kernels
+*/
+
+// transpose a list of regions into consecutive batches appended to the list of batches
+void SIMD::loadBatches(const BoundingRegion* regions, unsigned int count, std::vector<batch>& batches) {
+    for (unsigned int i = 0; i < count; i += SIMD_BATCH) {
+        batches.emplace_back();
+        batches.back().load(regions + i, std::min<unsigned int>(count - i, SIMD_BATCH));
+    }
+}
+
+// determine which regions in the batch intersect the query (BoundingRegion::intersectsWith)
+unsigned int SIMD::intersectsRegions(const BoundingRegion& query, const batch& b) {
+    unsigned int laneMask = b.calculateMask();
+    unsigned int boxMask = laneMask & ~b.sphereMask;
+    unsigned int sphereMask = laneMask & b.sphereMask;
+    unsigned int ret = 0;
+
+    Stats::noCoarseTests += b.count;
+
+    for (unsigned int i = 0; i < b.count; i += SIMD_WIDTH) {
+        unsigned int laneBits = 0;
+        unsigned int chunkBoxes = (boxMask >> i) & ((1u << SIMD_WIDTH) - 1);
+        unsigned int chunkSpheres = (sphereMask >> i) & ((1u << SIMD_WIDTH) - 1);
+
+        if (query.type == BoundTypes::AABB) {
+            if (chunkBoxes) {
+                // both boxes - distance between centers must be within combined half dimensions on each axis
+                vmask hit = vtrue();
+                for (int j = 0; j < 3; j++) {
+                    vfloat min = vload(&b.min[j][i]);
+                    vfloat max = vload(&b.max[j][i]);
+                    vfloat rad = vdiv(vsub(max, min), vset(2.0f));
+                    vfloat center = vdiv(vadd(min, max), vset(2.0f));
+
+                    float radQuery = (query.max[j] - query.min[j]) / 2.0f;
+                    float centerQuery = (query.min[j] + query.max[j]) / 2.0f;
+
+                    vfloat dist = vabs(vsub(center, vset(centerQuery)));
+                    hit = vand(hit, vnot(vgt(dist, vadd(rad, vset(radQuery)))));
+                }
+                laneBits |= vbits(hit) & chunkBoxes;
+            }
+
+            if (chunkSpheres) {
+                // region is a sphere, query is a box - distance to closest point in box must be less than radius
+                vfloat distSquared = vset(0.0f);
+                for (int j = 0; j < 3; j++) {
+                    vfloat center = vload(&b.center[j][i]);
+                    vfloat closestPt = vmax(vset(query.min[j]), vmin(center, vset(query.max[j])));
+                    vfloat d = vsub(closestPt, center);
+                    distSquared = vadd(distSquared, vmul(d, d));
+                }
+                vfloat radius = vload(&b.radius[i]);
+                laneBits |= vbits(vlt(distSquared, vmul(radius, radius))) & chunkSpheres;
+            }
+        }
+        else {
+            if (chunkSpheres) {
+                // both spheres - distance between centers must be less than combined radius
+                vfloat distSquared = vset(0.0f);
+                for (int j = 0; j < 3; j++) {
+                    vfloat d = vsub(vload(&b.center[j][i]), vset(query.center[j]));
+                    distSquared = vadd(distSquared, vmul(d, d));
+                }
+                vfloat maxMagSquared = vadd(vload(&b.radius[i]), vset(query.radius));
+                maxMagSquared = vmul(maxMagSquared, maxMagSquared);
+                laneBits |= vbits(vle(distSquared, maxMagSquared)) & chunkSpheres;
+            }
+
+            if (chunkBoxes) {
+                // region is a box, query is a sphere - distance to closest point in box must be less than radius
+                vfloat distSquared = vset(0.0f);
+                for (int j = 0; j < 3; j++) {
+                    vfloat closestPt = vmax(vload(&b.min[j][i]), vmin(vset(query.center[j]), vload(&b.max[j][i])));
+                    vfloat d = vsub(closestPt, vset(query.center[j]));
+                    distSquared = vadd(distSquared, vmul(d, d));
+                }
+                laneBits |= vbits(vlt(distSquared, vset(query.radius * query.radius))) & chunkBoxes;
+            }
+        }
+
+        ret |= laneBits << i;
+    }
+
+    return ret;
+}
+
+// determine which regions in the batch completely contain the query (BoundingRegion::containsRegion, boxes only)
+unsigned int SIMD::containedInRegions(const BoundingRegion& query, const batch& b) {
+    unsigned int boxMask = b.calculateMask() & ~b.sphereMask;
+    unsigned int ret = 0;
+
+    for (unsigned int i = 0; i < b.count; i += SIMD_WIDTH) {
+        unsigned int chunkBoxes = (boxMask >> i) & ((1u << SIMD_WIDTH) - 1);
+        if (!chunkBoxes) {
+            continue;
+        }
+
+        vmask inside = vtrue();
+        for (int j = 0; j < 3; j++) {
+            vfloat min = vload(&b.min[j][i]);
+            vfloat max = vload(&b.max[j][i]);
+
+            if (query.type == BoundTypes::AABB) {
+                // box just has to contain min and max
+                vfloat qMin = vset(query.min[j]);
+                vfloat qMax = vset(query.max[j]);
+                inside = vand(inside, vand(vand(vge(qMin, min), vle(qMin, max)), vand(vge(qMax, min), vle(qMax, max))));
+            }
+            else {
+                // center inside, and distance to each side at least the radius
+                vfloat center = vset(query.center[j]);
+                vfloat radius = vset(query.radius);
+                inside = vand(inside, vand(vge(center, min), vle(center, max)));
+                inside = vand(inside, vand(vnot(vlt(vabs(vsub(max, center)), radius)), vnot(vlt(vabs(vsub(center, min)), radius))));
+            }
+        }
+
+        ret |= (vbits(inside) & chunkBoxes) << i;
+    }
+
+    return ret;
+}
+
+// determine which regions in the batch the ray hits, with entry/exit distances of each (Ray::intersectsBoundingRegion)
+unsigned int SIMD::rayIntersectsRegions(const Ray& r, const batch& b, float* tmin, float* tmax) {
+    unsigned int laneMask = b.calculateMask();
+    unsigned int boxMask = laneMask & ~b.sphereMask;
+    unsigned int sphereMask = laneMask & b.sphereMask;
+    unsigned int ret = 0;
+
+    // coefficient of the quadratic shared by every sphere
+    float a = r.dir.x * r.dir.x + r.dir.y * r.dir.y + r.dir.z * r.dir.z;
+
+    alignas(32) float tminLanes[SIMD_WIDTH];
+    alignas(32) float tmaxLanes[SIMD_WIDTH];
+
+    for (unsigned int i = 0; i < b.count; i += SIMD_WIDTH) {
+        unsigned int chunkBoxes = (boxMask >> i) & ((1u << SIMD_WIDTH) - 1);
+        unsigned int chunkSpheres = (sphereMask >> i) & ((1u << SIMD_WIDTH) - 1);
+
+        if (chunkBoxes) {
+            // slab algorithm
+            vfloat tminBox = vset(std::numeric_limits<float>::lowest());
+            vfloat tmaxBox = vset(std::numeric_limits<float>::max());
+            for (int j = 0; j < 3; j++) {
+                vfloat t1 = vmul(vsub(vload(&b.min[j][i]), vset(r.origin[j])), vset(r.invdir[j]));
+                vfloat t2 = vmul(vsub(vload(&b.max[j][i]), vset(r.origin[j])), vset(r.invdir[j]));
+
+                tminBox = vmax(tminBox, vmin(t1, t2));
+                tmaxBox = vmin(tmaxBox, vmax(t1, t2));
+            }
+
+            unsigned int hits = vbits(vand(vge(tmaxBox, tminBox), vge(tmaxBox, vset(0.0f)))) & chunkBoxes;
+            ret |= hits << i;
+
+            vstore(tminLanes, tminBox);
+            vstore(tmaxLanes, tmaxBox);
+            for (unsigned int j = 0; j < SIMD_WIDTH; j++) {
+                if (hits & (1 << j)) {
+                    tmin[i + j] = tminLanes[j];
+                    tmax[i + j] = tmaxLanes[j];
+                }
+            }
+        }
+
+        if (chunkSpheres) {
+            // roots of the quadratic from plugging the ray into the sphere equation
+            vfloat cpDotDir = vset(0.0f);
+            vfloat cpMagSq = vset(0.0f);
+            for (int j = 0; j < 3; j++) {
+                vfloat cp = vsub(vset(r.origin[j]), vload(&b.center[j][i]));
+                cpDotDir = vadd(cpDotDir, vmul(vset(r.dir[j]), cp));
+                cpMagSq = vadd(cpMagSq, vmul(cp, cp));
+            }
+
+            vfloat radius = vload(&b.radius[i]);
+            vfloat bCoeff = vmul(vset(2.0f), cpDotDir);
+            vfloat cCoeff = vsub(cpMagSq, vmul(radius, radius));
+            vfloat D = vsub(vmul(bCoeff, bCoeff), vmul(vset(4.0f * a), cCoeff));
+
+            unsigned int hits = vbits(vnot(vlt(D, vset(0.0f)))) & chunkSpheres;
+            ret |= hits << i;
+
+            if (hits) {
+                // lanes with no real root are masked off
+                D = vsqrt(D);
+                vstore(tmaxLanes, vdiv(vadd(vsub(vset(0.0f), bCoeff), D), vset(2.0f * a)));
+                vstore(tminLanes, vdiv(vsub(vsub(vset(0.0f), bCoeff), D), vset(2.0f * a)));
+                for (unsigned int j = 0; j < SIMD_WIDTH; j++) {
+                    if (hits & (1 << j)) {
+                        tmin[i + j] = tminLanes[j];
+                        tmax[i + j] = tmaxLanes[j];
+                    }
+                }
+            }
+        }
+    }
+
+    return ret;
+}
+
+// dot product of vectors given one lane register per component
+static inline vfloat vdot(const vfloat* a, const vfloat* b) {
+    return vadd(vadd(vmul(a[0], b[0]), vmul(a[1], b[1])), vmul(a[2], b[2]));
+}
+
+// cross product of vectors given one lane register per component
+static inline void vcross(const vfloat* a, const vfloat* b, vfloat* out) {
+    out[0] = vsub(vmul(a[1], b[2]), vmul(a[2], b[1]));
+    out[1] = vsub(vmul(a[2], b[0]), vmul(a[0], b[2]));
+    out[2] = vsub(vmul(a[0], b[1]), vmul(a[1], b[0]));
+}
+
+// find the closest of count faces of a mesh in world space (from first) the ray hits closer than t (Moller-Trumbore)
+int SIMD::rayIntersectsTriangles(const Ray& r, const WorldMesh& mesh, unsigned int first, unsigned int count, float& t) {
+    int ret = -1;
+
+    vfloat dir[3] = { vset(r.dir.x), vset(r.dir.y), vset(r.dir.z) };
+    vfloat zero = vset(0.0f);
+    vfloat one = vset(1.0f);
+
+    alignas(32) float tLanes[SIMD_WIDTH];
+
+    for (unsigned int i = 0; i < count; i += SIMD_WIDTH) {
+        unsigned int idx = first + i;
+
+        // lanes past the range read padding or the next faces, so are masked off
+        unsigned int laneMask = count - i >= SIMD_WIDTH
+            ? (1u << SIMD_WIDTH) - 1
+            : (1u << (count - i)) - 1;
+
+        vfloat edge1[3], edge2[3], toOrigin[3];
+        for (int j = 0; j < 3; j++) {
+            edge1[j] = vload(&mesh.edges1[j][idx]);
+            edge2[j] = vload(&mesh.edges2[j][idx]);
+            toOrigin[j] = vsub(vset(r.origin[j]), vload(&mesh.corners[j][idx]));
+        }
+
+        // barycentric coordinates (u, v) and distance along the ray from Cramer's rule
+        vfloat p[3], q[3];
+        vcross(dir, edge2, p);
+        vcross(toOrigin, edge1, q);
+
+        vfloat det = vdot(edge1, p);
+        vfloat invDet = vdiv(one, det);
+        vfloat u = vmul(vdot(toOrigin, p), invDet);
+        vfloat v = vmul(vdot(dir, q), invDet);
+        vfloat tHit = vmul(vdot(edge2, q), invDet);
+
+        // parallel rays (and empty faces) have no determinant
+        vmask hit = vgt(vabs(det), zero);
+        hit = vand(hit, vand(vge(u, zero), vge(v, zero)));
+        hit = vand(hit, vle(vadd(u, v), one));
+        // in front of the origin and closer than the closest hit so far
+        hit = vand(hit, vand(vge(tHit, zero), vlt(tHit, vset(t))));
+
+        unsigned int hits = vbits(hit) & laneMask;
+        if (hits) {
+            vstore(tLanes, tHit);
+            for (unsigned int j = 0; j < SIMD_WIDTH; j++) {
+                if ((hits & (1 << j)) && tLanes[j] < t) {
+                    t = tLanes[j];
+                    ret = idx + j;
+                }
+            }
+        }
+    }
+
+    return ret;
+}
@@ -0,0 +1,92 @@
+/*****************************************************************
+ *   Author: Tyanna Prince
+ *   Date: 07/15/2023
+ *   Description: An enhancement of my cs330 OpenGL project where I added functionality such as charater movement,
+ *  directional lighting, and shadow mapping, a cubemap, and joystick support.
+ *  copyright (c) 2023 Tyanna Prince
+ *  version 2.0
+ *****************************************************************/
+
+#ifndef SIMD_H
+#define SIMD_H
+
+// lanes tested per instruction (AVX2 = 8, SSE2 = 4, scalar fallback = 1)
+#if defined(__AVX2__)
+#define SIMD_AVX2
+#define SIMD_WIDTH 8
+#elif defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define SIMD_SSE2
+#define SIMD_WIDTH 4
+#else
+#define SIMD_WIDTH 1
+#endif
+
+// regions tested against one query per kernel call (multiple of every SIMD_WIDTH)
+#define SIMD_BATCH 16
+
+#include <vector>
+
+#include <glm/glm.hpp>
+
+#include "bounds.h"
+#include "ray.h"
+
+// forward declaration
+class BoundingRegion;
+class Ray;
+
+/*
+    namespace to tie together the batched intersection kernels
+
+    - a batch holds up to SIMD_BATCH regions transposed into one array per component
+    - each kernel tests one query against every region in the batch and returns
+      a bitmask with bit i set if region i passed
+    - results match the scalar BoundingRegion and Ray tests
+    - the triangle kernel reads faces a mesh has already transposed (WorldMesh), so any
+      range of faces can be tested without building a batch
+*/
+
+namespace SIMD {
+    /*
+        struct to represent regions transposed for the kernels
+    */
+    struct batch {
+        // number of regions loaded
+        unsigned int count;
+
+        // bit i set if region i is a sphere
+        unsigned int sphereMask;
+
+        // bounds of each region (box around the sphere for spheres)
+        alignas(32) float min[3][SIMD_BATCH];
+        alignas(32) float max[3][SIMD_BATCH];
+
+        // center and radius of each sphere
+        alignas(32) float center[3][SIMD_BATCH];
+        alignas(32) float radius[SIMD_BATCH];
+
+        // transpose count (at most SIMD_BATCH) regions into the batch
+        void load(const BoundingRegion* regions, unsigned int count);
+
+        // mask with a bit for each region loaded
+        unsigned int calculateMask() const;
+    };
+
+    // transpose a list of regions into consecutive batches appended to the list of batches
+    void loadBatches(const BoundingRegion* regions, unsigned int count, std::vector<batch>& batches);
+
+    // determine which regions in the batch intersect the query (BoundingRegion::intersectsWith)
+    unsigned int intersectsRegions(const BoundingRegion& query, const batch& b);
+
+    // determine which regions in the batch completely contain the query (BoundingRegion::containsRegion, boxes only)
+    unsigned int containedInRegions(const BoundingRegion& query, const batch& b);
+
+    // determine which regions in the batch the ray hits, with entry/exit distances of each (Ray::intersectsBoundingRegion)
+    unsigned int rayIntersectsRegions(const Ray& r, const batch& b, float* tmin, float* tmax);
+
+    // find the closest of count faces of a mesh in world space (from first) the ray hits closer than t (Moller-Trumbore)
+    // - returns the index of the face and moves t to it, or -1 if none is closer
+    int rayIntersectsTriangles(const Ray& r, const WorldMesh& mesh, unsigned int first, unsigned int count, float& t);
+}
+
+#endif
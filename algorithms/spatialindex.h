@@ -0,0 +1,78 @@
+/*****************************************************************
+ *   Author: Tyanna Prince
+ *   Date: 07/15/2023
+ *   Description: An enhancement of my cs330 OpenGL project where I added functionality such as charater movement,
+ *  directional lighting, and shadow mapping, a cubemap, and joystick support.
+ *  copyright (c) 2023 Tyanna Prince
+ *  version 2.0
+ *****************************************************************/
+
+#ifndef SPATIALINDEX_H
+#define SPATIALINDEX_H
+
+#include <vector>
+
+#include "bounds.h"
+#include "frustum.h"
+#include "ray.h"
+#include "stats.h"
+
+// forward declaration
+class Model;
+class Box;
+class RigidBody;
+
+/*
+    base class for all spatial indices the scene can store its instances in
+
+    - instances are inserted through the pending queue, removed once their kill
+      switch is active, and refreshed during update once their moved switch is active
+    - pairs are generated during update when detectCollisions is set, otherwise
+      collectObjects feeds a separate broadphase stage
+    - when the scene keeps some models in a second index, each index also tests
+      its moved objects against the objects of its linkedIndex
+*/
+
+class SpatialIndex {
+public:
+    // if moved objects are tested for collisions during update
+    bool detectCollisions = true;
+
+    // other index the moved objects are also tested against (nullptr if the scene only uses one)
+    SpatialIndex* linkedIndex = nullptr;
+
+    // destructor
+    virtual ~SpatialIndex() {}
+
+    // add instance to pending queue
+    virtual void addToPending(RigidBody* instance, Model* model) = 0;
+
+    // process pending queue
+    virtual void processPending() = 0;
+
+    // update objects in index (called during each iteration of main loop)
+    virtual void update(Box& box) = 0;
+
+    // check collisions with a ray (only hits nearer than tmin)
+    virtual BoundingRegion* checkCollisionsRay(Ray r, float& tmin) = 0;
+
+    // check collisions between the object and every object in the index it overlaps
+    virtual void checkCollisionsRegion(const BoundingRegion& obj) = 0;
+
+    // find objects with a region intersecting the region (valid until the index is next updated)
+    virtual void queryRegion(const BoundingRegion& br, std::vector<BoundingRegion*>& found) = 0;
+
+    // find instances with a region inside the frustum
+    virtual void checkCollisionsFrustum(Frustum& frustum, std::vector<RigidBody*>& instances) = 0;
+
+    // copy all objects in the index into a list (objects still pending are left out)
+    virtual void collectObjects(std::vector<BoundingRegion>& objectList) = 0;
+
+    // add the index to the tree statistics
+    virtual void calculateStats(Stats::treeStats& stats) = 0;
+
+    // destroy object (free memory)
+    virtual void destroy() = 0;
+};
+
+#endif
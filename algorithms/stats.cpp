@@ -0,0 +1,58 @@
+/*****************************************************************
+ *   Author: Tyanna Prince
+ *   Date: 07/15/2023
+ *   Description: An enhancement of my cs330 OpenGL project where I added functionality such as charater movement,
+ *  directional lighting, and shadow mapping, a cubemap, and joystick support.
+ *  copyright (c) 2023 Tyanna Prince
+ *  version 2.0
+ *****************************************************************/
+
+#include "stats.h"
+
+/*
+    test counters
+*/
+
+unsigned int Stats::noCoarseTests = 0;
+unsigned int Stats::noFaceTests = 0;
+unsigned int Stats::noSphereTests = 0;
+unsigned int Stats::noConvexTests = 0;
+
+// reset test counters
+void Stats::resetCounters() {
+    noCoarseTests = 0;
+    noFaceTests = 0;
+    noSphereTests = 0;
+    noConvexTests = 0;
+}
+
+/*
+    tree statistics
+*/
+
+// add node to the statistics
+void Stats::treeStats::addNode(unsigned int depth, bool isLeaf, unsigned int noObjects, unsigned int noQueued) {
+    noNodes++;
+    noPending += noQueued;
+    if (depth > maxDepth) {
+        maxDepth = depth;
+    }
+
+    if (isLeaf) {
+        noLeaves++;
+        totalLeafDepth += depth;
+
+        // bin is the number of bits needed for the count
+        unsigned int bin = 0;
+        while (noObjects > 0 && bin < STATS_LEAF_BINS - 1) {
+            noObjects >>= 1;
+            bin++;
+        }
+        leafObjects[bin]++;
+    }
+}
+
+// mean depth of the leaves
+float Stats::treeStats::calculateMeanDepth() {
+    return noLeaves ? (float)totalLeafDepth / (float)noLeaves : 0.0f;
+}
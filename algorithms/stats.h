@@ -0,0 +1,64 @@
+/*****************************************************************
+ *   Author: Tyanna Prince
+ *   Date: 07/15/2023
+ *   Description: An enhancement of my cs330 OpenGL project where I added functionality such as charater movement,
+ *  directional lighting, and shadow mapping, a cubemap, and joystick support.
+ *  copyright (c) 2023 Tyanna Prince
+ *  version 2.0
+ *****************************************************************/
+
+#ifndef STATS_H
+#define STATS_H
+
+// leaves are binned by object count: 0, 1, 2-3, 4-7, 8-15, 16+
+#define STATS_LEAF_BINS 6
+
+/*
+    namespace to tie together statistics of the spatial and collision code
+*/
+
+namespace Stats {
+    /*
+        test counters (incremented by the tests on the main thread, reset by the scene each frame)
+    */
+
+    // BoundingRegion::intersectsWith calls
+    extern unsigned int noCoarseTests;
+    // Face::collidesWithFace calls
+    extern unsigned int noFaceTests;
+    // Face::collidesWithSphere calls
+    extern unsigned int noSphereTests;
+    // GJK::collide calls
+    extern unsigned int noConvexTests;
+
+    // reset test counters
+    void resetCounters();
+
+    /*
+        struct to describe the shape of an octree
+    */
+    struct treeStats {
+        // number of nodes/leaves
+        unsigned int noNodes = 0;
+        unsigned int noLeaves = 0;
+
+        // deepest node (root = 0)
+        unsigned int maxDepth = 0;
+        // sum of the depths of all leaves
+        unsigned int totalLeafDepth = 0;
+
+        // number of leaves in each object count bin
+        unsigned int leafObjects[STATS_LEAF_BINS] = {};
+
+        // objects waiting in pending queues
+        unsigned int noPending = 0;
+
+        // add node to the statistics
+        void addNode(unsigned int depth, bool isLeaf, unsigned int noObjects, unsigned int noQueued);
+
+        // mean depth of the leaves
+        float calculateMeanDepth();
+    };
+}
+
+#endif
@@ -0,0 +1,38 @@
+/*****************************************************************
+ *   Author: Tyanna Prince
+ *   Date: 07/15/2023
+ *   Description: An enhancement of my cs330 OpenGL project where I added functionality such as charater movement,
+ *  directional lighting, and shadow mapping, a cubemap, and joystick support.
+ *  copyright (c) 2023 Tyanna Prince
+ *  version 2.0
+ *****************************************************************/
+
+#ifndef BENCHMARKS_H
+#define BENCHMARKS_H
+
+#include <chrono>
+
+/*
+    namespace to tie together the benchmarks (benchmarks project, separate from the game)
+
+    - each benchmark checks the optimized path against the plain one on the same input
+      before timing both, and returns the number of mismatches (0 = passed)
+*/
+
+namespace Benchmarks {
+    // seconds since an arbitrary point (for differences)
+    inline double now() {
+        return std::chrono::duration<double>(std::chrono::steady_clock::now().time_since_epoch()).count();
+    }
+
+    // batched region kernels against the scalar BoundingRegion and Ray tests
+    unsigned int simd();
+
+    // pointer octree, linear octree and BVH on the same scene, against brute force
+    unsigned int spatialIndex();
+
+    // ray against triangle kernel and Ray::intersectsMesh against the plane-based test
+    unsigned int rayKernel();
+}
+
+#endif
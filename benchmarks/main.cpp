@@ -0,0 +1,54 @@
+/*****************************************************************
+ *   Author: Tyanna Prince
+ *   Date: 07/15/2023
+ *   Description: An enhancement of my cs330 OpenGL project where I added functionality such as charater movement,
+ *  directional lighting, and shadow mapping, a cubemap, and joystick support.
+ *  copyright (c) 2023 Tyanna Prince
+ *  version 2.0
+ *****************************************************************/
+
+#include <cstring>
+#include <iostream>
+
+#include "benchmarks.h"
+
+/*
+    benchmark list
+*/
+
+struct benchmark {
+    const char* name;
+    unsigned int (*run)();
+};
+
+static const benchmark benchmarks[] = {
+    { "simd", Benchmarks::simd },
+    { "spatialindex", Benchmarks::spatialIndex },
+    { "raykernel", Benchmarks::rayKernel }
+};
+
+// run every benchmark, or the ones named on the command line
+int main(int argc, char* argv[]) {
+    unsigned int noFailed = 0;
+
+    for (const benchmark& b : benchmarks) {
+        bool selected = argc < 2;
+        for (int i = 1; i < argc; i++) {
+            if (std::strcmp(argv[i], b.name) == 0) {
+                selected = true;
+            }
+        }
+        if (!selected) {
+            continue;
+        }
+
+        std::cout << "== " << b.name << std::endl;
+        unsigned int noMismatches = b.run();
+        if (noMismatches > 0) {
+            std::cout << b.name << ": " << noMismatches << " mismatches" << std::endl;
+            noFailed++;
+        }
+    }
+
+    return noFailed == 0 ? 0 : 1;
+}
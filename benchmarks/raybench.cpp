@@ -0,0 +1,194 @@
+/*****************************************************************
+ *   Author: Tyanna Prince
+ *   Date: 07/15/2023
+ *   Description: An enhancement of my cs330 OpenGL project where I added functionality such as charater movement,
+ *  directional lighting, and shadow mapping, a cubemap, and joystick support.
+ *  copyright (c) 2023 Tyanna Prince
+ *  version 2.0
+ *****************************************************************/
+
+#include "benchmarks.h"
+#include "../algorithms/math/linalg.h"
+#include "../algorithms/ray.h"
+#include "../algorithms/simd.h"
+#include "../physics/collisionmesh.h"
+#include "../physics/rigidbody.h"
+
+#include <cmath>
+#include <cstdio>
+#include <limits>
+#include <random>
+#include <vector>
+
+// rings of the bumpy sphere (from pole to pole)
+#define RAY_BENCH_RINGS 60
+// points in each ring
+#define RAY_BENCH_SEGMENTS 80
+// rays cast at the mesh
+#define RAY_BENCH_RAYS 4000
+// difference in t allowed against the plane-based reference (normals are stored packed)
+#define RAY_BENCH_TOLERANCE 1e-3f
+
+static std::mt19937 rng(11);
+
+// random float in [min, max]
+static float randomFloat(float min, float max) {
+    return std::uniform_real_distribution<float>(min, max)(rng);
+}
+
+// sphere of radius 1 with random bumps (every point is its own vertex height)
+static CollisionMesh* bumpySphere() {
+    std::vector<float> coords;
+    for (int i = 0; i <= RAY_BENCH_RINGS; i++) {
+        float theta = 0.1f + 2.9f * i / RAY_BENCH_RINGS;
+        for (int j = 0; j < RAY_BENCH_SEGMENTS; j++) {
+            float phi = 6.28318f * j / RAY_BENCH_SEGMENTS;
+            float radius = 1.0f + randomFloat(0.0f, 0.1f);
+            coords.push_back(radius * std::sin(theta) * std::cos(phi));
+            coords.push_back(radius * std::cos(theta));
+            coords.push_back(radius * std::sin(theta) * std::sin(phi));
+        }
+    }
+
+    std::vector<unsigned int> indices;
+    for (unsigned int i = 0; i < RAY_BENCH_RINGS; i++) {
+        for (unsigned int j = 0; j < RAY_BENCH_SEGMENTS; j++) {
+            unsigned int next = (j + 1) % RAY_BENCH_SEGMENTS;
+            unsigned int a = i * RAY_BENCH_SEGMENTS + j, b = i * RAY_BENCH_SEGMENTS + next;
+            unsigned int c = (i + 1) * RAY_BENCH_SEGMENTS + j, d = (i + 1) * RAY_BENCH_SEGMENTS + next;
+            indices.insert(indices.end(), { a, c, b, b, c, d });
+        }
+    }
+
+    return new CollisionMesh(coords.size() / 3, coords.data(), indices.size() / 3, indices.data());
+}
+
+// transform every face, then plane intersection and containment (the path before the world mesh cache)
+static bool transformedRay(Ray& r, CollisionMesh* mesh, RigidBody* instance, float& t) {
+    bool hit = false;
+    for (unsigned int i = 0; i < mesh->noFaces; i++) {
+        Face f = mesh->getFace(i);
+        glm::vec3 p1 = mesh->getPoint(f.i1), p2 = mesh->getPoint(f.i2), p3 = mesh->getPoint(f.i3);
+        glm::vec3 P1 = mat4vec3mult(instance->model, p1);
+        glm::vec3 P2 = mat4vec3mult(instance->model, p2) - P1;
+        glm::vec3 P3 = mat4vec3mult(instance->model, p3) - P1;
+        glm::vec3 norm = instance->normalModel * mesh->getNormal(i);
+        glm::vec3 U1 = r.origin - P1;
+
+        float tmp = -1.0f;
+        if ((char)linePlaneIntersection(glm::vec3(0.0f), norm, U1, r.dir, tmp) > 1 &&
+            tmp >= 0.0f && tmp <= t && faceContainsPoint(P2, P3, norm, U1 + tmp * r.dir)) {
+            hit = true;
+            t = tmp;
+        }
+    }
+    return hit;
+}
+
+// plane intersection and containment on every face of the cached world mesh
+static bool cachedRay(Ray& r, CollisionMesh* mesh, WorldMesh& world, float& t) {
+    bool hit = false;
+    for (unsigned int i = 0; i < mesh->noFaces; i++) {
+        Face f = mesh->getFace(i);
+        glm::vec3 P1 = world.points[f.i1];
+        glm::vec3 P2 = world.points[f.i2] - P1, P3 = world.points[f.i3] - P1;
+        glm::vec3 U1 = r.origin - P1;
+
+        float tmp = -1.0f;
+        if ((char)linePlaneIntersection(glm::vec3(0.0f), world.norms[i], U1, r.dir, tmp) > 1 &&
+            tmp >= 0.0f && tmp <= t && faceContainsPoint(P2, P3, world.norms[i], U1 + tmp * r.dir)) {
+            hit = true;
+            t = tmp;
+        }
+    }
+    return hit;
+}
+
+// microseconds per ray of a closest hit function over all rays
+template<typename T>
+static double timeRays(std::vector<Ray>& rays, unsigned int repeats, T closestHit) {
+    double start = Benchmarks::now();
+    for (unsigned int rep = 0; rep < repeats; rep++) {
+        for (Ray& r : rays) {
+            float t = std::numeric_limits<float>::max();
+            closestHit(r, t);
+        }
+    }
+    return (Benchmarks::now() - start) / (repeats * rays.size()) * 1e6;
+}
+
+// ray against triangle kernel and Ray::intersectsMesh, against the plane-based test
+unsigned int Benchmarks::rayKernel() {
+    CollisionMesh* mesh = bumpySphere();
+    RigidBody instance("benchMesh", glm::vec3(2.0f), 1.0f, glm::vec3(0.5f, 0.0f, 0.0f));
+    instance.rot = glm::vec3(0.3f, 0.5f, 0.1f);
+    instance.update(0.0f);
+    WorldMesh& world = instance.getWorldMesh(mesh);
+
+    std::vector<Ray> rays;
+    for (int i = 0; i < RAY_BENCH_RAYS; i++) {
+        glm::vec3 origin(randomFloat(-5.0f, 5.0f), randomFloat(-5.0f, 5.0f), randomFloat(-5.0f, 5.0f));
+        glm::vec3 dir(randomFloat(-1.0f, 1.0f), randomFloat(-1.0f, 1.0f), randomFloat(-1.0f, 1.0f));
+        rays.push_back(Ray(origin, glm::normalize(dir * 0.3f - origin * 0.1f)));
+    }
+
+    /*
+        correctness
+    */
+    unsigned int noHits = 0, noMesh = 0, noTails = 0, noReference = 0;
+    for (Ray& r : rays) {
+        float kernelT = std::numeric_limits<float>::max();
+        float scalarT = std::numeric_limits<float>::max();
+        float meshT = std::numeric_limits<float>::max();
+        int face = -1;
+        bool kernelHit = SIMD::rayIntersectsTriangles(r, world, 0, mesh->noFaces, kernelT) != -1;
+        bool scalarHit = cachedRay(r, mesh, world, scalarT);
+        bool meshHit = r.intersectsMesh(mesh, &instance, meshT, face);
+
+        if (kernelHit) {
+            noHits++;
+        }
+        if (kernelHit != meshHit || (kernelHit && std::fabs(kernelT - meshT) > 1e-5f)) {
+            // the face tree has to find the same closest face as the flat kernel
+            noMesh++;
+        }
+        if (kernelHit != scalarHit || (kernelHit && std::fabs(kernelT - scalarT) > RAY_BENCH_TOLERANCE)) {
+            noReference++;
+        }
+
+        // ranges ending mid batch agree with testing one face at a time
+        unsigned int first = (unsigned int)randomFloat(0.0f, mesh->noFaces - 20.0f);
+        unsigned int count = (unsigned int)randomFloat(0.0f, 19.0f);
+        float rangeT = std::numeric_limits<float>::max(), singleT = std::numeric_limits<float>::max();
+        int rangeFace = SIMD::rayIntersectsTriangles(r, world, first, count, rangeT), singleFace = -1;
+        for (unsigned int i = first; i < first + count; i++) {
+            float faceT = std::numeric_limits<float>::max();
+            if (SIMD::rayIntersectsTriangles(r, world, i, 1, faceT) != -1 && faceT < singleT) {
+                singleT = faceT;
+                singleFace = i;
+            }
+        }
+        if (rangeFace != singleFace || (rangeFace != -1 && rangeT != singleT)) {
+            noTails++;
+        }
+    }
+    printf("%u faces, %u of %zu rays hit: %u intersectsMesh mismatches, %u range mismatches, %u grazing differences from the plane test\n",
+        mesh->noFaces, noHits, rays.size(), noMesh, noTails, noReference);
+
+    /*
+        throughput
+    */
+    double transformedTime = timeRays(rays, 1, [&](Ray& r, float& t) { transformedRay(r, mesh, &instance, t); });
+    double cachedTime = timeRays(rays, 2, [&](Ray& r, float& t) { cachedRay(r, mesh, world, t); });
+    double kernelTime = timeRays(rays, 5, [&](Ray& r, float& t) { SIMD::rayIntersectsTriangles(r, world, 0, mesh->noFaces, t); });
+    double meshTime = timeRays(rays, 50, [&](Ray& r, float& t) { r.intersectsMesh(mesh, &instance, t); });
+
+    printf("transform + plane test   %9.3f us/ray\n", transformedTime);
+    printf("cached + plane test      %9.3f us/ray\n", cachedTime);
+    printf("kernel, all faces        %9.3f us/ray (%.1fx cached)\n", kernelTime, cachedTime / kernelTime);
+    printf("intersectsMesh           %9.3f us/ray (%.1fx transform)\n", meshTime, transformedTime / meshTime);
+
+    delete mesh;
+
+    return noMesh + noTails;
+}
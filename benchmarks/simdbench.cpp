@@ -0,0 +1,155 @@
+/*****************************************************************
+ *   Author: Tyanna Prince
+ *   Date: 07/15/2023
+ *   Description: An enhancement of my cs330 OpenGL project where I added functionality such as charater movement,
+ *  directional lighting, and shadow mapping, a cubemap, and joystick support.
+ *  copyright (c) 2023 Tyanna Prince
+ *  version 2.0
+ *****************************************************************/
+
+#include "benchmarks.h"
+#include "../algorithms/simd.h"
+
+#include <cstdio>
+#include <random>
+#include <vector>
+
+// regions in the throughput test (one query against all of them)
+#define SIMD_BENCH_REGIONS 4096
+// repetitions of the throughput test
+#define SIMD_BENCH_REPEATS 2000
+// random batches in the correctness test
+#define SIMD_BENCH_CHECKS 20000
+
+static std::mt19937 rng(5);
+
+// random float in [min, max] (snapped to quarters to hit touching bounds exactly)
+static float randomFloat(float min, float max, bool snap) {
+    float ret = std::uniform_real_distribution<float>(min, max)(rng);
+    return snap ? std::round(ret * 4.0f) / 4.0f : ret;
+}
+
+// random box or sphere
+static BoundingRegion randomRegion(bool snap) {
+    glm::vec3 pos(randomFloat(-5.0f, 5.0f, snap), randomFloat(-5.0f, 5.0f, snap), randomFloat(-5.0f, 5.0f, snap));
+    if (rng() % 2) {
+        return BoundingRegion(pos, pos + glm::vec3(randomFloat(0.0f, 3.0f, snap), randomFloat(0.0f, 3.0f, snap), randomFloat(0.0f, 3.0f, snap)));
+    }
+    return BoundingRegion(pos, randomFloat(0.1f, 2.0f, snap));
+}
+
+// batched region kernels against the scalar BoundingRegion and Ray tests
+unsigned int Benchmarks::simd() {
+    printf("SIMD_WIDTH %d\n", SIMD_WIDTH);
+
+    /*
+        correctness: every kernel bit matches the scalar test
+    */
+    unsigned int noMismatches = 0, noTests = 0;
+    for (int i = 0; i < SIMD_BENCH_CHECKS; i++) {
+        bool snap = i % 2;
+        BoundingRegion regions[SIMD_BATCH];
+        unsigned int count = 1 + rng() % SIMD_BATCH;
+        for (unsigned int j = 0; j < count; j++) {
+            regions[j] = randomRegion(snap);
+        }
+
+        SIMD::batch b;
+        b.load(regions, count);
+        BoundingRegion query = randomRegion(snap);
+        Ray ray(glm::vec3(randomFloat(-8.0f, 8.0f, false), randomFloat(-8.0f, 8.0f, false), randomFloat(-8.0f, 8.0f, false)),
+            glm::normalize(glm::vec3(randomFloat(-1.0f, 1.0f, false), randomFloat(-1.0f, 1.0f, false), randomFloat(-1.0f, 1.0f, false))));
+
+        unsigned int intersects = SIMD::intersectsRegions(query, b);
+        unsigned int contained = SIMD::containedInRegions(query, b);
+        float tmin[SIMD_BATCH], tmax[SIMD_BATCH];
+        unsigned int rayHits = SIMD::rayIntersectsRegions(ray, b, tmin, tmax);
+
+        for (unsigned int j = 0; j < count; j++) {
+            noTests++;
+            if (((intersects >> j) & 1) != (unsigned int)regions[j].intersectsWith(query)) {
+                noMismatches++;
+            }
+            bool expectContained = regions[j].type == BoundTypes::AABB && regions[j].containsRegion(query);
+            if (((contained >> j) & 1) != (unsigned int)expectContained) {
+                noMismatches++;
+            }
+            float t0, t1;
+            bool expectHit = ray.intersectsBoundingRegion(regions[j], t0, t1);
+            if (((rayHits >> j) & 1) != (unsigned int)expectHit || (expectHit && (t0 != tmin[j] || t1 != tmax[j]))) {
+                noMismatches++;
+            }
+        }
+        if ((intersects >> count) || (contained >> count) || (rayHits >> count)) {
+            // bits set past the loaded regions
+            noMismatches++;
+        }
+    }
+    printf("kernels vs scalar: %u mismatches in %u tests\n", noMismatches, noTests);
+
+    /*
+        throughput: one query against SIMD_BENCH_REGIONS regions
+    */
+    std::vector<BoundingRegion> regions(SIMD_BENCH_REGIONS);
+    for (BoundingRegion& br : regions) {
+        br = randomRegion(false);
+    }
+    BoundingRegion query(glm::vec3(0.0f), 1.0f);
+    Ray ray(glm::vec3(-10.0f, 0.1f, 0.2f), glm::normalize(glm::vec3(1.0f, 0.05f, 0.02f)));
+    volatile unsigned int sink = 0;
+    float t0, t1, tmin[SIMD_BATCH], tmax[SIMD_BATCH];
+    SIMD::batch b;
+
+    double start = now();
+    for (int k = 0; k < SIMD_BENCH_REPEATS; k++) {
+        for (int i = 0; i < SIMD_BENCH_REGIONS; i++) {
+            sink += regions[i].intersectsWith(query);
+        }
+    }
+    double scalarTime = now() - start;
+
+    start = now();
+    for (int k = 0; k < SIMD_BENCH_REPEATS; k++) {
+        for (int i = 0; i < SIMD_BENCH_REGIONS; i += SIMD_BATCH) {
+            b.load(&regions[i], SIMD_BATCH);
+            sink += SIMD::intersectsRegions(query, b);
+        }
+    }
+    double loadTime = now() - start;
+
+    // batches cached like the octree nodes do
+    std::vector<SIMD::batch> batches;
+    SIMD::loadBatches(regions.data(), SIMD_BENCH_REGIONS, batches);
+    start = now();
+    for (int k = 0; k < SIMD_BENCH_REPEATS; k++) {
+        for (const SIMD::batch& cached : batches) {
+            sink += SIMD::intersectsRegions(query, cached);
+        }
+    }
+    double cachedTime = now() - start;
+
+    start = now();
+    for (int k = 0; k < SIMD_BENCH_REPEATS; k++) {
+        for (int i = 0; i < SIMD_BENCH_REGIONS; i++) {
+            sink += ray.intersectsBoundingRegion(regions[i], t0, t1);
+        }
+    }
+    double rayScalarTime = now() - start;
+
+    start = now();
+    for (int k = 0; k < SIMD_BENCH_REPEATS; k++) {
+        for (int i = 0; i < SIMD_BENCH_REGIONS; i += SIMD_BATCH) {
+            b.load(&regions[i], SIMD_BATCH);
+            sink += SIMD::rayIntersectsRegions(ray, b, tmin, tmax);
+        }
+    }
+    double rayLoadTime = now() - start;
+
+    double toNs = 1e9 / ((double)SIMD_BENCH_REGIONS * SIMD_BENCH_REPEATS);
+    printf("intersects: scalar %.2f ns/test, batch incl. load %.2f, cached batch %.2f\n",
+        scalarTime * toNs, loadTime * toNs, cachedTime * toNs);
+    printf("ray slab:   scalar %.2f ns/test, batch incl. load %.2f\n",
+        rayScalarTime * toNs, rayLoadTime * toNs);
+
+    return noMismatches;
+}
@@ -0,0 +1,262 @@
+/*****************************************************************
+ *   Author: Tyanna Prince
+ *   Date: 07/15/2023
+ *   Description: An enhancement of my cs330 OpenGL project where I added functionality such as charater movement,
+ *  directional lighting, and shadow mapping, a cubemap, and joystick support.
+ *  copyright (c) 2023 Tyanna Prince
+ *  version 2.0
+ *****************************************************************/
+
+#include "benchmarks.h"
+#include "../algorithms/bvh.h"
+#include "../algorithms/events.h"
+#include "../algorithms/linearoctree.h"
+#include "../algorithms/octree.h"
+#include "../graphics/models/box.hpp"
+#include "../graphics/objects/model.h"
+#include "../physics/contacts.h"
+
+#include <glm/gtc/matrix_transform.hpp>
+
+#include <cmath>
+#include <cstdio>
+#include <limits>
+#include <random>
+#include <set>
+#include <string>
+#include <utility>
+#include <vector>
+
+// instances in the scene (half boxes, half spheres)
+#define SPATIAL_BENCH_INSTANCES 20000
+// rays cast through the scene
+#define SPATIAL_BENCH_RAYS 2000
+// frustum queries timed
+#define SPATIAL_BENCH_FRUSTUMS 20
+// half the side of the cube the instances are spread in
+#define SPATIAL_BENCH_EXTENT 15.0f
+// looseness of the loose pointer octree
+#define SPATIAL_BENCH_LOOSENESS 1.5f
+
+static std::mt19937 rng(11);
+
+// random float in [min, max]
+static float randomFloat(float min, float max) {
+    return std::uniform_real_distribution<float>(min, max)(rng);
+}
+
+// region of an instance as the indices store it
+static BoundingRegion transformedRegion(Model* model, RigidBody* instance) {
+    BoundingRegion br = model->boundingRegions[0];
+    br.instance = instance;
+    br.transform();
+    return br;
+}
+
+// unordered pair of instances
+typedef std::pair<RigidBody*, RigidBody*> instancePair;
+
+// pair with the lower address first
+static instancePair makePair(RigidBody* a, RigidBody* b) {
+    return a < b ? instancePair(a, b) : instancePair(b, a);
+}
+
+// pairs the last update reported (pairs touching this frame)
+static std::set<instancePair> reportedPairs() {
+    Events::publish();
+
+    std::set<instancePair> ret;
+    for (const Events::collision& e : Events::frame) {
+        if (e.phase != Events::CollisionPhase::END) {
+            ret.insert(makePair(e.a, e.b));
+        }
+    }
+    return ret;
+}
+
+// every spatial index backend on the same scene, against brute force
+unsigned int Benchmarks::spatialIndex() {
+    unsigned int noMismatches = 0;
+
+    /*
+        identical scene for every backend
+    */
+    Model spheres("benchSphere", SPATIAL_BENCH_INSTANCES);
+    Model boxes("benchBox", SPATIAL_BENCH_INSTANCES);
+    BoundingRegion sphere(glm::vec3(0.0f), 0.3f);
+    sphere.collisionMesh = nullptr;
+    spheres.boundingRegions.push_back(sphere);
+    BoundingRegion box(glm::vec3(-0.4f, -0.2f, -0.3f), glm::vec3(0.4f, 0.2f, 0.3f));
+    box.collisionMesh = nullptr;
+    boxes.boundingRegions.push_back(box);
+
+    std::vector<RigidBody*> instances;
+    std::vector<Model*> models;
+    for (int i = 0; i < SPATIAL_BENCH_INSTANCES; i++) {
+        Model* model = i % 2 ? &spheres : &boxes;
+        glm::vec3 pos(randomFloat(-SPATIAL_BENCH_EXTENT, SPATIAL_BENCH_EXTENT),
+            randomFloat(-SPATIAL_BENCH_EXTENT, SPATIAL_BENCH_EXTENT),
+            randomFloat(-SPATIAL_BENCH_EXTENT, SPATIAL_BENCH_EXTENT));
+        RigidBody* instance = new RigidBody(model->id, glm::vec3(1.0f), 1.0f, pos);
+        instance->instanceId = std::to_string(i);
+        instance->state = 0;
+        instances.push_back(instance);
+        models.push_back(model);
+    }
+
+    BoundingRegion bounds(glm::vec3(-SPATIAL_BENCH_EXTENT - 1.0f), glm::vec3(SPATIAL_BENCH_EXTENT + 1.0f));
+    Octree::node* pointerTree = Octree::node::pool.create(bounds);
+    Octree::node* looseTree = Octree::node::pool.create(bounds);
+    looseTree->looseness = SPATIAL_BENCH_LOOSENESS;
+    Octree::linearTree linearTree(bounds);
+    BVH bvh;
+    SpatialIndex* indices[] = { pointerTree, looseTree, &linearTree, &bvh };
+    const char* names[] = { "pointer", "loose", "linear", "bvh" };
+    // strict pointer nodes only test a moved object against its old cell, its children and parents,
+    // so pairs between two moved objects can be missed (reported, not counted as a mismatch)
+    const bool allPairs[] = { false, true, true, true };
+    const int noIndices = 4;
+    Box renderBox;
+
+    /*
+        build
+    */
+    for (int k = 0; k < noIndices; k++) {
+        for (int i = 0; i < SPATIAL_BENCH_INSTANCES; i++) {
+            indices[k]->addToPending(instances[i], models[i]);
+        }
+        double start = now();
+        indices[k]->processPending();
+        double buildTime = now() - start;
+        indices[k]->update(renderBox);
+
+        Stats::treeStats stats;
+        indices[k]->calculateStats(stats);
+        printf("%-8s build %7.2f ms, %u nodes, depth max %u mean %.2f\n",
+            names[k], buildTime * 1e3, stats.noNodes, stats.maxDepth, stats.calculateMeanDepth());
+    }
+
+    /*
+        frustum culling
+    */
+    glm::mat4 viewProjection = glm::perspective(glm::radians(45.0f), 1.5f, 0.1f, 100.0f) *
+        glm::lookAt(glm::vec3(0.0f, 0.0f, 20.0f), glm::vec3(3.0f, 1.0f, 0.0f), glm::vec3(0.0f, 1.0f, 0.0f));
+    Frustum frustum(viewProjection);
+    std::set<RigidBody*> expectVisible;
+    for (int i = 0; i < SPATIAL_BENCH_INSTANCES; i++) {
+        if (frustum.testRegion(transformedRegion(models[i], instances[i])) != FrustumTest::OUTSIDE) {
+            expectVisible.insert(instances[i]);
+        }
+    }
+    for (int k = 0; k < noIndices; k++) {
+        std::vector<RigidBody*> visible;
+        double start = now();
+        for (int i = 0; i < SPATIAL_BENCH_FRUSTUMS; i++) {
+            visible.clear();
+            indices[k]->checkCollisionsFrustum(frustum, visible);
+        }
+        double frustumTime = (now() - start) / SPATIAL_BENCH_FRUSTUMS;
+
+        bool match = std::set<RigidBody*>(visible.begin(), visible.end()) == expectVisible;
+        if (!match) {
+            noMismatches++;
+        }
+        printf("%-8s frustum %7.3f ms, %zu visible %s\n", names[k], frustumTime * 1e3, visible.size(), match ? "(matches)" : "(MISMATCH)");
+    }
+
+    /*
+        closest hit rays
+    */
+    std::vector<Ray> rays;
+    std::vector<float> expectT(SPATIAL_BENCH_RAYS, std::numeric_limits<float>::max());
+    for (int r = 0; r < SPATIAL_BENCH_RAYS; r++) {
+        glm::vec3 origin(randomFloat(-20.0f, 20.0f), randomFloat(-20.0f, 20.0f), -25.0f);
+        rays.push_back(Ray(origin, glm::normalize(glm::vec3(randomFloat(-1.0f, 1.0f), randomFloat(-1.0f, 1.0f), 1.5f))));
+
+        for (int i = 0; i < SPATIAL_BENCH_INSTANCES; i++) {
+            float tmin, tmax;
+            if (rays[r].intersectsBoundingRegion(transformedRegion(models[i], instances[i]), tmin, tmax) && tmin < expectT[r]) {
+                expectT[r] = tmin;
+            }
+        }
+    }
+    for (int k = 0; k < noIndices; k++) {
+        unsigned int noWrong = 0;
+        double start = now();
+        for (int r = 0; r < SPATIAL_BENCH_RAYS; r++) {
+            float t = std::numeric_limits<float>::max();
+            indices[k]->checkCollisionsRay(rays[r], t);
+            if (std::fabs(t - expectT[r]) > 1e-4f * std::fmaxf(1.0f, expectT[r])) {
+                noWrong++;
+            }
+        }
+        double rayTime = (now() - start) / SPATIAL_BENCH_RAYS;
+
+        noMismatches += noWrong;
+        printf("%-8s ray     %7.2f us, %u wrong hits\n", names[k], rayTime * 1e6, noWrong);
+    }
+
+    /*
+        move 30% of the instances, then update and generate pairs
+    */
+    for (int i = 0; i < SPATIAL_BENCH_INSTANCES; i++) {
+        if (i % 10 < 3) {
+            instances[i]->pos += glm::vec3(0.2f, -0.1f, 0.15f);
+            States::activate(&instances[i]->state, INSTANCE_MOVED);
+        }
+    }
+    std::set<instancePair> expectPairs;
+    for (int i = 0; i < SPATIAL_BENCH_INSTANCES; i++) {
+        BoundingRegion br = transformedRegion(models[i], instances[i]);
+        for (int j = i + 1; j < SPATIAL_BENCH_INSTANCES; j++) {
+            bool moved = States::isActive(&instances[i]->state, INSTANCE_MOVED) || States::isActive(&instances[j]->state, INSTANCE_MOVED);
+            if (moved && br.intersectsWith(transformedRegion(models[j], instances[j]))) {
+                expectPairs.insert(makePair(instances[i], instances[j]));
+            }
+        }
+    }
+    for (int k = 0; k < noIndices; k++) {
+        Events::clear();
+        Contacts::clear();
+
+        double start = now();
+        indices[k]->update(renderBox);
+        double updateTime = now() - start;
+
+        std::set<instancePair> pairs = reportedPairs();
+        unsigned int noFalse = 0, noMissed = 0;
+        for (const instancePair& p : pairs) {
+            if (!expectPairs.count(p)) {
+                noFalse++;
+            }
+        }
+        for (const instancePair& p : expectPairs) {
+            if (!pairs.count(p)) {
+                noMissed++;
+            }
+        }
+
+        noMismatches += noFalse;
+        if (allPairs[k]) {
+            noMismatches += noMissed;
+        }
+        printf("%-8s update  %7.2f ms, %zu pairs (brute force %zu), %u false, %u missed\n",
+            names[k], updateTime * 1e3, pairs.size(), expectPairs.size(), noFalse, noMissed);
+    }
+
+    /*
+        cleanup
+    */
+    Events::clear();
+    Contacts::clear();
+    for (int k = 0; k < noIndices; k++) {
+        indices[k]->destroy();
+    }
+    Octree::node::pool.release(pointerTree);
+    Octree::node::pool.release(looseTree);
+    for (RigidBody* instance : instances) {
+        delete instance;
+    }
+
+    return noMismatches;
+}
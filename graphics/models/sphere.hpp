@@ -6,7 +6,7 @@
 class Sphere : public Model {
 public:
     Sphere(unsigned int maxNoInstances)
-        : Model("sphere", maxNoInstances, NO_TEX | DYNAMIC) {}
+        : Model("sphere", maxNoInstances, NO_TEX | DYNAMIC | HASH_GRID) {}
 
     void init() {
         loadModel("assets/models/sphere/scene.gltf");
@@ -24,7 +24,7 @@
 Model::Model(std::string id, unsigned int maxNoInstances, unsigned int flags)
     : id(id), switches(flags),
     currentNoInstances(0), maxNoInstances(maxNoInstances), instances(maxNoInstances),
-    collision(nullptr) {}
+    collision(nullptr), boundsVolume(0.0f), centeredBoundsVolume(0.0f) {}
 
 /*
     process functions
@@ -69,6 +69,9 @@ void Model::addMesh(Mesh* mesh) {
 
 // render instance(s)
 void Model::render(Shader shader, float dt, Scene* scene) {
+    // number of instances in the VBOs (constant instances are all uploaded once)
+    unsigned int noRenderInstances = currentNoInstances;
+
     if (!States::isActive(&switches, CONST_INSTANCES)) {
         // dynamic instances - update VBO data
 
@@ -79,6 +82,10 @@ void Model::render(Shader shader, float dt, Scene* scene) {
         // determine if instances are moving
         bool doUpdate = States::isActive(&switches, DYNAMIC);
 
+        // determine if only instances in the camera frustum are uploaded
+        bool doCull = scene && scene->frustumCulling;
+        noRenderInstances = 0;
+
         // iterate through each instance
         for (int i = 0; i < currentNoInstances; i++) {
             if (doUpdate) {
@@ -92,17 +99,20 @@ void Model::render(Shader shader, float dt, Scene* scene) {
                 States::deactivate(&instances[i]->state, INSTANCE_MOVED);
             }
 
-            // add updated matrices
-            models[i] = instances[i]->model;
-            normalModels[i] = instances[i]->normalModel;
+            // add updated matrices of visible instances
+            if (!doCull || States::isActive(&instances[i]->state, INSTANCE_VISIBLE)) {
+                models[noRenderInstances] = instances[i]->model;
+                normalModels[noRenderInstances] = instances[i]->normalModel;
+                noRenderInstances++;
+            }
         }
 
-        if (currentNoInstances) {
+        if (noRenderInstances) {
             // set transformation data
             modelVBO.bind();
-            modelVBO.updateData<glm::mat4>(0, currentNoInstances, &models[0]);
+            modelVBO.updateData<glm::mat4>(0, noRenderInstances, &models[0]);
             normalModelVBO.bind();
-            normalModelVBO.updateData<glm::mat3>(0, currentNoInstances, &normalModels[0]);
+            normalModelVBO.updateData<glm::mat3>(0, noRenderInstances, &normalModels[0]);
         }
     }
 
@@ -111,7 +121,7 @@ void Model::render(Shader shader, float dt, Scene* scene) {
 
     // render each mesh
     for (unsigned int i = 0, noMeshes = meshes.size(); i < noMeshes; i++) {
-        meshes[i].render(shader, currentNoInstances);
+        meshes[i].render(shader, noRenderInstances);
     }
 }
 
@@ -148,6 +158,10 @@ RigidBody* Model::generateInstance(glm::vec3 size, float mass, glm::vec3 pos, gl
 
     // instantiate new instance
     instances[currentNoInstances] = new RigidBody(id, size, mass, pos, rot);
+    if (!States::isActive(&switches, DYNAMIC)) {
+        // instances never move, so collisions cannot push them either
+        States::activate(&instances[currentNoInstances]->state, INSTANCE_STATIC);
+    }
     return instances[currentNoInstances++];
 }
 
@@ -208,6 +222,26 @@ void Model::initInstances() {
     }
 }
 
+// upload matrices of constant instances again (after instances are replaced)
+void Model::refreshInstances() {
+    if (!States::isActive(&switches, CONST_INSTANCES) || !currentNoInstances) {
+        // dynamic instances are uploaded every frame
+        return;
+    }
+
+    std::vector<glm::mat4> models(currentNoInstances);
+    std::vector<glm::mat3> normalModels(currentNoInstances);
+    for (unsigned int i = 0; i < currentNoInstances; i++) {
+        models[i] = instances[i]->model;
+        normalModels[i] = instances[i]->normalModel;
+    }
+
+    modelVBO.bind();
+    modelVBO.updateData<glm::mat4>(0, currentNoInstances, &models[0]);
+    normalModelVBO.bind();
+    normalModelVBO.updateData<glm::mat3>(0, currentNoInstances, &normalModels[0]);
+}
+
 // remove instance at idx
 void Model::removeInstance(unsigned int idx) {
     if (idx < maxNoInstances) {
@@ -263,10 +297,8 @@ Mesh Model::processMesh(aiMesh* mesh, const aiScene* scene) {
     std::vector<unsigned int> indices(3 * mesh->mNumFaces);
     std::vector<Texture> textures;
 
-    // setup bounding region
-    BoundingRegion br(BoundTypes::SPHERE);
-    glm::vec3 min(std::numeric_limits<float>::max()); // min point = max float
-    glm::vec3 max(std::numeric_limits<float>::min()); // max point = min float
+    // positions for the bounding region
+    std::vector<glm::vec3> positions(mesh->mNumVertices);
 
     // vertices
     for (unsigned int i = 0; i < mesh->mNumVertices; i++) {
@@ -277,13 +309,7 @@ Mesh Model::processMesh(aiMesh* mesh, const aiScene* scene) {
             mesh->mVertices[i].z
         );
 
-        // determine if outside of current min and max
-        for (int j = 0; j < 3; j++) {
-            // if smaller than min
-            if (vertices[i].pos[j] < min[j]) min[j] = vertices[i].pos[j];
-            // if larger than max
-            if (vertices[i].pos[j] > max[j]) max[j] = vertices[i].pos[j];
-        }
+        positions[i] = vertices[i].pos;
 
         // normal vectors
         vertices[i].normal = glm::vec3(
@@ -311,27 +337,18 @@ Mesh Model::processMesh(aiMesh* mesh, const aiScene* scene) {
         };
     }
 
-    // process min/max for BR
-    // calculate max distance from the center
-    br.center = (min + max) / 2.0f;
-    br.ogCenter = br.center;
-    br.collisionMesh = NULL;
-    float maxRadiusSquared = 0.0f;
-
-    for (unsigned int i = 0; i < mesh->mNumVertices; i++) {
-        float radiusSquared = 0.0f; // distance for this vertex
-        for (int j = 0; j < 3; j++) {
-            radiusSquared += (vertices[i].pos[j] - br.center[j]) * (vertices[i].pos[j] - br.center[j]);
-        }
-        if (radiusSquared > maxRadiusSquared) {
-            // found new squared radius
-            // a^2 > b^2 --> |a| > |b|
-            maxRadiusSquared = radiusSquared;
+    // setup bounding region (smallest sphere, or box if smaller and enabled)
+    BoundingRegion br = BoundingRegion::calculateMinimalSphere(positions);
+    if (States::isActive(&switches, BOX_BOUNDS)) {
+        BoundingRegion box = BoundingRegion::calculateBox(positions);
+        if (box.calculateVolume() < br.calculateVolume()) {
+            br = box;
         }
     }
+    br.collisionMesh = NULL;
 
-    br.radius = sqrt(maxRadiusSquared);
-    br.ogRadius = br.radius;
+    boundsVolume += br.calculateVolume();
+    centeredBoundsVolume += BoundingRegion::calculateCenteredSphere(positions).calculateVolume();
 
     // process indices
     for (unsigned int i = 0; i < mesh->mNumFaces; i++) {
@@ -420,7 +437,19 @@ Mesh Model::processMesh(BoundingRegion br,
     if (noCollisionPoints) {
         enableCollisionModel();
         ret.loadCollisionMesh(noCollisionPoints, collisionPoints, noCollisionFaces, collisionIndices);
+
+        // compare the fitted sphere of the collision mesh with the old one
+        std::vector<glm::vec3> points(noCollisionPoints);
+        for (unsigned int i = 0; i < noCollisionPoints; i++) {
+            points[i] = glm::vec3(collisionPoints[i * 3 + 0], collisionPoints[i * 3 + 1], collisionPoints[i * 3 + 2]);
+        }
+        centeredBoundsVolume += BoundingRegion::calculateCenteredSphere(points).calculateVolume();
+    }
+    else {
+        // region given by the model
+        centeredBoundsVolume += ret.br.calculateVolume();
     }
+    boundsVolume += ret.br.calculateVolume();
     
     return ret;
 }
@@ -36,6 +36,8 @@
 #define DYNAMIC				(unsigned int)1 // 0b00000001
 #define CONST_INSTANCES		(unsigned int)2 // 0b00000010
 #define NO_TEX				(unsigned int)4	// 0b00000100
+#define HASH_GRID			(unsigned int)8	// 0b00001000 (instances kept in the scene's hash grid instead of the octree)
+#define BOX_BOUNDS			(unsigned int)16	// 0b00010000 (box bounds where smaller than the sphere, instances must not rotate)
 
 // forward declaration
 class Scene;
@@ -56,6 +58,11 @@ public:
     // list of bounding regions (1 for each mesh)
     std::vector<BoundingRegion> boundingRegions;
 
+    // total volume of the bounds of the meshes
+    float boundsVolume;
+    // total volume of spheres around the centers of the mesh boxes (old bounds, to compare against)
+    float centeredBoundsVolume;
+
     // list of instances
     std::vector<RigidBody*> instances;
 
@@ -106,6 +113,9 @@ public:
     // initialize memory for instances
     void initInstances();
 
+    // upload matrices of constant instances again (after instances are replaced)
+    void refreshInstances();
+
     // remove instance at idx
     void removeInstance(unsigned int idx);
 
@@ -0,0 +1,382 @@
+/*****************************************************************
+ *   Author: Tyanna Prince
+ *   Date: 07/15/2023
+ *   Description: An enhancement of my cs330 OpenGL project where I added functionality such as charater movement,
+ *  directional lighting, and shadow mapping, a cubemap, and joystick support.
+ *  copyright (c) 2023 Tyanna Prince
+ *  version 2.0
+ *****************************************************************/
+
+#include "snapshot.h"
+
+#include <fstream>
+
+// index written for a region whose instance is not in the table
+#define NO_INSTANCE 0xffffffff
+
+/*
+    writer
+*/
+
+// write length then characters
+void Snapshot::writer::writeString(std::string str) {
+    write<unsigned int>(str.length());
+    data.insert(data.end(), str.begin(), str.end());
+}
+
+// save buffer to file
+bool Snapshot::writer::save(std::string path) {
+    std::ofstream file(path, std::ios::binary | std::ios::trunc);
+    if (!file) {
+        return false;
+    }
+
+    file.write(data.data(), data.size());
+    return (bool)file;
+}
+
+/*
+    reader
+*/
+
+// load entire file
+bool Snapshot::reader::load(std::string path) {
+    std::ifstream file(path, std::ios::binary | std::ios::ate);
+    if (!file) {
+        return false;
+    }
+
+    // one read for the whole file
+    std::streamsize size = file.tellg();
+    file.seekg(0, std::ios::beg);
+    data.resize((size_t)size);
+    cursor = 0;
+    failed = !file.read(data.data(), size);
+    return !failed;
+}
+
+// read length then characters
+std::string Snapshot::reader::readString() {
+    unsigned int len = read<unsigned int>();
+    if (failed || cursor + len > data.size()) {
+        failed = true;
+        return "";
+    }
+
+    std::string ret(&data[cursor], len);
+    cursor += len;
+    return ret;
+}
+
+/*
+    instance table
+*/
+
+// add instance at the next index
+void Snapshot::instanceTable::add(RigidBody* instance, Model* model) {
+    indices[instance] = instances.size();
+    instances.push_back(instance);
+    models.push_back(model);
+}
+
+/*
+    rigid bodies
+*/
+
+// write state of instance
+void Snapshot::writeInstance(writer& out, RigidBody* instance) {
+    out.writeString(instance->instanceId);
+    out.write<unsigned char>(instance->state);
+    out.write<float>(instance->mass);
+    out.write<glm::vec3>(instance->pos);
+    out.write<glm::vec3>(instance->velocity);
+    out.write<glm::vec3>(instance->acceleration);
+    out.write<glm::vec3>(instance->size);
+    out.write<glm::vec3>(instance->rot);
+    out.write<glm::mat4>(instance->model);
+    out.write<glm::mat3>(instance->normalModel);
+    out.write<float>(instance->lastCollision);
+    out.writeString(instance->lastCollisionID);
+}
+
+// read state of instance into a new rigid body
+RigidBody* Snapshot::readInstance(reader& in, std::string modelId) {
+    RigidBody* ret = new RigidBody(modelId);
+
+    ret->instanceId = in.readString();
+    ret->state = in.read<unsigned char>();
+    ret->mass = in.read<float>();
+    ret->pos = in.read<glm::vec3>();
+    ret->prevPos = ret->pos; // nothing to sweep across the restore
+    ret->velocity = in.read<glm::vec3>();
+    ret->acceleration = in.read<glm::vec3>();
+    ret->size = in.read<glm::vec3>();
+    ret->rot = in.read<glm::vec3>();
+    ret->model = in.read<glm::mat4>();
+    ret->normalModel = in.read<glm::mat3>();
+    ret->lastCollision = in.read<float>();
+    ret->lastCollisionID = in.readString();
+
+    return ret;
+}
+
+/*
+    bounding regions
+*/
+
+// write region with its instance as an index into the table
+static void writeRegion(Snapshot::writer& out, const BoundingRegion& br, Snapshot::instanceTable& table) {
+    unsigned int instanceIdx = NO_INSTANCE;
+    int meshIdx = -1;
+
+    std::unordered_map<RigidBody*, unsigned int>::iterator it = table.indices.find(br.instance);
+    if (it != table.indices.end()) {
+        instanceIdx = it->second;
+
+        // collision meshes belong to the model, so store which of its regions this came from
+        Model* model = table.models[instanceIdx];
+        for (int i = 0, len = model->boundingRegions.size(); i < len; i++) {
+            if (model->boundingRegions[i].collisionMesh == br.collisionMesh) {
+                meshIdx = i;
+                break;
+            }
+        }
+    }
+
+    out.write<unsigned char>((unsigned char)br.type);
+    out.write<unsigned int>(instanceIdx);
+    out.write<int>(meshIdx);
+    out.write<glm::vec3>(br.center);
+    out.write<float>(br.radius);
+    out.write<glm::vec3>(br.ogCenter);
+    out.write<float>(br.ogRadius);
+    out.write<glm::vec3>(br.min);
+    out.write<glm::vec3>(br.max);
+    out.write<glm::vec3>(br.ogMin);
+    out.write<glm::vec3>(br.ogMax);
+}
+
+// read region and point it back to its instance (false if the instance index is bad)
+static bool readRegion(Snapshot::reader& in, BoundingRegion& br, Snapshot::instanceTable& table) {
+    br.type = (BoundTypes)in.read<unsigned char>();
+    unsigned int instanceIdx = in.read<unsigned int>();
+    int meshIdx = in.read<int>();
+    br.center = in.read<glm::vec3>();
+    br.radius = in.read<float>();
+    br.ogCenter = in.read<glm::vec3>();
+    br.ogRadius = in.read<float>();
+    br.min = in.read<glm::vec3>();
+    br.max = in.read<glm::vec3>();
+    br.ogMin = in.read<glm::vec3>();
+    br.ogMax = in.read<glm::vec3>();
+
+    if (in.failed || instanceIdx >= table.instances.size()) {
+        return false;
+    }
+
+    br.instance = table.instances[instanceIdx];
+    br.cell = nullptr;
+    br.cellIdx = 0;
+
+    Model* model = table.models[instanceIdx];
+    br.collisionMesh = (meshIdx >= 0 && meshIdx < (int)model->boundingRegions.size())
+        ? model->boundingRegions[meshIdx].collisionMesh
+        : nullptr;
+
+    return true;
+}
+
+// write every region in the queue
+static void writeQueue(Snapshot::writer& out, const std::vector<BoundingRegion>& queue, Snapshot::instanceTable& table) {
+    out.write<unsigned int>(queue.size());
+    for (const BoundingRegion& br : queue) {
+        writeRegion(out, br, table);
+    }
+}
+
+// read regions into the queue
+static bool readQueue(Snapshot::reader& in, std::vector<BoundingRegion>& queue, Snapshot::instanceTable& table) {
+    unsigned int noPending = in.read<unsigned int>();
+    for (unsigned int i = 0; i < noPending; i++) {
+        BoundingRegion br;
+        if (!readRegion(in, br, table)) {
+            return false;
+        }
+        queue.push_back(br);
+    }
+    return !in.failed;
+}
+
+/*
+    pointer octree
+*/
+
+// write node then its children (preorder)
+static void writeNode(Snapshot::writer& out, Octree::node* n, Snapshot::instanceTable& table) {
+    out.write<glm::vec3>(n->region.min);
+    out.write<glm::vec3>(n->region.max);
+    out.write<unsigned char>(n->activeOctants);
+    out.write<bool>(n->treeBuilt);
+    out.write<bool>(n->treeReady);
+    out.write<short>(n->maxLifespan);
+    out.write<short>(n->currentLifespan);
+    out.write<float>(n->looseness);
+
+    out.write<unsigned int>(n->objects.size());
+    for (BoundingRegion& br : n->objects) {
+        writeRegion(out, br, table);
+    }
+    writeQueue(out, n->queue, table);
+
+    for (unsigned char flags = n->activeOctants, i = 0;
+        flags > 0;
+        flags >>= 1, i++) {
+        if (States::isIndexActive(&flags, 0)) {
+            writeNode(out, n->children[i], table);
+        }
+    }
+}
+
+// read node and its children into nodes from the pool (nullptr if the data is bad)
+static Octree::node* readNode(Snapshot::reader& in, Octree::node* parent, Snapshot::instanceTable& table) {
+    glm::vec3 min = in.read<glm::vec3>();
+    glm::vec3 max = in.read<glm::vec3>();
+    Octree::node* ret = Octree::node::pool.create(BoundingRegion(min, max));
+    ret->parent = parent;
+
+    // children are attached as they are read so a failure can destroy the whole branch
+    unsigned char activeOctants = in.read<unsigned char>();
+    ret->treeBuilt = in.read<bool>();
+    ret->treeReady = in.read<bool>();
+    ret->maxLifespan = in.read<short>();
+    ret->currentLifespan = in.read<short>();
+    ret->looseness = in.read<float>();
+
+    bool success = !in.failed;
+
+    unsigned int noObjects = in.read<unsigned int>();
+    ret->objects.reserve(success ? std::min<unsigned int>(noObjects, in.data.size()) : 0);
+    for (unsigned int i = 0; success && i < noObjects; i++) {
+        BoundingRegion br;
+        success = readRegion(in, br, table);
+        if (success) {
+            ret->addObject(br);
+        }
+    }
+    success = success && readQueue(in, ret->queue, table);
+
+    for (unsigned char flags = activeOctants, i = 0;
+        success && flags > 0;
+        flags >>= 1, i++) {
+        if (States::isIndexActive(&flags, 0)) {
+            ret->children[i] = readNode(in, ret, table);
+            if (ret->children[i]) {
+                States::activateIndex(&ret->activeOctants, i);
+            }
+            else {
+                success = false;
+            }
+        }
+    }
+
+    if (!success) {
+        ret->destroy();
+        Octree::node::pool.release(ret);
+        return nullptr;
+    }
+
+    return ret;
+}
+
+// write pointer octree
+void Snapshot::writeTree(writer& out, Octree::node* root, instanceTable& table) {
+    out.write<bool>(root->detectCollisions);
+    out.write<unsigned int>(root->noInsertions);
+    writeNode(out, root, table);
+}
+
+// read pointer octree into new nodes from the pool (nullptr if the data is bad)
+Octree::node* Snapshot::readTree(reader& in, instanceTable& table) {
+    bool detectCollisions = in.read<bool>();
+    unsigned int noInsertions = in.read<unsigned int>();
+
+    Octree::node* ret = readNode(in, nullptr, table);
+    if (ret) {
+        ret->detectCollisions = detectCollisions;
+        ret->noInsertions = noInsertions;
+    }
+    return ret;
+}
+
+/*
+    linear octree
+*/
+
+// write linear octree
+void Snapshot::writeTree(writer& out, Octree::linearTree* tree, instanceTable& table) {
+    out.write<glm::vec3>(tree->region.min);
+    out.write<glm::vec3>(tree->region.max);
+    out.write<unsigned char>(tree->maxDepth);
+    out.write<bool>(tree->treeBuilt);
+    out.write<bool>(tree->nodesDirty);
+    out.write<bool>(tree->detectCollisions);
+
+    // nodes are plain data
+    out.write<unsigned int>(tree->nodes.size());
+    for (Octree::linearNode& n : tree->nodes) {
+        out.write<Octree::linearNode>(n);
+    }
+
+    out.write<unsigned int>(tree->objects.size());
+    for (unsigned int i = 0, len = tree->objects.size(); i < len; i++) {
+        out.write<unsigned int>(tree->objectCodes[i]);
+        writeRegion(out, tree->objects[i], table);
+    }
+
+    writeQueue(out, tree->queue, table);
+}
+
+// read linear octree into existing tree (false if the data is bad)
+bool Snapshot::readTree(reader& in, Octree::linearTree* tree, instanceTable& table) {
+    tree->destroy();
+
+    glm::vec3 min = in.read<glm::vec3>();
+    glm::vec3 max = in.read<glm::vec3>();
+    tree->region = BoundingRegion(min, max);
+    tree->maxDepth = in.read<unsigned char>();
+    tree->treeBuilt = in.read<bool>();
+    tree->nodesDirty = in.read<bool>();
+    tree->detectCollisions = in.read<bool>();
+
+    unsigned int noNodes = in.read<unsigned int>();
+    if (in.failed || noNodes * sizeof(Octree::linearNode) > in.data.size() - in.cursor) {
+        return false;
+    }
+    tree->nodes.resize(noNodes);
+    tree->batchesDirty = true;
+    for (unsigned int i = 0; i < noNodes; i++) {
+        tree->nodes[i] = in.read<Octree::linearNode>();
+    }
+
+    unsigned int noObjects = in.read<unsigned int>();
+    if (in.failed || noObjects > in.data.size() - in.cursor) {
+        return false;
+    }
+    tree->objects.resize(noObjects);
+    tree->objectCodes.resize(noObjects);
+    for (unsigned int i = 0; i < noObjects; i++) {
+        tree->objectCodes[i] = in.read<unsigned int>();
+        if (!readRegion(in, tree->objects[i], table)) {
+            return false;
+        }
+    }
+
+    // nodes index into the objects, so every range must lie inside the list that was read
+    for (Octree::linearNode& n : tree->nodes) {
+        if (n.firstObject > noObjects || n.noObjects > noObjects - n.firstObject) {
+            return false;
+        }
+    }
+
+    return readQueue(in, tree->queue, table);
+}
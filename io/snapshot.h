@@ -0,0 +1,137 @@
+/*****************************************************************
+ *   Author: Tyanna Prince
+ *   Date: 07/15/2023
+ *   Description: An enhancement of my cs330 OpenGL project where I added functionality such as charater movement,
+ *  directional lighting, and shadow mapping, a cubemap, and joystick support.
+ *  copyright (c) 2023 Tyanna Prince
+ *  version 2.0
+ *****************************************************************/
+
+#ifndef SNAPSHOT_H
+#define SNAPSHOT_H
+
+// "SNAP" in the first 4 bytes of every snapshot
+#define SNAPSHOT_MAGIC 0x50414e53
+// increment when the layout changes (older snapshots are rejected)
+#define SNAPSHOT_VERSION 1
+// default location of the world snapshot
+#define SNAPSHOT_DEFAULT_PATH "world.snapshot"
+
+#include <string>
+#include <vector>
+#include <cstring>
+#include <unordered_map>
+
+#include "../algorithms/octree.h"
+#include "../algorithms/linearoctree.h"
+
+/*
+    namespace to tie together reading/writing binary world snapshots
+
+    layout (native byte order)
+    - header: magic, version, octree backend, current instance id
+    - models: id, number of instances, then each instance's rigid body state
+    - octree: every node (pointer backend, preorder) or the flat arrays (linear backend)
+      with instances stored as indices into the model instance lists
+*/
+
+namespace Snapshot {
+    /*
+        class to write binary data into a buffer
+    */
+    class writer {
+    public:
+        // bytes written so far
+        std::vector<char> data;
+
+        // write plain value
+        template <typename T>
+        void write(T val) {
+            const char* bytes = (const char*)&val;
+            data.insert(data.end(), bytes, bytes + sizeof(T));
+        }
+
+        // write length then characters
+        void writeString(std::string str);
+
+        // save buffer to file
+        bool save(std::string path);
+    };
+
+    /*
+        class to read binary data from a file loaded in one block
+    */
+    class reader {
+    public:
+        // contents of the file
+        std::vector<char> data;
+        // position of next read
+        unsigned int cursor = 0;
+        // if a read went past the end of the data
+        bool failed = false;
+
+        // load entire file
+        bool load(std::string path);
+
+        // read plain value (zero if out of data)
+        template <typename T>
+        T read() {
+            T ret;
+            if (failed || cursor + sizeof(T) > data.size()) {
+                failed = true;
+                std::memset(&ret, 0, sizeof(T));
+                return ret;
+            }
+
+            std::memcpy(&ret, &data[cursor], sizeof(T));
+            cursor += sizeof(T);
+            return ret;
+        }
+
+        // read length then characters
+        std::string readString();
+    };
+
+    /*
+        struct to convert instances to indices and back
+    */
+    struct instanceTable {
+        // instances in the order they were written
+        std::vector<RigidBody*> instances;
+        // model of each instance
+        std::vector<Model*> models;
+        // index of each instance
+        std::unordered_map<RigidBody*, unsigned int> indices;
+
+        // add instance at the next index
+        void add(RigidBody* instance, Model* model);
+    };
+
+    /*
+        rigid bodies
+    */
+
+    // write state of instance
+    void writeInstance(writer& out, RigidBody* instance);
+
+    // read state of instance into a new rigid body
+    RigidBody* readInstance(reader& in, std::string modelId);
+
+    /*
+        octrees
+    */
+
+    // write pointer octree
+    void writeTree(writer& out, Octree::node* root, instanceTable& table);
+
+    // read pointer octree into new nodes from the pool (nullptr if the data is bad)
+    Octree::node* readTree(reader& in, instanceTable& table);
+
+    // write linear octree
+    void writeTree(writer& out, Octree::linearTree* tree, instanceTable& table);
+
+    // read linear octree into existing tree (false if the data is bad)
+    bool readTree(reader& in, Octree::linearTree* tree, instanceTable& table);
+}
+
+#endif
@@ -42,8 +42,10 @@
 #include "io/mouse.h"
 #include "io/joystick.h"
 #include "io/camera.h"
+#include "io/snapshot.h"
 
 #include "algorithms/states.hpp"
+#include "algorithms/events.h"
 #include "algorithms/ray.h"
 
 #include "scene.h"
@@ -59,6 +61,7 @@ Camera cam;
 
 double dt = 0.0f; // tme btwn frames
 double lastFrame = 0.0f; // time of last frame
+double coldStartTime = 0.0; // time from loading models to the end of preparation
 
 Sphere sphere(10);
 //Cube cube(10);
@@ -126,6 +129,9 @@ int main() {
     Box box;
     box.init();
 
+    // time the cold start (load, generate, insert and build) to compare with a snapshot restore
+    coldStartTime = glfwGetTime();
+
     // load all model data
     scene.loadModels();
 
@@ -208,6 +214,8 @@ int main() {
 
     // finish preparations (octree, etc)
     scene.prepare(box, { shader });
+    coldStartTime = glfwGetTime() - coldStartTime;
+    scene.variableLog["coldStartTime"] = coldStartTime;
 
     // joystick recognition
     /*mainJ.update();
@@ -319,6 +327,8 @@ void launchItem(float dt) {
         // instance generated successfully
         rb->transferEnergy(25.0f, cam.cameraFront);
         rb->applyAcceleration(Environment::gravitationalAcceleration);
+        // fast enough to pass through the wall between two frames
+        States::activate(&rb->state, INSTANCE_CCD);
     }
 }
 
@@ -335,7 +345,7 @@ void emitRay() {
     Ray r(cam.cameraPos, cam.cameraFront);
 
     float tmin = std::numeric_limits<float>::max();
-    BoundingRegion* intersected = scene.octree->checkCollisionsRay(r, tmin);
+    BoundingRegion* intersected = scene.checkCollisionsRay(r, tmin);
     if (intersected) {
         std::cout << "Hits " << intersected->instance->instanceId << " at t = " << tmin << std::endl;
         scene.markForDeletion(intersected->instance->instanceId);
@@ -378,6 +388,30 @@ void processInput(double dt) {
         launchItem(dt);
     }
 
+    // toggle collision log (written in the background)
+    if (Keyboard::keyWentDown(GLFW_KEY_F3)) {
+        Events::setLogging(!Events::isLogging());
+    }
+
+    // save rollback point
+    if (Keyboard::keyWentDown(GLFW_KEY_F5)) {
+        if (!scene.saveSnapshot(SNAPSHOT_DEFAULT_PATH)) {
+            std::cout << "Could not save snapshot" << std::endl;
+        }
+    }
+
+    // roll back to saved snapshot
+    if (Keyboard::keyWentDown(GLFW_KEY_F9)) {
+        double restoreStart = glfwGetTime();
+        if (scene.loadSnapshot(SNAPSHOT_DEFAULT_PATH)) {
+            std::cout << "Snapshot restored in " << glfwGetTime() - restoreStart
+                << "s (cold start " << coldStartTime << "s)" << std::endl;
+        }
+        else {
+            std::cout << "Could not restore snapshot" << std::endl;
+        }
+    }
+
     // emit ray
     if (Mouse::buttonWentDown(GLFW_MOUSE_BUTTON_1)) {
         emitRay();
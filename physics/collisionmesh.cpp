@@ -11,7 +11,83 @@
 #include "collisionmodel.h"
 #include "rigidbody.h"
 
+#include "../algorithms/gjk.h"
 #include "../algorithms/math/linalg.h"
+#include "../algorithms/simd.h"
+#include "../algorithms/stats.h"
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+
+#include <glm/gtc/matrix_transform.hpp>
+
+/**
+ * Checks if two boxes overlap (touching boxes overlap).
+ *
+ * @param min1 the minimum corner of the first box
+ * @param max1 the maximum corner of the first box
+ * @param min2 the minimum corner of the second box
+ * @param max2 the maximum corner of the second box
+ *
+ * @return true if the boxes overlap on every axis, false otherwise
+ */
+static bool boxesOverlap(const glm::vec3& min1, const glm::vec3& max1, const glm::vec3& min2, const glm::vec3& max2) {
+	return glm::all(glm::lessThanEqual(min1, max2)) && glm::all(glm::lessThanEqual(min2, max1));
+}
+
+/**
+ * Packs a direction into 32 bits: the unit vector is projected onto an octahedron, the octahedron
+ * is unfolded onto a square, and each coordinate on the square is stored in 16 bits.
+ *
+ * @param n the direction (any length)
+ *
+ * @return the packed unit normal
+ */
+static unsigned int packNormal(glm::vec3 n) {
+	float length = std::fabs(n.x) + std::fabs(n.y) + std::fabs(n.z);
+	if (length == 0.0f) {
+		// degenerate face has no plane, any direction will do
+		return packNormal(glm::vec3(0.0f, 0.0f, 1.0f));
+	}
+	n /= length;
+
+	glm::vec2 p(n.x, n.y);
+	if (n.z < 0.0f) {
+		// fold the lower half over the diagonals
+		p.x = (1.0f - std::fabs(n.y)) * (n.x >= 0.0f ? 1.0f : -1.0f);
+		p.y = (1.0f - std::fabs(n.x)) * (n.y >= 0.0f ? 1.0f : -1.0f);
+	}
+
+	// [-1, 1] to [0, PACKED_NORMAL_MAX]
+	unsigned int x = (unsigned int)std::round((p.x * 0.5f + 0.5f) * PACKED_NORMAL_MAX);
+	unsigned int y = (unsigned int)std::round((p.y * 0.5f + 0.5f) * PACKED_NORMAL_MAX);
+	return x | (y << 16);
+}
+
+/**
+ * Unpacks a direction packed by packNormal.
+ *
+ * @param packed the packed unit normal
+ *
+ * @return the unit normal
+ */
+static glm::vec3 unpackNormal(unsigned int packed) {
+	// [0, PACKED_NORMAL_MAX] to [-1, 1]
+	glm::vec2 p(
+		(float)(packed & 0xFFFF) / PACKED_NORMAL_MAX * 2.0f - 1.0f,
+		(float)(packed >> 16) / PACKED_NORMAL_MAX * 2.0f - 1.0f
+	);
+
+	glm::vec3 n(p.x, p.y, 1.0f - std::fabs(p.x) - std::fabs(p.y));
+	if (n.z < 0.0f) {
+		// unfold the lower half
+		n.x = (1.0f - std::fabs(p.y)) * (p.x >= 0.0f ? 1.0f : -1.0f);
+		n.y = (1.0f - std::fabs(p.x)) * (p.y >= 0.0f ? 1.0f : -1.0f);
+	}
+
+	return glm::normalize(n);
+}
 
 /**
  * Checks if the current face collides with another face.
@@ -25,24 +101,30 @@
  *
  * @throws None.
  */
-bool Face::collidesWithFace(RigidBody* thisRB, Face& face, RigidBody* faceRB, glm::vec3& retNorm) {
+bool Face::collidesWithFace(RigidBody* thisRB, const Face& face, RigidBody* faceRB, glm::vec3& retNorm) const {
+	Stats::noFaceTests++;
+
+	// meshes in world space
+	WorldMesh& thisMesh = thisRB->getWorldMesh(this->mesh);
+	WorldMesh& faceMesh = faceRB->getWorldMesh(face.mesh);
+
 	// transform coordinates so that P1 is the origin
-	glm::vec3 P1 = mat4vec3mult(thisRB->model, this->mesh->points[this->i1]);
-	glm::vec3 P2 = mat4vec3mult(thisRB->model, this->mesh->points[this->i2]) - P1;
-	glm::vec3 P3 = mat4vec3mult(thisRB->model, this->mesh->points[this->i3]) - P1;
+	glm::vec3 P1 = thisMesh.points[this->i1];
+	glm::vec3 P2 = thisMesh.points[this->i2] - P1;
+	glm::vec3 P3 = thisMesh.points[this->i3] - P1;
 	glm::vec3 lines[3] = {
 		P2,
 		P3,
 		P3 - P2
 	};
 
-	glm::vec3 thisNorm = thisRB->normalModel * this->norm;
+	glm::vec3 thisNorm = thisMesh.norms[this->index()];
 
-	glm::vec3 U1 = mat4vec3mult(faceRB->model, face.mesh->points[face.i1]) - P1;
-	glm::vec3 U2 = mat4vec3mult(faceRB->model, face.mesh->points[face.i2]) - P1;
-	glm::vec3 U3 = mat4vec3mult(faceRB->model, face.mesh->points[face.i3]) - P1;
+	glm::vec3 U1 = faceMesh.points[face.i1] - P1;
+	glm::vec3 U2 = faceMesh.points[face.i2] - P1;
+	glm::vec3 U3 = faceMesh.points[face.i3] - P1;
 
-	retNorm = faceRB->normalModel * face.norm;
+	retNorm = faceMesh.norms[face.index()];
 
 	// set P1 as the origin
 	P1[0] = 0.0f; P1[1] = 0.0f; P1[2] = 0.0f;
@@ -123,30 +205,35 @@ bool Face::collidesWithFace(RigidBody* thisRB, Face& face, RigidBody* faceRB, gl
  *
  * @param thisRB the RigidBody object
  * @param br the BoundingRegion object
- * @param retNorm the reference to the glm::vec3 object to store the returned normal
+ * @param retNorm the reference to the glm::vec3 object to store the returned normal (facing the center of the sphere)
+ * @param retDepth the reference to the float to store how far the sphere reaches through the plane of the face
  *
  * @return true if the face collides with the sphere, false otherwise
  */
-bool Face::collidesWithSphere(RigidBody* thisRB, BoundingRegion& br, glm::vec3& retNorm) {
+bool Face::collidesWithSphere(RigidBody* thisRB, const BoundingRegion& br, glm::vec3& retNorm, float& retDepth) const {
+	Stats::noSphereTests++;
+
 	if (br.type != BoundTypes::SPHERE) {
 		return false;
 	}
 
 	// apply model transformations
-	glm::vec3 P1 = mat4vec3mult(thisRB->model, this->mesh->points[i1]);
-	glm::vec3 P2 = mat4vec3mult(thisRB->model, this->mesh->points[i2]);
-	glm::vec3 P3 = mat4vec3mult(thisRB->model, this->mesh->points[i3]);
+	WorldMesh& worldMesh = thisRB->getWorldMesh(this->mesh);
+	glm::vec3 P1 = worldMesh.points[i1];
+	glm::vec3 P2 = worldMesh.points[i2];
+	glm::vec3 P3 = worldMesh.points[i3];
 
-	glm::vec3 norm = thisRB->normalModel * this->norm;
-	glm::vec3 unitN = norm / glm::length(norm);
+	glm::vec3 unitN = worldMesh.norms[index()];
+	glm::vec3 norm = unitN;
 
 	glm::vec3 distanceVec = br.center - P1;
 	float distance = glm::dot(distanceVec, unitN);
 
-	if (abs(distance) < br.radius) {
+	if (std::fabs(distance) < br.radius) {
 		glm::vec3 circCenter = br.center + distance * unitN;
 
-		retNorm = unitN;
+		retNorm = distance < 0.0f ? -unitN : unitN;
+		retDepth = br.radius - std::fabs(distance);
 
 		return faceContainsPointRange(P2 - P1, P3 - P1, norm, circCenter - P1, br.radius);
 	}
@@ -154,59 +241,604 @@ bool Face::collidesWithSphere(RigidBody* thisRB, BoundingRegion& br, glm::vec3&
 	return false;
 }
 
+/**
+ * Finds the first time a sphere moving in a straight line touches the face.
+ *
+ * @param thisRB the RigidBody object of the face
+ * @param start the center of the sphere at the start of the motion
+ * @param end the center of the sphere at the end of the motion
+ * @param radius the radius of the sphere
+ * @param t the time of impact as a fraction of the motion, only written on a hit
+ * @param retNorm the reference to the glm::vec3 object to store the normal at the contact
+ *
+ * @return true if the sphere touches the face during the motion, false otherwise
+ */
+bool Face::sweepSphere(RigidBody* thisRB, glm::vec3 start, glm::vec3 end, float radius, float& t, glm::vec3& retNorm) const {
+	Stats::noSphereTests++;
+
+	// apply model transformations
+	WorldMesh& worldMesh = thisRB->getWorldMesh(this->mesh);
+	glm::vec3 P[3] = {
+		worldMesh.points[i1],
+		worldMesh.points[i2],
+		worldMesh.points[i3]
+	};
+
+	glm::vec3 unitN = worldMesh.norms[index()];
+	glm::vec3 norm = unitN;
+	glm::vec3 motion = end - start;
+
+	// signed distance from the plane at the start and end
+	float d0 = glm::dot(start - P[0], unitN);
+	float d1 = glm::dot(end - P[0], unitN);
+	if ((d0 > radius && d1 > radius) || (d0 < -radius && d1 < -radius)) {
+		// stays on one side of the plane
+		return false;
+	}
+
+	// time the sphere reaches the plane
+	float side = d0 >= 0.0f ? 1.0f : -1.0f;
+	float tPlane = std::fabs(d0) > radius ? (d0 - side * radius) / (d0 - d1) : 0.0f;
+
+	// point of the plane touched first
+	glm::vec3 center = start + tPlane * motion;
+	glm::vec3 contact = center - glm::dot(center - P[0], unitN) * unitN;
+	if (faceContainsPoint(P[1] - P[0], P[2] - P[0], norm, contact - P[0])) {
+		t = tPlane;
+		retNorm = side * unitN;
+		return true;
+	}
+
+	// otherwise the sphere can only touch the face on an edge or a corner
+	float tmin = std::numeric_limits<float>::max();
+	float tmp = 0.0f;
+	for (int i = 0; i < 3; i++) {
+		glm::vec3 A = P[i];
+		glm::vec3 B = P[(i + 1) % 3];
+
+		if (sweepSphereSegment(start, motion, radius, A, B, tmp) && tmp < tmin) {
+			tmin = tmp;
+
+			// normal from the closest point on the edge
+			center = start + tmin * motion;
+			glm::vec3 edge = B - A;
+			retNorm = center - (A + glm::dot(center - A, edge) / glm::dot(edge, edge) * edge);
+		}
+		if (sweepSpherePoint(start, motion, radius, A, tmp) && tmp < tmin) {
+			tmin = tmp;
+			retNorm = start + tmin * motion - A;
+		}
+	}
+
+	if (tmin > 1.0f) {
+		return false;
+	}
+
+	t = tmin;
+	if (glm::dot(retNorm, retNorm) == 0.0f) {
+		// center exactly on the edge
+		retNorm = side * unitN;
+	}
+	return true;
+}
+
+/**
+ * Finds the position of the face in the list of its mesh.
+ *
+ * @return the index of the face (also the index of its normal in a world space mesh)
+ */
+unsigned int Face::index() const {
+	return idx;
+}
+
 CollisionMesh::CollisionMesh(unsigned int noPoints, float* coordinates,
 	unsigned int noFaces, unsigned int* indices)
-	: points(noPoints), faces(noFaces) {
+	: origin(0.0f), scale(0.0f), points(noPoints), noFaces(noFaces) {
 	glm::vec3 min(std::numeric_limits<float>::infinity());
 	glm::vec3 max = -1.0f * min;
 
-	// insert all points into list
+	// find the bounds of the points
 	for (unsigned int i = 0; i < noPoints; i++) {
-		points[i] = { coordinates[i * 3 + 0], coordinates[i * 3 + 1], coordinates[i * 3 + 2] };
-
 		for (int j = 0; j < 3; j++) {
-			if (points[i][j] < min[j]) {
+			float coordinate = coordinates[i * 3 + j];
+
+			if (coordinate < min[j]) {
 				// found a new minimum
-				min[j] = points[i][j];
+				min[j] = coordinate;
 			}
-			if (points[i][j] > max[j]) {
+			if (coordinate > max[j]) {
 				// found a new maximum
-				max[j] = points[i][j];
+				max[j] = coordinate;
 			}
 		}
 	}
 
-	glm::vec3 center = (min + max) / 2.0f;
+	// quantize the points in the bounds (every point of a flat axis is at the minimum)
+	if (noPoints != 0) {
+		origin = min;
+		scale = (max - min) / (float)QUANTIZED_POINT_MAX;
+	}
+	for (unsigned int i = 0; i < noPoints; i++) {
+		unsigned short quantized[3];
+		for (int j = 0; j < 3; j++) {
+			float fraction = scale[j] > 0.0f ? (coordinates[i * 3 + j] - origin[j]) / scale[j] : 0.0f;
+			quantized[j] = (unsigned short)std::fminf(std::fmaxf(std::round(fraction), 0.0f), (float)QUANTIZED_POINT_MAX);
+		}
+		points[i] = { quantized[0], quantized[1], quantized[2] };
+	}
 
-	float maxRadiusSquared = 0.0f;
+	// smallest sphere around the points as stored
+	std::vector<glm::vec3> decoded(noPoints);
 	for (unsigned int i = 0; i < noPoints; i++) {
-		float radiusSquared = 0.0f;
+		decoded[i] = getPoint(i);
+	}
+
+	this->br = BoundingRegion::calculateMinimalSphere(decoded);
+	this->br.collisionMesh = this;
+
+	// build tree of faces (sorts the faces)
+	std::vector<glm::uvec3> triangles(noFaces);
+	for (unsigned int i = 0; i < noFaces; i++) {
+		triangles[i] = { indices[i * 3 + 0], indices[i * 3 + 1], indices[i * 3 + 2] };
+	}
+	if (noFaces != 0) {
+		nodes.push_back({ 0, noFaces, 0 });
+		subdivide(0, triangles);
+	}
+
+	// pack the indices and face normals
+	if (noPoints <= SHORT_INDEX_POINTS) {
+		shortIndices.resize(noFaces * 3);
+	}
+	else {
+		longIndices.resize(noFaces * 3);
+	}
+	norms.resize(noFaces);
+	for (unsigned int i = 0; i < noFaces; i++) {
 		for (int j = 0; j < 3; j++) {
-			radiusSquared += (points[i][j] - center[j]) * (points[i][j] - center[j]);
+			if (shortIndices.size() != 0) {
+				shortIndices[i * 3 + j] = (unsigned short)triangles[i][j];
+			}
+			else {
+				longIndices[i * 3 + j] = triangles[i][j];
+			}
+		}
+
+		// normal from the points as given (not yet rounded)
+		float* P1 = coordinates + triangles[i][0] * 3;
+		float* P2 = coordinates + triangles[i][1] * 3;
+		float* P3 = coordinates + triangles[i][2] * 3;
+		glm::vec3 A(P2[0] - P1[0], P2[1] - P1[1], P2[2] - P1[2]); // A = P2 - P1
+		glm::vec3 B(P3[0] - P1[0], P3[1] - P1[1], P3[2] - P1[2]); // B = P3 - P1
+		norms[i] = packNormal(glm::cross(A, B)); // N = A x B
+	}
+
+	convex = calculateConvex();
+}
+
+/**
+ * Unpacks a point of the mesh.
+ *
+ * @param i the index of the point
+ *
+ * @return the point in model space
+ */
+glm::vec3 CollisionMesh::getPoint(unsigned int i) const {
+	const PackedPoint& p = points[i];
+	return origin + scale * glm::vec3(p.x, p.y, p.z);
+}
+
+/**
+ * Unpacks the normal of a face of the mesh.
+ *
+ * @param i the index of the face
+ *
+ * @return the unit normal of the face in model space
+ */
+glm::vec3 CollisionMesh::getNormal(unsigned int i) const {
+	return unpackNormal(norms[i]);
+}
+
+/**
+ * Unpacks the indices of a face of the mesh.
+ *
+ * @param i the index of the face
+ *
+ * @return the face (only valid while the mesh exists)
+ */
+Face CollisionMesh::getFace(unsigned int i) {
+	if (shortIndices.size() != 0) {
+		return { this, shortIndices[i * 3 + 0], shortIndices[i * 3 + 1], shortIndices[i * 3 + 2], i };
+	}
+
+	return { this, longIndices[i * 3 + 0], longIndices[i * 3 + 1], longIndices[i * 3 + 2], i };
+}
+
+/**
+ * Checks if the mesh is a convex solid: every point is on one side of the plane of each face,
+ * and not every point is on the same plane (flat meshes such as walls are not solids).
+ *
+ * @return true if the mesh is convex, false otherwise
+ */
+bool CollisionMesh::calculateConvex() {
+	float tolerance = CONVEX_TOLERANCE * br.radius;
+	bool solid = false;
+
+	// points as stored
+	std::vector<glm::vec3> unpacked(points.size());
+	for (unsigned int i = 0, len = points.size(); i < len; i++) {
+		unpacked[i] = getPoint(i);
+	}
+
+	for (unsigned int i = 0; i < noFaces; i++) {
+		Face face = getFace(i);
+
+		// plane through the points as stored
+		glm::vec3 P1 = unpacked[face.i1];
+		glm::vec3 norm = glm::cross(unpacked[face.i2] - P1, unpacked[face.i3] - P1);
+		float length = glm::length(norm);
+		if (length == 0.0f) {
+			// degenerate face has no plane
+			continue;
 		}
-		if (radiusSquared > maxRadiusSquared) {
-			maxRadiusSquared = radiusSquared;
+		glm::vec3 unitN = norm / length;
+
+		// range of distances in front of the plane
+		float minDistance = 0.0f, maxDistance = 0.0f;
+		for (glm::vec3& point : unpacked) {
+			float distance = glm::dot(point - P1, unitN);
+			minDistance = std::fminf(minDistance, distance);
+			maxDistance = std::fmaxf(maxDistance, distance);
+
+			if (minDistance < -tolerance && maxDistance > tolerance) {
+				// points on both sides
+				return false;
+			}
+		}
+
+		if (minDistance < -tolerance || maxDistance > tolerance) {
+			// a point off this plane
+			solid = true;
 		}
 	}
 
-	this->br = BoundingRegion(center, sqrt(maxRadiusSquared));
-	this->br.collisionMesh = this;
+	return solid;
+}
+
+/**
+ * Splits a node of the face tree at the median face center along the longest axis of the centers, then splits its children.
+ *
+ * @param idx the index of the node in the tree
+ * @param triangles the indices of each face, sorted with the tree
+ */
+void CollisionMesh::subdivide(unsigned int idx, std::vector<glm::uvec3>& triangles) {
+	unsigned int firstFace = nodes[idx].firstFace;
+	unsigned int noFaces = nodes[idx].noFaces;
+
+	if (noFaces <= FACE_TREE_MAX_LEAF_FACES) {
+		// few enough faces to test one by one
+		return;
+	}
+
+	// sum of the points of a face (three times its center)
+	auto center = [this](const glm::uvec3& f) -> glm::vec3 {
+		return getPoint(f[0]) + getPoint(f[1]) + getPoint(f[2]);
+	};
+
+	// range of the face centers
+	glm::vec3 min(std::numeric_limits<float>::max());
+	glm::vec3 max(std::numeric_limits<float>::lowest());
+	for (unsigned int i = firstFace, end = firstFace + noFaces; i < end; i++) {
+		glm::vec3 c = center(triangles[i]);
+		min = glm::min(min, c);
+		max = glm::max(max, c);
+	}
+
+	// split along the longest axis
+	glm::vec3 extent = max - min;
+	int axis = 0;
+	if (extent[1] > extent[axis]) {
+		axis = 1;
+	}
+	if (extent[2] > extent[axis]) {
+		axis = 2;
+	}
 
-	// calculate face normals
+	if (extent[axis] == 0.0f) {
+		// all faces share a center, cannot be split
+		return;
+	}
+
+	// half of the faces on each side of the median
+	unsigned int noLeft = noFaces / 2;
+	std::nth_element(triangles.begin() + firstFace, triangles.begin() + firstFace + noLeft, triangles.begin() + firstFace + noFaces,
+		[&](const glm::uvec3& a, const glm::uvec3& b) { return center(a)[axis] < center(b)[axis]; });
+
+	unsigned int left = nodes.size();
+	nodes[idx].left = left;
+	nodes.push_back({ firstFace, noLeft, 0 });
+	nodes.push_back({ firstFace + noLeft, noFaces - noLeft, 0 });
+
+	subdivide(left, triangles);
+	subdivide(left + 1, triangles);
+}
+
+/**
+ * Transforms the points, face normals and boxes of the face tree into world space for an instance.
+ *
+ * @param rb the RigidBody object of the instance
+ * @param worldMesh the mesh in world space to overwrite
+ */
+void CollisionMesh::transform(RigidBody* rb, WorldMesh& worldMesh) {
+	worldMesh.points.resize(points.size());
+	worldMesh.norms.resize(noFaces);
+	worldMesh.mins.resize(nodes.size());
+	worldMesh.maxs.resize(nodes.size());
+
+	// apply model transformations (unpacks the points on the way, point = origin + scale * quantized point)
+	glm::mat4 unpackModel = rb->model * glm::scale(glm::translate(glm::mat4(1.0f), origin), scale);
+	for (unsigned int i = 0, len = points.size(); i < len; i++) {
+		glm::vec3 quantized(points[i].x, points[i].y, points[i].z);
+		worldMesh.points[i] = mat4vec3mult(unpackModel, quantized);
+	}
 	for (unsigned int i = 0; i < noFaces; i++) {
-		unsigned int i1 = indices[i * 3 + 0];
-		unsigned int i2 = indices[i * 3 + 1];
-		unsigned int i3 = indices[i * 3 + 2];
-
-		glm::vec3 A = points[i2] - points[i1]; // A = P2 - P1
-		glm::vec3 B = points[i3] - points[i1]; // B = P3 - P1
-		glm::vec3 N = glm::cross(A, B); // N = A x B
-
-		faces[i] = {
-			this,
-			i1, i2, i3,	// indices making up the triangle
-			N,			// normal placeholder
-			N			// normal placeholder
-		};
+		worldMesh.norms[i] = glm::normalize(rb->normalModel * getNormal(i));
+	}
+
+	// transpose the faces for the ray kernel (padding is empty faces, which no ray hits)
+	unsigned int noLanes = noFaces + SIMD_WIDTH - 1;
+	for (int j = 0; j < 3; j++) {
+		worldMesh.corners[j].assign(noLanes, 0.0f);
+		worldMesh.edges1[j].assign(noLanes, 0.0f);
+		worldMesh.edges2[j].assign(noLanes, 0.0f);
+	}
+	for (unsigned int i = 0; i < noFaces; i++) {
+		Face face = getFace(i);
+		glm::vec3 P1 = worldMesh.points[face.i1];
+		glm::vec3 E1 = worldMesh.points[face.i2] - P1;
+		glm::vec3 E2 = worldMesh.points[face.i3] - P1;
+		for (int j = 0; j < 3; j++) {
+			worldMesh.corners[j][i] = P1[j];
+			worldMesh.edges1[j][i] = E1[j];
+			worldMesh.edges2[j][i] = E2[j];
+		}
+	}
+
+	// fit the boxes bottom-up (children always come after their parent)
+	for (int i = (int)nodes.size() - 1; i >= 0; i--) {
+		FaceNode& n = nodes[i];
+
+		if (n.left == 0) {
+			// leaf, fit around the points of its faces
+			glm::vec3 min(std::numeric_limits<float>::max());
+			glm::vec3 max(std::numeric_limits<float>::lowest());
+			for (unsigned int j = n.firstFace, end = j + n.noFaces; j < end; j++) {
+				Face face = getFace(j);
+				unsigned int idxs[3] = { face.i1, face.i2, face.i3 };
+				for (unsigned int k = 0; k < 3; k++) {
+					min = glm::min(min, worldMesh.points[idxs[k]]);
+					max = glm::max(max, worldMesh.points[idxs[k]]);
+				}
+			}
+
+			glm::vec3 padding = (glm::abs(min) + glm::abs(max)) * FACE_TREE_PADDING;
+			worldMesh.mins[i] = min - padding;
+			worldMesh.maxs[i] = max + padding;
+		}
+		else {
+			// fit around both children
+			worldMesh.mins[i] = glm::min(worldMesh.mins[n.left], worldMesh.mins[n.left + 1]);
+			worldMesh.maxs[i] = glm::max(worldMesh.maxs[n.left], worldMesh.maxs[n.left + 1]);
+		}
+	}
+}
+
+/**
+ * Finds a face colliding with a face of another mesh by walking both face trees.
+ * Pairs of convex meshes are tested with GJK instead.
+ *
+ * @param thisRB the RigidBody object of this mesh
+ * @param mesh the other mesh
+ * @param meshRB the RigidBody object of the other mesh
+ * @param retNorm the reference to the glm::vec3 object to store the direction pushing the other mesh out of this one
+ *                (the normal of the face hit in the other mesh, or the penetration normal for convex pairs)
+ * @param retDepth the reference to the float to store how far the other mesh has to move out
+ *                 (0 for face pairs, only convex pairs find the depth)
+ * @param retFace the reference to the int to store the index of the face hit in this mesh (-1 for convex pairs)
+ * @param retMeshFace the reference to the int to store the index of the face hit in the other mesh (-1 for convex pairs)
+ *
+ * @return true if the meshes collide, false otherwise
+ */
+bool CollisionMesh::collidesWithMesh(RigidBody* thisRB, CollisionMesh* mesh, RigidBody* meshRB, glm::vec3& retNorm, float& retDepth,
+	int& retFace, int& retMeshFace) {
+	if (nodes.size() == 0 || mesh->nodes.size() == 0) {
+		return false;
+	}
+
+	// meshes in world space
+	WorldMesh& thisMesh = thisRB->getWorldMesh(this);
+	WorldMesh& otherMesh = meshRB->getWorldMesh(mesh);
+
+	if (convex && mesh->convex) {
+		// both convex, test the points (GJK/EPA)
+		retFace = retMeshFace = -1;
+		return GJK::collide(thisMesh.points, otherMesh.points, retNorm, retDepth);
+	}
+
+	// pairs of nodes (this tree, other tree) to visit
+	std::vector<std::pair<unsigned int, unsigned int>> stack;
+	stack.push_back({ 0, 0 });
+
+	while (stack.size() != 0) {
+		unsigned int a = stack.back().first;
+		unsigned int b = stack.back().second;
+		stack.pop_back();
+
+		if (!boxesOverlap(thisMesh.mins[a], thisMesh.maxs[a], otherMesh.mins[b], otherMesh.maxs[b])) {
+			// branches cannot touch
+			continue;
+		}
+
+		FaceNode& nodeA = nodes[a];
+		FaceNode& nodeB = mesh->nodes[b];
+
+		if (nodeA.left == 0 && nodeB.left == 0) {
+			// both leaves, check their faces against each other
+			for (unsigned int i = nodeA.firstFace, endA = i + nodeA.noFaces; i < endA; i++) {
+				Face face = getFace(i);
+				for (unsigned int j = nodeB.firstFace, endB = j + nodeB.noFaces; j < endB; j++) {
+					if (face.collidesWithFace(thisRB, mesh->getFace(j), meshRB, retNorm)) {
+						// face normals face either way, point away from this instance
+						if (glm::dot(retNorm, meshRB->pos - thisRB->pos) < 0.0f) {
+							retNorm = -retNorm;
+						}
+						retDepth = 0.0f;
+						retFace = i;
+						retMeshFace = j;
+						return true;
+					}
+				}
+			}
+			continue;
+		}
+
+		// split the larger branch (or the one that is not a leaf)
+		if (nodeB.left == 0 || (nodeA.left != 0 && nodeA.noFaces >= nodeB.noFaces)) {
+			stack.push_back({ nodeA.left + 1, b });
+			stack.push_back({ nodeA.left, b });
+		}
+		else {
+			stack.push_back({ a, nodeB.left + 1 });
+			stack.push_back({ a, nodeB.left });
+		}
+	}
+
+	return false;
+}
+
+/**
+ * Finds a face colliding with a sphere by walking the face tree.
+ *
+ * @param thisRB the RigidBody object of the mesh
+ * @param br the BoundingRegion object (a box is tested as the sphere around it)
+ * @param retNorm the reference to the glm::vec3 object to store the normal of the face hit (facing the center of the sphere)
+ * @param retDepth the reference to the float to store how far the sphere reaches through the face
+ * @param retFace the reference to the int to store the index of the face hit
+ *
+ * @return true if any face collides with the sphere, false otherwise
+ */
+bool CollisionMesh::collidesWithSphere(RigidBody* thisRB, const BoundingRegion& br, glm::vec3& retNorm, float& retDepth, int& retFace) {
+	if (nodes.size() == 0) {
+		return false;
+	}
+	if (br.type == BoundTypes::AABB) {
+		// instance bounded by a box
+		BoundingRegion sphere(br.calculateCenter(), glm::length(br.calculateDimensions()) / 2.0f);
+		sphere.instance = br.instance;
+		sphere.collisionMesh = br.collisionMesh;
+		return collidesWithSphere(thisRB, sphere, retNorm, retDepth, retFace);
+	}
+
+	WorldMesh& worldMesh = thisRB->getWorldMesh(this);
+	float radiusSquared = br.radius * br.radius;
+
+	// nodes to visit
+	std::vector<unsigned int> stack;
+	stack.push_back(0);
+
+	while (stack.size() != 0) {
+		unsigned int idx = stack.back();
+		stack.pop_back();
+
+		// distance from the center to the closest point of the box
+		glm::vec3 distanceVec = glm::clamp(br.center, worldMesh.mins[idx], worldMesh.maxs[idx]) - br.center;
+		if (glm::dot(distanceVec, distanceVec) > radiusSquared) {
+			// branch out of reach
+			continue;
+		}
+
+		FaceNode& n = nodes[idx];
+		if (n.left == 0) {
+			// leaf, check faces
+			for (unsigned int i = n.firstFace, end = i + n.noFaces; i < end; i++) {
+				if (getFace(i).collidesWithSphere(thisRB, br, retNorm, retDepth)) {
+					retFace = i;
+					return true;
+				}
+			}
+			continue;
+		}
+
+		stack.push_back(n.left + 1);
+		stack.push_back(n.left);
+	}
+
+	return false;
+}
+
+/**
+ * Finds the first face a sphere moving in a straight line runs into (faces it moves away from are ignored).
+ *
+ * @param thisRB the RigidBody object of the mesh
+ * @param start the center of the sphere at the start of the motion
+ * @param end the center of the sphere at the end of the motion
+ * @param radius the radius of the sphere
+ * @param t the time of impact as a fraction of the motion, only written on a hit
+ * @param retNorm the reference to the glm::vec3 object to store the normal at the contact
+ *
+ * @return true if the sphere runs into a face during the motion, false otherwise
+ */
+bool CollisionMesh::sweepSphere(RigidBody* thisRB, glm::vec3 start, glm::vec3 end, float radius, float& t, glm::vec3& retNorm) {
+	if (nodes.size() == 0) {
+		return false;
+	}
+
+	WorldMesh& worldMesh = thisRB->getWorldMesh(this);
+
+	// box around the path of the sphere
+	glm::vec3 sweptMin = glm::min(start, end) - glm::vec3(radius);
+	glm::vec3 sweptMax = glm::max(start, end) + glm::vec3(radius);
+	glm::vec3 motion = end - start;
+
+	bool hit = false;
+	float tmin = std::numeric_limits<float>::max();
+	float tmp = 0.0f;
+	glm::vec3 norm;
+
+	// nodes to visit
+	std::vector<unsigned int> stack;
+	stack.push_back(0);
+
+	while (stack.size() != 0) {
+		unsigned int idx = stack.back();
+		stack.pop_back();
+
+		if (!boxesOverlap(worldMesh.mins[idx], worldMesh.maxs[idx], sweptMin, sweptMax)) {
+			// branch off the path
+			continue;
+		}
+
+		FaceNode& n = nodes[idx];
+		if (n.left == 0) {
+			// leaf, check faces
+			for (unsigned int i = n.firstFace, last = i + n.noFaces; i < last; i++) {
+				if (getFace(i).sweepSphere(thisRB, start, end, radius, tmp, norm) &&
+					tmp < tmin && glm::dot(norm, motion) < 0.0f) {
+					// found closer contact (moving into the face)
+					tmin = tmp;
+					retNorm = norm;
+					hit = true;
+				}
+			}
+			continue;
+		}
+
+		stack.push_back(n.left + 1);
+		stack.push_back(n.left);
+	}
+
+	if (hit) {
+		t = tmin;
 	}
+	return hit;
 }
\ No newline at end of file
@@ -10,6 +10,19 @@
 #ifndef COLLISIONMESH_H
 #define COLLISIONMESH_H
 
+// nodes of the face tree with at most this many faces are not split
+#define FACE_TREE_MAX_LEAF_FACES 4
+// leaf boxes are padded by this fraction of their coordinates, so rounding never prunes touching faces
+#define FACE_TREE_PADDING 1e-5f
+// points this fraction of the bounding radius in front of a face still count as on its plane (convexity test)
+#define CONVEX_TOLERANCE 1e-4f
+// largest quantized coordinate (the maximum of the bounds of the mesh along an axis)
+#define QUANTIZED_POINT_MAX 65535
+// meshes with at most this many points store their indices in 16 bits
+#define SHORT_INDEX_POINTS 65536
+// largest packed normal coordinate (even, so the axes are stored exactly)
+#define PACKED_NORMAL_MAX 65534
+
 #include <vector>
 
 #include "../algorithms/bounds.h"
@@ -19,26 +32,98 @@ class CollisionModel;
 class CollisionMesh;
 class RigidBody;
 
+/*
+	struct to represent a point quantized in the bounds of its mesh
+	- each coordinate is the fraction of the way from the minimum to the maximum, 0 to QUANTIZED_POINT_MAX
+*/
+
+typedef struct PackedPoint {
+	unsigned short x, y, z;
+} PackedPoint;
+
+/*
+	struct to represent a face of a mesh
+	- the mesh stores its faces packed (CollisionMesh::getFace unpacks one to test)
+*/
+
 typedef struct Face {
 	CollisionMesh* mesh;
 	unsigned int i1, i2, i3;
 
-	glm::vec3 baseNormal;
-	glm::vec3 norm;
+	// position in the list of the mesh
+	unsigned int idx;
 
-	bool collidesWithFace(RigidBody* thisRB, struct Face& face, RigidBody* faceRB, glm::vec3& retNorm);
-	bool collidesWithSphere(RigidBody* thisRB, BoundingRegion& br, glm::vec3& retNorm);
+	bool collidesWithFace(RigidBody* thisRB, const struct Face& face, RigidBody* faceRB, glm::vec3& retNorm) const;
+	bool collidesWithSphere(RigidBody* thisRB, const BoundingRegion& br, glm::vec3& retNorm, float& retDepth) const;
+	bool sweepSphere(RigidBody* thisRB, glm::vec3 start, glm::vec3 end, float radius, float& t, glm::vec3& retNorm) const;
+
+	unsigned int index() const;
 } Face;
 
+/*
+	struct to represent each node in the tree of faces
+	- boxes are kept in world space by each instance (WorldMesh)
+*/
+
+typedef struct FaceNode {
+	// faces in the branch are contiguous in the face list
+	unsigned int firstFace;
+	unsigned int noFaces;
+
+	// index of left child (right child follows it), 0 for leaves
+	unsigned int left;
+} FaceNode;
+
 class CollisionMesh {
 public:
 	CollisionModel* model;
 	BoundingRegion br;
 
-	std::vector<glm::vec3> points;
-	std::vector<Face> faces;
+	// points quantized in the bounds of the mesh (point = origin + scale * quantized point)
+	glm::vec3 origin;
+	glm::vec3 scale;
+	std::vector<PackedPoint> points;
+
+	// faces sorted so the faces of every branch of the tree are contiguous
+	unsigned int noFaces;
+	// three indices per face, 16-bit when the points fit (SHORT_INDEX_POINTS), 32-bit otherwise (the other list is empty)
+	std::vector<unsigned short> shortIndices;
+	std::vector<unsigned int> longIndices;
+	// unit normal of each face (octahedral, 16 bits per component)
+	std::vector<unsigned int> norms;
+
+	// tree of faces (root first, children always after their parent)
+	std::vector<FaceNode> nodes;
+
+	// closed convex shape (pairs of convex meshes are tested with GJK instead of face by face)
+	bool convex;
 
 	CollisionMesh(unsigned int noPoints, float* coordinates, unsigned int noFaces, unsigned int* indices);
+
+	// unpack a point in model space
+	glm::vec3 getPoint(unsigned int i) const;
+	// unpack the unit normal of a face in model space
+	glm::vec3 getNormal(unsigned int i) const;
+	// unpack the indices of a face
+	Face getFace(unsigned int i);
+
+	// transform the points, normals and boxes of the tree into world space for an instance
+	void transform(RigidBody* rb, WorldMesh& worldMesh);
+
+	// find a face colliding with a face of another mesh (walks both trees, or GJK if both are convex)
+	bool collidesWithMesh(RigidBody* thisRB, CollisionMesh* mesh, RigidBody* meshRB, glm::vec3& retNorm, float& retDepth,
+		int& retFace, int& retMeshFace);
+	// find a face colliding with a sphere
+	bool collidesWithSphere(RigidBody* thisRB, const BoundingRegion& br, glm::vec3& retNorm, float& retDepth, int& retFace);
+	// find the first face a sphere moving from start to end runs into
+	bool sweepSphere(RigidBody* thisRB, glm::vec3 start, glm::vec3 end, float radius, float& t, glm::vec3& retNorm);
+
+	// check if every point is on one side of the plane of each face (and the points are not all in one plane)
+	bool calculateConvex();
+
+private:
+	// split the node at idx at the median face center along its longest axis, then its children
+	void subdivide(unsigned int idx, std::vector<glm::uvec3>& triangles);
 };
 
 #endif
\ No newline at end of file
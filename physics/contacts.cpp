@@ -0,0 +1,197 @@
+/*****************************************************************
+ *   Author: Tyanna Prince
+ *   Date: 07/15/2023
+ *   Description: An enhancement of my cs330 OpenGL project where I added functionality such as charater movement,
+ *  directional lighting, and shadow mapping, a cubemap, and joystick support.
+ *  copyright (c) 2023 Tyanna Prince
+ *  version 2.0
+ *****************************************************************/
+
+#include "contacts.h"
+#include "rigidbody.h"
+#include "../algorithms/states.hpp"
+
+#include <cmath>
+#include <functional>
+
+/*
+    contact cache
+*/
+
+std::map<std::pair<RigidBody*, RigidBody*>, Contacts::manifold> Contacts::manifolds;
+unsigned int Contacts::noWarmStarted = 0;
+
+// apply an impulse along the normal to both instances of a contact (pushes b away from a)
+static void applyImpulse(Contacts::manifold& m, float impulse) {
+    m.a->velocity -= m.norm * (impulse * m.invMassA);
+    m.b->velocity += m.norm * (impulse * m.invMassB);
+}
+
+// relative speed of b away from a along the normal (negative while closing)
+static float calculateNormalSpeed(Contacts::manifold& m) {
+    return glm::dot(m.b->velocity - m.a->velocity, m.norm);
+}
+
+// push the pair of a contact apart until b leaves a at the target speed
+// - total is the impulse applied so far, contacts can only push so it may drop to 0 but not below
+static void solveContact(Contacts::manifold& m, float targetSpeed, float& total) {
+    float invMassSum = m.invMassA + m.invMassB;
+    if (invMassSum == 0.0f) {
+        // neither instance can move
+        return;
+    }
+
+    float impulse = (targetSpeed - calculateNormalSpeed(m)) / invMassSum;
+    float newTotal = std::fmaxf(total + impulse, 0.0f);
+    applyImpulse(m, newTotal - total);
+    total = newTotal;
+}
+
+// inverse of the mass of an instance (0 for instances that collisions do not move)
+float Contacts::calculateInverseMass(RigidBody* rb) {
+    if (States::isActive(&rb->state, INSTANCE_STATIC) || rb->mass <= 0.0f) {
+        return 0.0f;
+    }
+
+    return 1.0f / rb->mass;
+}
+
+// record that b touches a (norm points from a toward b)
+void Contacts::addContact(RigidBody* a, RigidBody* b, glm::vec3 norm, float depth) {
+    float length = glm::length(norm);
+    if (length == 0.0f) {
+        // centers on top of each other, any direction will do
+        norm = glm::vec3(0.0f, 1.0f, 0.0f);
+    }
+    else {
+        norm /= length;
+    }
+
+    // one entry per pair regardless of which instance reported it
+    if (std::less<RigidBody*>()(b, a)) {
+        std::swap(a, b);
+        norm = -norm;
+    }
+
+    std::pair<RigidBody*, RigidBody*> key(a, b);
+    auto it = manifolds.find(key);
+    if (it == manifolds.end()) {
+        // new contact (the solve values are filled in by solve)
+        manifolds[key] = { a, b, norm, std::fmaxf(depth, 0.0f), 0.0f, 0.0f, true, 0.0f, 0.0f, 0.0f };
+        return;
+    }
+
+    manifold& m = it->second;
+    if (m.touched) {
+        // reported again this frame (both instances moved), keep the deeper overlap
+        if (depth > m.depth) {
+            m.norm = norm;
+            m.depth = depth;
+        }
+        return;
+    }
+
+    // still touching since last frame
+    if (glm::dot(m.norm, norm) < CONTACT_WARM_START_COS) {
+        // turned too far for the old impulse to be a good guess
+        m.normalImpulse = 0.0f;
+    }
+    m.norm = norm;
+    m.depth = std::fmaxf(depth, 0.0f);
+    m.touched = true;
+}
+
+// resolve the contacts reported this frame and forget the pairs that separated
+void Contacts::solve() {
+    noWarmStarted = 0;
+    bool bouncing = false;
+
+    // prepare each contact with the speeds the step left the instances with
+    for (auto it = manifolds.begin(); it != manifolds.end();) {
+        manifold& m = it->second;
+        if (!m.touched) {
+            // separated
+            it = manifolds.erase(it);
+            continue;
+        }
+
+        m.invMassA = calculateInverseMass(m.a);
+        m.invMassB = calculateInverseMass(m.b);
+
+        // bounce off fast impacts, come to rest on slow ones
+        float speed = calculateNormalSpeed(m);
+        m.targetSpeed = speed < -CONTACT_BOUNCE_THRESHOLD
+            ? -CONTACT_RESTITUTION * speed
+            : 0.0f;
+        m.bounceImpulse = 0.0f;
+        bouncing |= m.targetSpeed > 0.0f;
+
+        it++;
+    }
+
+    // apply the impulse from last frame
+    for (auto& pair : manifolds) {
+        manifold& m = pair.second;
+        if (m.normalImpulse > 0.0f && m.invMassA + m.invMassB > 0.0f) {
+            applyImpulse(m, m.normalImpulse);
+            noWarmStarted++;
+        }
+    }
+
+    // sequential impulses, each contact corrects the speed the others left it with
+    // - stops every pair closing, this impulse is what resting pairs need again next frame
+    for (int i = 0; i < CONTACT_ITERATIONS; i++) {
+        for (auto& pair : manifolds) {
+            solveContact(pair.second, 0.0f, pair.second.normalImpulse);
+        }
+    }
+
+    // bounces are solved on top (kept out of the warm start, a bounce does not repeat next frame)
+    for (int i = 0; bouncing && i < CONTACT_ITERATIONS; i++) {
+        for (auto& pair : manifolds) {
+            solveContact(pair.second, pair.second.targetSpeed, pair.second.bounceImpulse);
+        }
+    }
+
+    // move the instances out of the remaining overlap (lighter instances move further)
+    // - prevPos is kept so CCD sweeps across the correction, the moved switch has the indices transform the regions
+    for (auto& pair : manifolds) {
+        manifold& m = pair.second;
+        float invMassSum = m.invMassA + m.invMassB;
+        if (invMassSum > 0.0f && m.depth > CONTACT_SLOP) {
+            float correction = CONTACT_CORRECTION * (m.depth - CONTACT_SLOP) / invMassSum;
+
+            if (m.invMassA > 0.0f) {
+                m.a->pos -= m.norm * (correction * m.invMassA);
+                m.a->updateTransform();
+                States::activate(&m.a->state, INSTANCE_MOVED);
+            }
+            if (m.invMassB > 0.0f) {
+                m.b->pos += m.norm * (correction * m.invMassB);
+                m.b->updateTransform();
+                States::activate(&m.b->state, INSTANCE_MOVED);
+            }
+        }
+
+        // the narrowphase has to report it again next frame
+        m.touched = false;
+    }
+}
+
+// forget the contacts of an instance being deleted
+void Contacts::removeInstance(RigidBody* rb) {
+    for (auto it = manifolds.begin(); it != manifolds.end();) {
+        if (it->second.a == rb || it->second.b == rb) {
+            it = manifolds.erase(it);
+        }
+        else {
+            it++;
+        }
+    }
+}
+
+// forget every contact
+void Contacts::clear() {
+    manifolds.clear();
+    noWarmStarted = 0;
+}
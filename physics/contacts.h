@@ -0,0 +1,100 @@
+/*****************************************************************
+ *   Author: Tyanna Prince
+ *   Date: 07/15/2023
+ *   Description: An enhancement of my cs330 OpenGL project where I added functionality such as charater movement,
+ *  directional lighting, and shadow mapping, a cubemap, and joystick support.
+ *  copyright (c) 2023 Tyanna Prince
+ *  version 2.0
+ *****************************************************************/
+
+#ifndef CONTACTS_H
+#define CONTACTS_H
+
+// passes over the contacts per frame (more passes settle stacks further)
+#define CONTACT_ITERATIONS 8
+// fraction of the closing speed kept when bouncing (1 is elastic, like the old reflection)
+#define CONTACT_RESTITUTION 1.0f
+// closing speed (in m/s) below which bodies come to rest against each other instead of bouncing
+#define CONTACT_BOUNCE_THRESHOLD 0.5f
+// overlap (in m) left alone so resting bodies stay in contact from frame to frame
+#define CONTACT_SLOP 0.005f
+// fraction of the remaining overlap removed per frame
+#define CONTACT_CORRECTION 0.4f
+// the impulse of the last frame is reused while the normal turns less than this (cosine of the angle)
+#define CONTACT_WARM_START_COS 0.95f
+
+#include <map>
+#include <utility>
+
+#include <glm/glm.hpp>
+
+// forward declaration
+class RigidBody;
+
+/*
+    namespace for the contact solver
+
+    - the narrowphase reports each touching pair once per frame (RigidBody::handleCollision),
+      the contact is cached per pair across frames as long as the pair keeps touching
+    - at the end of the frame the contacts are solved together with sequential impulses,
+      starting from the impulse each pair needed last frame (warm start), so bodies resting
+      on each other settle instead of reflecting off each other every frame
+    - pairs closing faster than CONTACT_BOUNCE_THRESHOLD bounce in a second pass, which is
+      not carried to the next frame
+    - the overlap left after the step is removed by moving the bodies apart, weighted by mass
+    - instances are points without rotation, so a single normal contact per pair is the
+      whole manifold
+*/
+
+namespace Contacts {
+    /*
+        struct to represent the contact between a pair of instances
+    */
+
+    struct manifold {
+        // pair (a before b in the cache)
+        RigidBody* a;
+        RigidBody* b;
+
+        // unit normal from a toward b
+        glm::vec3 norm;
+        // overlap along the normal in m
+        float depth;
+
+        // impulse applied along the normal to stop the pair closing (kept for the next frame)
+        float normalImpulse;
+        // impulse applied on top to bounce (this frame only)
+        float bounceImpulse;
+        // reported by the narrowphase this frame
+        bool touched;
+
+        // values fixed for the solve
+        float invMassA;
+        float invMassB;
+        // relative speed along the normal the pair should leave with
+        float targetSpeed;
+    };
+
+    // contacts of the pairs touching last frame and this frame
+    extern std::map<std::pair<RigidBody*, RigidBody*>, manifold> manifolds;
+
+    // contacts that reused the impulse of last frame in the last solve
+    extern unsigned int noWarmStarted;
+
+    // inverse of the mass of an instance (0 for instances that collisions do not move)
+    float calculateInverseMass(RigidBody* rb);
+
+    // record that b touches a (norm points from a toward b)
+    void addContact(RigidBody* a, RigidBody* b, glm::vec3 norm, float depth);
+
+    // resolve the contacts reported this frame and forget the pairs that separated
+    void solve();
+
+    // forget the contacts of an instance being deleted
+    void removeInstance(RigidBody* rb);
+
+    // forget every contact
+    void clear();
+}
+
+#endif
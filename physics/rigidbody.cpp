@@ -8,6 +8,8 @@
  *****************************************************************/
 
 #include "rigidbody.h"
+#include "collisionmesh.h"
+#include "contacts.h"
 
 #include <gtc/matrix_transform.hpp>
 #include <gtc/quaternion.hpp>
@@ -30,7 +32,7 @@ bool RigidBody::operator==(std::string id) {
 // construct with parameters and default
 RigidBody::RigidBody(std::string modelId, glm::vec3 size, float mass, glm::vec3 pos, glm::vec3 rot)
     : modelId(modelId), size(size), mass(mass), pos(pos), rot(rot),
-    velocity(0.0f), acceleration(0.0f), state(0),
+    velocity(0.0f), acceleration(0.0f), state(0), noUpdates(0),
     lastCollision(COLLISION_THRESHOLD), lastCollisionID("") {
     update(0.0f);
 }
@@ -41,9 +43,17 @@ RigidBody::RigidBody(std::string modelId, glm::vec3 size, float mass, glm::vec3
 
 // update position with velocity and acceleration
 void RigidBody::update(float dt) {
+    prevPos = pos;
     pos += velocity * dt + 0.5f * acceleration * (dt * dt);
     velocity += acceleration * dt;
 
+    updateTransform();
+
+    lastCollision += dt;
+}
+
+// recalculate the model matrices after pos, rot or size was set directly (previous position is kept)
+void RigidBody::updateTransform() {
     // calculate rotation matrix
     glm::mat4 rotMat = glm::toMat4(glm::quat(rot));
 
@@ -53,8 +63,7 @@ void RigidBody::update(float dt) {
     model = glm::scale(model, size); // M = M * S = T * R * S
 
     normalModel = glm::transpose(glm::inverse(glm::mat3(model)));
-
-    lastCollision += dt;
+    noUpdates++; // world space meshes are stale
 }
 
 // apply a force
@@ -100,13 +109,46 @@ void RigidBody::transferEnergy(float joules, glm::vec3 direction) {
 }
 
 /*
-    collisions
+    world space
 */
-void RigidBody::handleCollision(RigidBody* inst, glm::vec3 norm) {
-    if (lastCollision >= COLLISION_THRESHOLD || lastCollisionID != inst->instanceId) {
-        this->velocity = glm::reflect(this->velocity, glm::normalize(norm)); // register (elastic) collision
-        lastCollision = 0.0f; // reset counter
+
+// get the collision mesh in world space (transformed again only if the instance moved since it was last read)
+WorldMesh& RigidBody::getWorldMesh(CollisionMesh* mesh) {
+    // instances have few meshes, so search the list
+    WorldMesh* worldMesh = nullptr;
+    for (WorldMesh& cached : worldMeshes) {
+        if (cached.mesh == mesh) {
+            worldMesh = &cached;
+            break;
+        }
+    }
+
+    if (!worldMesh) {
+        // first read, stamp is always behind the current update
+        WorldMesh added{};
+        added.mesh = mesh;
+        added.stamp = noUpdates - 1;
+        worldMeshes.push_back(added);
+        worldMesh = &worldMeshes.back();
     }
 
+    if (worldMesh->stamp != noUpdates) {
+        // model matrix changed since the points were transformed
+        mesh->transform(this, *worldMesh);
+        worldMesh->stamp = noUpdates;
+    }
+
+    return *worldMesh;
+}
+
+/*
+    collisions
+*/
+
+// record a contact with another instance (norm points from inst toward this instance, depth is the overlap in m)
+void RigidBody::handleCollision(RigidBody* inst, glm::vec3 norm, float depth) {
+    Contacts::addContact(inst, this, norm, depth);
+
+    lastCollision = 0.0f; // reset counter
     lastCollisionID = inst->instanceId;
-}
\ No newline at end of file
+}
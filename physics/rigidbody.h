@@ -13,13 +13,49 @@
 #include <glm/glm.hpp>
 
 #include <string>
+#include <vector>
 
 // switches for instance states
 #define INSTANCE_DEAD		(unsigned char)0b00000001
 #define INSTANCE_MOVED		(unsigned char)0b00000010
+#define INSTANCE_VISIBLE	(unsigned char)0b00000100
+#define INSTANCE_CCD		(unsigned char)0b00001000 // swept from its previous position when moving fast (continuous collision)
+#define INSTANCE_STATIC		(unsigned char)0b00010000 // never moved by collisions (infinite mass)
 
 #define COLLISION_THRESHOLD 0.05f
 
+// forward declaration
+class CollisionMesh;
+
+/*
+    struct to hold a collision mesh of an instance in world space
+    - narrowphase and ray tests read the transformed points instead of
+      transforming every vertex of every face for every pair tested
+*/
+
+struct WorldMesh {
+    // mesh in model space
+    CollisionMesh* mesh;
+
+    // update of the instance the points were transformed at
+    unsigned int stamp;
+
+    // points in world space (parallel to the points of the mesh)
+    std::vector<glm::vec3> points;
+    // unit normals in world space (parallel to the faces of the mesh)
+    std::vector<glm::vec3> norms;
+
+    // boxes around the branches of the face tree in world space (parallel to the nodes of the mesh)
+    std::vector<glm::vec3> mins;
+    std::vector<glm::vec3> maxs;
+
+    // faces transposed for the ray kernel, one array per component (parallel to the faces, padded to whole vectors)
+    // - first corner of each face, then the edges from it to the other two corners
+    std::vector<float> corners[3];
+    std::vector<float> edges1[3];
+    std::vector<float> edges2[3];
+};
+
 /*
     Rigid Body class
     - represents physical body and holds all parameters
@@ -35,6 +71,8 @@ public:
 
     // position in m
     glm::vec3 pos;
+    // position before the last update in m
+    glm::vec3 prevPos;
     // velocity in m/s
     glm::vec3 velocity;
     // acceleration in m/s^2
@@ -49,6 +87,11 @@ public:
     // model matrix
     glm::mat4 model;
     glm::mat3 normalModel;
+    // number of times the model matrix was calculated
+    unsigned int noUpdates;
+
+    // collision meshes in world space (built when first read after the model matrix changed)
+    std::vector<WorldMesh> worldMeshes;
 
     // ids for quick access to instance/model
     std::string modelId;
@@ -80,6 +123,9 @@ public:
     // update position with velocity and acceleration
     void update(float dt);
 
+    // recalculate the model matrices after pos, rot or size was set directly (previous position is kept)
+    void updateTransform();
+
     // apply a force
     void applyForce(glm::vec3 force);
     void applyForce(glm::vec3 direction, float magnitude);
@@ -95,10 +141,20 @@ public:
     // transfer potential or kinetic energy from another object
     void transferEnergy(float joules, glm::vec3 direction);
 
+    /*
+        world space
+    */
+
+    // get the collision mesh in world space (transformed again only if the instance moved since it was last read)
+    WorldMesh& getWorldMesh(CollisionMesh* mesh);
+
     /*
         collisions
     */
-    void handleCollision(RigidBody* inst, glm::vec3 norm);
+
+    // record a contact with another instance (norm points from inst toward this instance, depth is the overlap in m)
+    // - resolved with the other contacts of the frame by the contact solver
+    void handleCollision(RigidBody* inst, glm::vec3 norm, float depth);
 };
 
 #endif
\ No newline at end of file
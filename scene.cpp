@@ -9,8 +9,19 @@
 
 #include "scene.h"
 
+#include "algorithms/events.h"
+#include "algorithms/linearoctree.h"
+#include "io/snapshot.h"
+#include "physics/contacts.h"
+
+#include <algorithm>
+
 #define MAX_POINT_LIGHTS 10
 #define MAX_SPOT_LIGHTS 2
+// dynamic insertions after which the octree is rebuilt in the background
+#define OCTREE_REBUILD_INSERTIONS 4096
+// half the size of the root when the scene starts (grows to fit objects that leave it)
+#define OCTREE_INITIAL_BOUNDS 16.0f
 
 unsigned int Scene::scrWidth = 0;
 unsigned int Scene::scrHeight = 0;
@@ -33,17 +44,27 @@ void Scene::framebufferSizeCallback(GLFWwindow* window, int width, int height) {
 
 // default
 Scene::Scene() 
-    : currentId("aaaaaaaa"), lightUBO(0) {}
+    : instancesInitialized(false),
+    octreeBackend(Octree::Backend::POINTER), octree(nullptr), linearOctree(nullptr), bvh(nullptr),
+    hashGridCellSize(HASH_GRID_CELL_SIZE), hashGrid(nullptr),
+    broadphaseType(Broadphase::Type::SWEEP_AND_PRUNE), broadphase(nullptr),
+    currentId("aaaaaaaa"), lightUBO(0),
+    frustumCulling(true) {}
 
 // set with values
 Scene::Scene(int glfwVersionMajor, int glfwVersionMinor,
     const char* title, unsigned int scrWidth, unsigned int scrHeight)
-    : glfwVersionMajor(glfwVersionMajor), glfwVersionMinor(glfwVersionMinor), // GLFW version
+    : instancesInitialized(false), // spatial index
+    octreeBackend(Octree::Backend::POINTER), octree(nullptr), linearOctree(nullptr), bvh(nullptr),
+    hashGridCellSize(HASH_GRID_CELL_SIZE), hashGrid(nullptr),
+    broadphaseType(Broadphase::Type::SWEEP_AND_PRUNE), broadphase(nullptr),
+    glfwVersionMajor(glfwVersionMajor), glfwVersionMinor(glfwVersionMinor), // GLFW version
     title(title), // window title
     // default indices/vals
     activeCamera(-1), 
     activePointLights(0), activeSpotLights(0),
-    currentId("aaaaaaaa"), lightUBO(0) {
+    currentId("aaaaaaaa"), lightUBO(0),
+    frustumCulling(true) {
     
     // window dimensions
     Scene::scrWidth = scrWidth;
@@ -60,6 +81,11 @@ Scene::Scene(int glfwVersionMajor, int glfwVersionMinor,
 
 // to be called after constructor
 bool Scene::init() {
+    return init(Octree::Backend::POINTER);
+}
+
+// to be called after constructor (select octree backend and looseness of its nodes)
+bool Scene::init(Octree::Backend octreeBackend, float octreeLooseness) {
     glfwInit();
 
     // set version
@@ -131,9 +157,35 @@ bool Scene::init() {
     instances = trie::Trie<RigidBody*>(trie::ascii_lowercase);
 
     /*
-        init octree
+        init spatial index
+    */
+    this->octreeBackend = octreeBackend;
+    if (octreeBackend == Octree::Backend::LINEAR) {
+        linearOctree = new Octree::linearTree(BoundingRegion(glm::vec3(-OCTREE_INITIAL_BOUNDS), glm::vec3(OCTREE_INITIAL_BOUNDS)));
+    }
+    else if (octreeBackend == Octree::Backend::BVH) {
+        bvh = new BVH();
+    }
+    else {
+        octree = Octree::node::pool.create(BoundingRegion(glm::vec3(-OCTREE_INITIAL_BOUNDS), glm::vec3(OCTREE_INITIAL_BOUNDS)));
+        octree->looseness = octreeLooseness;
+    }
+
+    // models with many small instances bypass the octree
+    hashGrid = new HashGrid(hashGridCellSize);
+    hashGrid->linkedIndex = getSpatialIndex();
+    getSpatialIndex()->linkedIndex = hashGrid;
+
+    /*
+        initialize broadphase
     */
-    octree = new Octree::node(BoundingRegion(glm::vec3(-16.0f), glm::vec3(16.0f)));
+    if (broadphaseType == Broadphase::Type::SWEEP_AND_PRUNE) {
+        broadphase = new Broadphase::sweepAndPrune();
+
+        // spatial indices no longer test pairs while updating
+        getSpatialIndex()->detectCollisions = false;
+        hashGrid->detectCollisions = false;
+    }
 
     /*
         initialize freetype library
@@ -163,7 +215,8 @@ void Scene::prepare(Box& box, std::vector<Shader> shaders) {
     // close FT library
     FT_Done_FreeType(ft);
     // process current instances
-    octree->update(box);
+    getSpatialIndex()->update(box);
+    hashGrid->update(box);
 
     // setup lighting UBO
     lightUBO = UBO::UBO(0, {
@@ -329,6 +382,10 @@ void Scene::processInput(float dt) {
 
         // set pos
         cameraPos = cameras[activeCamera]->cameraPos;
+
+        // set frustum and find what it can see
+        frustum = Frustum(projection * view);
+        cullInstances();
     }
 }
 
@@ -340,20 +397,221 @@ void Scene::update() {
     defaultFBO.clear();
 }
 
+// mark instances inside the camera frustum as visible
+void Scene::cullInstances() {
+    // clear visible switch of every instance
+    instances.traverse([](RigidBody* rb) -> void {
+        States::deactivate(&rb->state, INSTANCE_VISIBLE);
+    });
+
+    // query spatial index
+    std::vector<RigidBody*> visible;
+    getSpatialIndex()->checkCollisionsFrustum(frustum, visible);
+    hashGrid->checkCollisionsFrustum(frustum, visible);
+
+    for (RigidBody* rb : visible) {
+        States::activate(&rb->state, INSTANCE_VISIBLE);
+    }
+}
+
 // update screen after frame
 void Scene::newFrame(Box &box) {
     box.positions.clear();
     box.sizes.clear();
 
+    // time spent in each collision phase (seconds)
+    double phaseStart = glfwGetTime();
+    double treeTime = 0.0, broadphaseTime = 0.0, narrowphaseTime = 0.0, solverTime = 0.0;
+
+    // swap in a rebuilt octree at the frame boundary
+    if (octreeRebuild.valid() &&
+        octreeRebuild.wait_for(std::chrono::seconds(0)) == std::future_status::ready) {
+        Octree::node* fresh = octreeRebuild.get();
+
+        // instances generated after the snapshot was taken
+        for (std::pair<RigidBody*, Model*> inst : instancesDuringRebuild) {
+            fresh->addToPending(inst.first, inst.second);
+        }
+        instancesDuringRebuild.clear();
+
+        // instances can move while the build runs, so the first update transforms every copied region
+        fresh->staleRegions = true;
+        replaceOctree(fresh);
+    }
+
+    // stop fast instances at the first contact before the indices see where they ended up
+    variableLog["ccdHits"] = (int)sweepInstances();
+
     // process pending objects
-    octree->processPending();
-    octree->update(box);
+    getSpatialIndex()->processPending();
+    getSpatialIndex()->update(box);
+    hashGrid->processPending();
+    hashGrid->update(box);
+
+    if (octreeBackend == Octree::Backend::POINTER) {
+        // moved objects that had to leave their node this frame
+        variableLog["reinsertions"] = (int)octree->noReinsertions;
+
+        // most nodes in use at once
+        variableLog["octreeNodesPeak"] = (int)Octree::node::pool.getNoPeak();
+
+        // incremental inserts degrade the tree over time
+        if (octree->noInsertions >= OCTREE_REBUILD_INSERTIONS) {
+            rebuildOctree();
+        }
+    }
+    treeTime = glfwGetTime() - phaseStart;
+
+    // collision detection
+    if (broadphase) {
+        phaseStart = glfwGetTime();
+
+        // gather regions in the indices into hot/cold arrays (regions keep their handles between frames)
+        if (octreeBackend == Octree::Backend::LINEAR && hashGrid->objects.size() == 0) {
+            broadphase->regions.sync(linearOctree->objects);
+        }
+        else {
+            std::vector<BoundingRegion> objectList;
+            getSpatialIndex()->collectObjects(objectList);
+            hashGrid->collectObjects(objectList);
+            broadphase->regions.sync(objectList);
+        }
+
+        // find overlapping pairs, then test each one
+        broadphase->findPairs();
+        broadphaseTime = glfwGetTime() - phaseStart;
+
+        phaseStart = glfwGetTime();
+        Broadphase::narrowphase(broadphase->regions, broadphase->pairs);
+        narrowphaseTime = glfwGetTime() - phaseStart;
+
+        variableLog["pairs"] = (int)broadphase->pairs.size();
+    }
+
+    // resolve every contact found this frame together
+    phaseStart = glfwGetTime();
+    Contacts::solve();
+    solverTime = glfwGetTime() - phaseStart;
+
+    // pass the begin/stay/end events of this frame to the listeners
+    Events::publish();
+
+    logCollisionStats(treeTime, broadphaseTime, narrowphaseTime, solverTime);
 
     // send new frame to window
     glfwSwapBuffers(window);
     glfwPollEvents();
 }
 
+// publish statistics of the octree and collision tests, then reset the counters
+void Scene::logCollisionStats(double treeTime, double broadphaseTime, double narrowphaseTime, double solverTime) {
+    // shape of the tree
+    Stats::treeStats stats;
+    getSpatialIndex()->calculateStats(stats);
+
+    if (octreeBackend == Octree::Backend::BVH) {
+        // how much refitting has degraded the hierarchy
+        variableLog["bvhCost"] = bvh->currentCost;
+        variableLog["bvhRebuilds"] = (int)bvh->noRebuilds;
+    }
+    else {
+        glm::vec3 rootSize;
+        if (octreeBackend == Octree::Backend::LINEAR) {
+            rootSize = linearOctree->region.calculateDimensions();
+            variableLog["octreeRootGrowths"] = (int)linearOctree->noGrowths;
+        }
+        else {
+            rootSize = octree->region.calculateDimensions();
+            variableLog["octreeRootGrowths"] = (int)octree->noGrowths;
+        }
+
+        // largest side of the root (starts at twice OCTREE_INITIAL_BOUNDS)
+        variableLog["octreeRootSize"] = glm::max(rootSize.x, glm::max(rootSize.y, rootSize.z));
+    }
+
+    variableLog["octreeNodes"] = (int)stats.noNodes;
+    variableLog["octreeDepthMax"] = (int)stats.maxDepth;
+    variableLog["octreeDepthMean"] = stats.calculateMeanDepth();
+    variableLog["octreePending"] = (int)stats.noPending;
+
+    std::vector<jsoncpp::json> leafObjects;
+    for (int i = 0; i < STATS_LEAF_BINS; i++) {
+        leafObjects.push_back((int)stats.leafObjects[i]);
+    }
+    variableLog["octreeLeafObjects"] = leafObjects;
+
+    // instances bypassing the octree
+    variableLog["hashGridObjects"] = (int)hashGrid->objects.size();
+    variableLog["hashGridCells"] = (int)hashGrid->cells.size();
+    variableLog["hashGridCellChanges"] = (int)hashGrid->noCellChanges;
+
+    // tests done this frame
+    variableLog["coarseTests"] = (int)Stats::noCoarseTests;
+    variableLog["faceTests"] = (int)Stats::noFaceTests;
+    variableLog["sphereTests"] = (int)Stats::noSphereTests;
+    variableLog["convexTests"] = (int)Stats::noConvexTests;
+    Stats::resetCounters();
+
+    // pairs in contact, and how many reused last frame's impulse
+    variableLog["contacts"] = (int)Contacts::manifolds.size();
+    variableLog["contactsWarmStarted"] = (int)Contacts::noWarmStarted;
+    variableLog["collisionEvents"] = (int)Events::frame.size();
+
+    // time per phase (tree time includes narrowphase when the octree finds pairs itself)
+    variableLog["treeTime"] = treeTime;
+    variableLog["broadphaseTime"] = broadphaseTime;
+    variableLog["narrowphaseTime"] = narrowphaseTime;
+    variableLog["solverTime"] = solverTime;
+}
+
+// sweep fast instances with the INSTANCE_CCD switch from their previous position, returns number clamped at a contact
+unsigned int Scene::sweepInstances() {
+    std::vector<SpatialIndex*> indices = { getSpatialIndex(), hashGrid };
+    unsigned int noHits = 0;
+
+    std::vector<Model*> modelList;
+    collectModels(models, modelList);
+    for (Model* model : modelList) {
+        if (!States::isActive(&model->switches, DYNAMIC)) {
+            // instances never move
+            continue;
+        }
+
+        for (unsigned int i = 0; i < model->currentNoInstances; i++) {
+            RigidBody* rb = model->instances[i];
+            if (States::isActive(&rb->state, INSTANCE_CCD) &&
+                States::isActive(&rb->state, INSTANCE_MOVED) &&
+                !States::isActive(&rb->state, INSTANCE_DEAD) &&
+                CCD::sweepInstance(rb, model, indices)) {
+                noHits++;
+            }
+        }
+    }
+
+    return noHits;
+}
+
+// start building a fresh octree in the background (swapped in at a frame boundary)
+void Scene::rebuildOctree() {
+    if (octreeBackend != Octree::Backend::POINTER || octreeRebuild.valid()) {
+        // only for the pointer octree, and one rebuild at a time
+        return;
+    }
+
+    // snapshot current objects into a new root
+    Octree::node* fresh = Octree::node::pool.create(octree->region);
+    fresh->looseness = octree->looseness;
+    fresh->detectCollisions = octree->detectCollisions;
+    fresh->linkedIndex = octree->linkedIndex;
+    octree->collectObjects(fresh->objects, fresh->queue);
+
+    // build works on its own copies of the regions
+    octreeRebuild = std::async(std::launch::async, [fresh]() -> Octree::node* {
+        fresh->build();
+        return fresh;
+    });
+}
+
 // set uniform shader varaibles (lighting, etc)
 void Scene::renderShader(Shader shader, bool applyLighting) {
     // activate shader
@@ -459,6 +717,9 @@ void Scene::renderText(std::string font, Shader shader, std::string text, float
 
 // called after main loop
 void Scene::cleanup() {
+    // finish writing the collision log
+    Events::clear();
+
     // clean up instances
     instances.cleanup();
 
@@ -475,7 +736,39 @@ void Scene::cleanup() {
     avl_free(fonts);
 
     // destroy octree
-    octree->destroy();
+    if (octreeRebuild.valid()) {
+        // wait for background rebuild to finish
+        Octree::node* fresh = octreeRebuild.get();
+        fresh->destroy();
+        Octree::node::pool.release(fresh);
+    }
+    if (octree) {
+        octree->destroy();
+        Octree::node::pool.release(octree);
+        octree = nullptr;
+    }
+    Octree::node::pool.cleanup();
+    if (linearOctree) {
+        linearOctree->destroy();
+        delete linearOctree;
+        linearOctree = nullptr;
+    }
+    if (bvh) {
+        bvh->destroy();
+        delete bvh;
+        bvh = nullptr;
+    }
+    if (hashGrid) {
+        hashGrid->destroy();
+        delete hashGrid;
+        hashGrid = nullptr;
+    }
+
+    // destroy broadphase
+    if (broadphase) {
+        delete broadphase;
+        broadphase = nullptr;
+    }
 
     // terminate glfw
     glfwTerminate();
@@ -496,6 +789,68 @@ Camera* Scene::getActiveCamera() {
     return (activeCamera >= 0 && activeCamera < cameras.size()) ? cameras[activeCamera] : nullptr;
 }
 
+// get spatial index of the selected backend
+SpatialIndex* Scene::getSpatialIndex() {
+    switch (octreeBackend) {
+    case Octree::Backend::LINEAR:
+        return linearOctree;
+    case Octree::Backend::BVH:
+        return bvh;
+    default:
+        return octree;
+    }
+}
+
+// get spatial index holding the instances of the model
+SpatialIndex* Scene::getSpatialIndex(Model* model) {
+    return States::isActive(&model->switches, HASH_GRID) ? hashGrid : getSpatialIndex();
+}
+
+// check collisions of a ray with the instances in the octree
+BoundingRegion* Scene::checkCollisionsRay(Ray r, float& tmin) {
+    BoundingRegion* ret = getSpatialIndex()->checkCollisionsRay(r, tmin);
+
+    // only hits nearer than the one in the octree
+    BoundingRegion* gridRet = hashGrid->checkCollisionsRay(r, tmin);
+
+    return gridRet ? gridRet : ret;
+}
+
+// check collisions of a packet of rays with the instances in the octree
+void Scene::checkCollisionsRays(std::vector<Ray>& rays, std::vector<RayHit>& hits, RayQuery mode, float maxDistance) {
+    if (octreeBackend == Octree::Backend::POINTER) {
+        octree->checkCollisionsRays(rays, hits, mode, maxDistance);
+    }
+    else {
+        // other backends answer one ray at a time with its closest hit
+        hits.clear();
+        for (unsigned int i = 0, len = rays.size(); i < len; i++) {
+            float tmin = maxDistance;
+            BoundingRegion* br = getSpatialIndex()->checkCollisionsRay(rays[i], tmin);
+            if (br) {
+                hits.push_back({ i, br->instance, br, tmin, -1 });
+            }
+        }
+    }
+
+    if (hashGrid->objects.size() == 0) {
+        return;
+    }
+
+    // merge in the hits of the hash grid, sorted by ray, then distance
+    hashGrid->checkCollisionsRays(rays, hits, mode, maxDistance);
+    std::stable_sort(hits.begin(), hits.end(), [](const RayHit& h1, const RayHit& h2) -> bool {
+        return h1.ray < h2.ray || (h1.ray == h2.ray && h1.t < h2.t);
+    });
+
+    if (mode != RayQuery::ALL) {
+        // keep one hit per ray
+        hits.erase(std::unique(hits.begin(), hits.end(), [](const RayHit& h1, const RayHit& h2) -> bool {
+            return h1.ray == h2.ray;
+        }), hits.end());
+    }
+}
+
 /*
     modifiers
 */
@@ -534,10 +889,16 @@ RigidBody* Scene::generateInstance(std::string modelId, glm::vec3 size, float ma
             // successfully generated, set new and unique id for instance
             std::string id = generateId();
             rb->instanceId = id;
+            // visible until the next frustum query
+            States::activate(&rb->state, INSTANCE_VISIBLE);
             // insert into trie
             instances.insert(rb->instanceId, rb);
             // insert into pending queue
-            octree->addToPending(rb, model);
+            getSpatialIndex(model)->addToPending(rb, model);
+            if (octreeRebuild.valid() && getSpatialIndex(model) != hashGrid) {
+                // also insert into octree being rebuilt once it is swapped in
+                instancesDuringRebuild.push_back({ rb, model });
+            }
             return rb;
         }
     }
@@ -550,13 +911,22 @@ void Scene::initInstances() {
     avl_inorderTraverse(models, [](avl* node) -> void {
         ((Model*)node->val)->initInstances();
     });
+    instancesInitialized = true;
 }
 
 // load model data
 void Scene::loadModels() {
     // initialize each model
     avl_inorderTraverse(models, [](avl* node) -> void {
-        ((Model*)node->val)->init();
+        Model* model = (Model*)node->val;
+        model->init();
+
+        // report how much tighter the bounds are than spheres around the box centers
+        if (model->boundsVolume > 0.0f) {
+            std::cout << "Model " << model->id << ": bounds volume " << model->boundsVolume
+                << " (centered spheres " << model->centeredBoundsVolume << ", "
+                << model->centeredBoundsVolume / model->boundsVolume << "x)" << std::endl;
+        }
     });
 }
 
@@ -570,16 +940,25 @@ void Scene::removeInstance(std::string instanceId) {
     // delete instance from model
     model->removeInstance(instanceId);
 
+    // forget its contacts
+    Contacts::removeInstance(instance);
+    Events::removeInstance(instance);
+
     // remove from tree
     instances[instanceId] = NULL;
     instances.erase(instanceId);
-    free(instance);
+    delete instance;
 }
 
 // mark instance for deletion
 void Scene::markForDeletion(std::string instanceId) {
     RigidBody* instance = instances[instanceId];
 
+    if (States::isActive(&instance->state, INSTANCE_DEAD)) {
+        // already marked
+        return;
+    }
+
     // activate kill switch
     States::activate(&instance->state, INSTANCE_DEAD);
     // push to list
@@ -588,12 +967,193 @@ void Scene::markForDeletion(std::string instanceId) {
 
 // clear all instances marked for deletion
 void Scene::clearDeadInstances() {
+    if (octreeRebuild.valid()) {
+        // octree being rebuilt still references these instances
+        return;
+    }
+
     for (RigidBody* rb : instancesToDelete) {
         removeInstance(rb->instanceId);
     }
     instancesToDelete.clear();
 }
 
+// delete every instance and empty the octree
+void Scene::clearInstances() {
+    // nothing may reference the instances being deleted
+    if (octreeRebuild.valid()) {
+        Octree::node* fresh = octreeRebuild.get();
+        fresh->destroy();
+        Octree::node::pool.release(fresh);
+    }
+    instancesDuringRebuild.clear();
+    instancesToDelete.clear();
+    Contacts::clear();
+    Events::clear();
+
+    std::vector<Model*> modelList;
+    collectModels(models, modelList);
+    for (Model* model : modelList) {
+        for (unsigned int i = 0; i < model->currentNoInstances; i++) {
+            instances[model->instances[i]->instanceId] = NULL;
+            instances.erase(model->instances[i]->instanceId);
+            delete model->instances[i];
+            model->instances[i] = nullptr;
+        }
+        model->currentNoInstances = 0;
+    }
+
+    // empty indices with the same bounds and settings
+    hashGrid->destroy();
+    if (octreeBackend != Octree::Backend::POINTER) {
+        getSpatialIndex()->destroy();
+    }
+    else {
+        Octree::node* empty = Octree::node::pool.create(octree->region);
+        empty->looseness = octree->looseness;
+        replaceOctree(empty);
+    }
+}
+
+// write instances and octree to a binary snapshot
+bool Scene::saveSnapshot(std::string path) {
+    Snapshot::writer out;
+    Snapshot::instanceTable table;
+
+    // header
+    out.write<unsigned int>(SNAPSHOT_MAGIC);
+    out.write<unsigned int>(SNAPSHOT_VERSION);
+    out.write<unsigned char>((unsigned char)octreeBackend);
+    out.writeString(currentId);
+
+    // instances of each model
+    std::vector<Model*> modelList;
+    collectModels(models, modelList);
+    out.write<unsigned int>(modelList.size());
+    for (Model* model : modelList) {
+        out.writeString(model->id);
+        out.write<unsigned int>(model->currentNoInstances);
+        for (unsigned int i = 0; i < model->currentNoInstances; i++) {
+            Snapshot::writeInstance(out, model->instances[i]);
+            table.add(model->instances[i], model);
+        }
+    }
+
+    // octree with instances replaced by their index in the table (the BVH and hash grid are rebuilt on load instead)
+    if (octreeBackend == Octree::Backend::LINEAR) {
+        Snapshot::writeTree(out, linearOctree, table);
+    }
+    else if (octreeBackend == Octree::Backend::POINTER) {
+        Snapshot::writeTree(out, octree, table);
+    }
+
+    return out.save(path);
+}
+
+// replace instances and octree with a binary snapshot (no reinsertion or rebuild)
+bool Scene::loadSnapshot(std::string path) {
+    double startTime = glfwGetTime();
+
+    Snapshot::reader in;
+    if (!in.load(path)) {
+        return false;
+    }
+
+    // header
+    if (in.read<unsigned int>() != SNAPSHOT_MAGIC ||
+        in.read<unsigned int>() != SNAPSHOT_VERSION ||
+        in.read<unsigned char>() != (unsigned char)octreeBackend) {
+        // not a snapshot, older layout, or saved with the other backend
+        return false;
+    }
+
+    // point of no return
+    clearInstances();
+    currentId = in.readString();
+
+    // instances of each model
+    Snapshot::instanceTable table;
+    unsigned int noModels = in.read<unsigned int>();
+    for (unsigned int i = 0; !in.failed && i < noModels; i++) {
+        std::string modelId = in.readString();
+        unsigned int noInstances = in.read<unsigned int>();
+
+        Model* model = (Model*)avl_get(models, (void*)modelId.c_str());
+        if (!model || noInstances > model->maxNoInstances) {
+            // model not registered or too small
+            in.failed = true;
+            break;
+        }
+
+        for (unsigned int j = 0; !in.failed && j < noInstances; j++) {
+            RigidBody* rb = Snapshot::readInstance(in, model->id);
+            if (in.failed) {
+                // file ended partway through the instance
+                delete rb;
+                break;
+            }
+            model->instances[model->currentNoInstances++] = rb;
+            instances.insert(rb->instanceId, rb);
+            table.add(rb, model);
+
+            if (!States::isActive(&model->switches, DYNAMIC)) {
+                // snapshots written before static instances were flagged
+                States::activate(&rb->state, INSTANCE_STATIC);
+            }
+
+            if (States::isActive(&rb->state, INSTANCE_DEAD)) {
+                // was waiting to be deleted
+                instancesToDelete.push_back(rb);
+            }
+        }
+    }
+
+    // octree
+    bool treeRestored = false;
+    if (!in.failed) {
+        if (octreeBackend == Octree::Backend::LINEAR) {
+            treeRestored = Snapshot::readTree(in, linearOctree, table);
+        }
+        else if (octreeBackend == Octree::Backend::POINTER) {
+            Octree::node* restored = Snapshot::readTree(in, table);
+            if (restored) {
+                replaceOctree(restored);
+                treeRestored = true;
+            }
+        }
+    }
+
+    if (!treeRestored) {
+        // fall back to inserting the instances that were read
+        if (octreeBackend != Octree::Backend::POINTER) {
+            getSpatialIndex()->destroy();
+        }
+        for (unsigned int i = 0, len = table.instances.size(); i < len; i++) {
+            getSpatialIndex(table.models[i])->addToPending(table.instances[i], table.models[i]);
+        }
+    }
+    else {
+        // the hash grid is not saved, insert its instances again
+        for (unsigned int i = 0, len = table.instances.size(); i < len; i++) {
+            if (States::isActive(&table.models[i]->switches, HASH_GRID)) {
+                hashGrid->addToPending(table.instances[i], table.models[i]);
+            }
+        }
+    }
+
+    // constant instances are only uploaded on request
+    if (instancesInitialized) {
+        std::vector<Model*> modelList;
+        collectModels(models, modelList);
+        for (Model* model : modelList) {
+            model->refreshInstances();
+        }
+    }
+
+    variableLog["snapshotRestoreTime"] = glfwGetTime() - startTime;
+    return !in.failed && treeRestored;
+}
+
 // generate next instance id
 std::string Scene::generateId() {
     for (int i = currentId.length() - 1; i >= 0; i--) {
@@ -607,4 +1167,31 @@ std::string Scene::generateId() {
         }
     }
     return currentId;
-}
\ No newline at end of file
+}
+
+/*
+    protected methods
+*/
+
+// add every registered model in the tree to the list
+void Scene::collectModels(avl* node, std::vector<Model*>& modelList) {
+    if (!node || !node->val) {
+        return;
+    }
+
+    collectModels(node->left, modelList);
+    modelList.push_back((Model*)node->val);
+    collectModels(node->right, modelList);
+}
+// return the pointer octree root to the pool and use root instead (keeps the hash grid linked to the live root)
+void Scene::replaceOctree(Octree::node* root) {
+    root->detectCollisions = octree->detectCollisions;
+    root->linkedIndex = octree->linkedIndex;
+
+    octree->destroy();
+    Octree::node::pool.release(octree);
+    octree = root;
+
+    // the grid tests its moved objects against the tree, so it must not keep the released root
+    hashGrid->linkedIndex = octree;
+}
@@ -15,6 +15,7 @@
 
 #include <vector>
 #include <map>
+#include <future>
 
 #include <glm/glm.hpp>
 
@@ -40,12 +41,21 @@
 
 #include "algorithms/states.hpp"
 #include "algorithms/avl.h"
+#include "algorithms/broadphase.h"
+#include "algorithms/bvh.h"
+#include "algorithms/ccd.h"
+#include "algorithms/frustum.h"
+#include "algorithms/hashgrid.h"
 #include "algorithms/octree.h"
+#include "algorithms/spatialindex.h"
+#include "algorithms/stats.h"
 #include "algorithms/trie.hpp"
 
 // forward declarations
 namespace Octree {
     class node;
+    class linearTree;
+    enum class Backend : unsigned char;
 }
 
 class Model;
@@ -64,8 +74,32 @@ public:
     // list of instances that should be deleted
     std::vector<RigidBody*> instancesToDelete;
 
-    // pointer to root node in octree
+    // if the instance VBOs of each model have been created
+    bool instancesInitialized;
+
+    // backend used for the spatial index
+    Octree::Backend octreeBackend;
+    // pointer to root node in octree (POINTER backend)
     Octree::node* octree;
+    // pointer to linear octree (LINEAR backend)
+    Octree::linearTree* linearOctree;
+    // pointer to bounding volume hierarchy (BVH backend)
+    BVH* bvh;
+
+    // edge length of the hash grid cells (set before init)
+    float hashGridCellSize;
+    // pointer to hash grid holding the instances of models with the HASH_GRID switch
+    HashGrid* hashGrid;
+
+    // fresh octree being built in the background (POINTER backend)
+    std::future<Octree::node*> octreeRebuild;
+    // instances generated while the fresh octree is being built
+    std::vector<std::pair<RigidBody*, Model*>> instancesDuringRebuild;
+
+    // backend used to find collision pairs (set before init)
+    Broadphase::Type broadphaseType;
+    // pointer to broadphase stage (nullptr if the octree finds pairs itself)
+    Broadphase::stage* broadphase;
 
     // map for logged variables
     jsoncpp::json variableLog;
@@ -103,6 +137,9 @@ public:
     // to be called after constructor
     bool init();
 
+    // to be called after constructor (select spatial index backend, looseness only applies to POINTER nodes)
+    bool init(Octree::Backend octreeBackend, float octreeLooseness = 1.0f);
+
     // register a font family
     bool registerFont(TextRenderer* tr, std::string name, std::string path);
 
@@ -119,9 +156,21 @@ public:
     // update screen before each frame
     void update();
 
+    // mark instances inside the camera frustum as visible
+    void cullInstances();
+
     // update screen after frame
     void newFrame(Box &box);
 
+    // sweep fast instances with the INSTANCE_CCD switch from their previous position, returns number clamped at a contact
+    unsigned int sweepInstances();
+
+    // start building a fresh octree in the background (swapped in at a frame boundary)
+    void rebuildOctree();
+
+    // publish statistics of the octree and collision tests, then reset the counters
+    void logCollisionStats(double treeTime, double broadphaseTime, double narrowphaseTime, double solverTime);
+
     // set uniform shader varaibles (lighting, etc)
     void renderShader(Shader shader, bool applyLighting = true);
 
@@ -157,6 +206,19 @@ public:
     // get current active camera in scene
     Camera* getActiveCamera();
 
+    // get spatial index of the selected backend
+    SpatialIndex* getSpatialIndex();
+
+    // get spatial index holding the instances of the model
+    SpatialIndex* getSpatialIndex(Model* model);
+
+    // check collisions of a ray with the instances in the octree
+    BoundingRegion* checkCollisionsRay(Ray r, float& tmin);
+
+    // check collisions of a packet of rays with the instances in the octree (only the POINTER backend finds more than the closest hits)
+    void checkCollisionsRays(std::vector<Ray>& rays, std::vector<RayHit>& hits,
+        RayQuery mode = RayQuery::CLOSEST, float maxDistance = std::numeric_limits<float>::max());
+
     /*
         modifiers
     */
@@ -196,6 +258,15 @@ public:
     // clear all instances marked for deletion
     void clearDeadInstances();
 
+    // delete every instance and empty the octree
+    void clearInstances();
+
+    // write instances and octree to a binary snapshot
+    bool saveSnapshot(std::string path);
+
+    // replace instances and octree with a binary snapshot (no reinsertion or rebuild)
+    bool loadSnapshot(std::string path);
+
     // current instance id
     std::string currentId;
 
@@ -238,6 +309,11 @@ public:
     glm::mat4 textProjection;
     glm::vec3 cameraPos;
 
+    // view frustum of the active camera
+    Frustum frustum;
+    // if models only upload instances inside the frustum (turn off when rendering from a light)
+    bool frustumCulling;
+
 protected:
     // window object
     GLFWwindow* window;
@@ -252,6 +328,12 @@ protected:
     // GLFW info
     int glfwVersionMajor;
     int glfwVersionMinor;
+
+    // add every registered model in the tree to the list
+    static void collectModels(avl* node, std::vector<Model*>& modelList);
+
+    // return the pointer octree root to the pool and use root instead (keeps the hash grid linked to the live root)
+    void replaceOctree(Octree::node* root);
 };
 
 #endif
\ No newline at end of file